@@ -0,0 +1,1404 @@
+#include "display/weather_display_handler.h"
+#include "debug_console.h"
+#include "forecast_parser.h"
+#include "json_lib_inc/json.hpp"
+#include "web_handler.h"
+
+#include "libraries/interstate75/interstate75.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Display constants, as in src/main.cpp
+constexpr uint16_t kDisplay_Width = 128;
+constexpr uint8_t kDisplay_Height = 128;
+constexpr uint8_t NUM_DAYS = 3;
+
+using namespace pimoroni;
+using namespace weather;
+using Forecast = std::vector<DayForecast>;
+
+// Every heap allocation made by the process, for --bench-update and --parse.
+// Each block carries its size in front so frees can be counted too. GCC can't
+// tell these replacements pair malloc with free.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+static constexpr size_t kHeapHeader = alignof(std::max_align_t);
+static std::atomic<uint64_t> heap_allocations = 0;
+static std::atomic<uint64_t> heap_bytes = 0;
+static std::atomic<int64_t> heap_live = 0; // Bytes allocated and not yet freed.
+static std::atomic<int64_t> heap_peak = 0; // Highest heap_live seen.
+
+void *operator new(const size_t size)
+{
+    heap_allocations++;
+    heap_bytes += size;
+    auto *block = static_cast<uint8_t *>(std::malloc(size + kHeapHeader));
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<size_t *>(block) = size;
+
+    const int64_t live = heap_live += size;
+    int64_t peak = heap_peak;
+    while (live > peak && !heap_peak.compare_exchange_weak(peak, live))
+    {
+    }
+    return block + kHeapHeader;
+}
+
+void operator delete(void *p) noexcept
+{
+    if (p == nullptr)
+    {
+        return;
+    }
+    uint8_t *block = static_cast<uint8_t *>(p) - kHeapHeader;
+    heap_live -= *reinterpret_cast<size_t *>(block);
+    std::free(block);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    operator delete(p);
+}
+
+PicoZGraphics graphics(kDisplay_Width, kDisplay_Height, nullptr, 1);
+Hub75 hub75(kDisplay_Width * 2, kDisplay_Height / 2, nullptr, PANEL_GENERIC, false);
+
+/**
+ * @brief Options for a host run, filled from the command line.
+ */
+struct HostOptions
+{
+    std::vector<std::string> weather;         // Weather type for each day.
+    uint32_t frames = 300;                    // Frames to run.
+    float fps = 75.0f;                        // Target FPS, also sets the simulated frame time.
+    RenderMode mode = RenderMode::kSerial;    // How frames are split between the cores.
+    std::string out_dir;                      // Where to write frames, none if empty.
+    uint32_t every = 1;                       // Write every Nth frame.
+    bool real_clock = false;                  // Follow the host clock instead of the simulated one.
+    uint64_t seed = 1;                        // Seed for the particle RNG.
+    bool rng_check = false;                   // Check runs from the seed draw the same frames, then exit.
+    bool fixed_check = false;                 // Compare the fixed-point integrator with the float one, then exit.
+    uint32_t bench_update = 0;                // Time this many update_weather() calls, then exit.
+    std::string parse_file;                   // Recorded Tomorrow.io response to parse, then exit.
+    size_t chunk = 128;                       // Bytes fed to the parser at a time.
+    std::string fetch_file;                   // Response for the loopback server to serve to a fetch, then exit.
+    uint32_t serve_delay_ms = 20;             // Loopback server's pause between pieces of the response.
+    bool store_check = false;                 // Check the flash forecast store on emulated flash, then exit.
+    bool light_check = false;                 // Follow a changing room light through the emulated sensor, then exit.
+    bool sensor_check = false;                // Check the sensor driver's burst reads on the emulated sensor, then exit.
+    bool idle_check = false;                  // Empty and darken the emulated room, check the display idles and wakes, then exit.
+    float particle_cost_us = 0.0f;            // Simulated time charged per particle drawn, in serial mode.
+    bool governor_check = false;              // Overload the frame budget, check the particle load follows, then exit.
+};
+
+static void print_usage(const char *name)
+{
+    printf("Usage: %s [options] <weather> [weather for day 2] [weather for day 3]\n", name);
+    printf("       %s --parse FILE [--chunk N]\n", name);
+    printf("       %s --fetch FILE [--chunk N] [--serve-delay MS] <weather>\n\n", name);
+    printf("Options:\n");
+    printf("  --frames N     Frames to run (default 300)\n");
+    printf("  --fps F        Target FPS (default 75)\n");
+    printf("  --mode M       serial, pipelined, split or double (default serial)\n");
+    printf("  --out DIR      Write frames to DIR as PPM files\n");
+    printf("  --every N      Only write every Nth frame (default 1)\n");
+    printf("  --real-clock   Pace frames against the host clock instead of the simulated one\n");
+    printf("  --seed N       Seed for the particle RNG (default 1)\n");
+    printf("  --rng-check    Run the forecast from the seed, twice serially and once after split mode,\n");
+    printf("                 and check the frames match (charges 1 us per particle unless --particle-cost\n");
+    printf("                 is given, so split mode has segments to give core 1)\n");
+    printf("  --fixed-check  Run the fixed-point and float integrators side by side for 10000 frames and\n");
+    printf("                 check the fixed-point particles stay within a pixel\n");
+    printf("  --bench-update N  Time N update_weather() calls of each kind of refresh and count their heap use\n");
+    printf("  --parse FILE   Parse a recorded Tomorrow.io response, check it against json.hpp\n");
+    printf("                 and compare their time and peak heap use\n");
+    printf("  --chunk N      Bytes fed to the parser, or sent by the loopback server, at a time (default 128)\n");
+    printf("  --fetch FILE   Fetch FILE from a loopback server while animating, and report the frame times\n");
+    printf("  --serve-delay MS  Loopback server's pause between pieces of the response (default 20)\n");
+    printf("  --store-check  Check the flash forecast store: round trip, rewrite policy, wear and recovery\n");
+    printf("  --light-check  Follow a changing room light through the emulated light sensor in each mode,\n");
+    printf("                 and count the bus transfers\n");
+    printf("  --sensor-check Read the emulated light sensor's data registers one at a time, through the\n");
+    printf("                 getters, in one burst and in one queued burst; check they agree and count\n");
+    printf("                 the bus transactions\n");
+    printf("  --idle-check   Leave the emulated room dark and empty until the display idles, then wake it\n");
+    printf("                 by coming near and by turning the light on; report the time in each power state\n");
+    printf("  --particle-cost US  Charge the simulated clock US per particle drawn each frame, as a slower\n");
+    printf("                 core would take (serial mode)\n");
+    printf("  --governor-check  Charge enough per particle to overrun the frame budget, check the particle\n");
+    printf("                 load settles where the frames fit without oscillating, then recovers\n\n");
+    printf("Weather types:\n ");
+    for (const auto &type : MockWeatherGenerator::get_valid_types())
+    {
+        printf(" %s", type.c_str());
+    }
+    printf("\n");
+}
+
+static bool parse_mode(const std::string &name, RenderMode &mode)
+{
+    static const std::map<std::string, RenderMode> modes = {
+        {"serial", RenderMode::kSerial},
+        {"pipelined", RenderMode::kPipelined},
+        {"split", RenderMode::kSplitSegments},
+        {"double", RenderMode::kDoubleBuffered}};
+
+    auto it = modes.find(name);
+    if (it == modes.end())
+    {
+        return false;
+    }
+    mode = it->second;
+    return true;
+}
+
+static bool parse_options(int argc, char **argv, HostOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--frames" && has_value)
+        {
+            options.frames = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--fps" && has_value)
+        {
+            options.fps = std::strtof(argv[++i], nullptr);
+        }
+        else if (arg == "--mode" && has_value)
+        {
+            if (!parse_mode(argv[++i], options.mode))
+            {
+                printf("Unknown render mode: %s\n", argv[i]);
+                return false;
+            }
+        }
+        else if (arg == "--out" && has_value)
+        {
+            options.out_dir = argv[++i];
+        }
+        else if (arg == "--every" && has_value)
+        {
+            options.every = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--real-clock")
+        {
+            options.real_clock = true;
+        }
+        else if (arg == "--seed" && has_value)
+        {
+            options.seed = std::strtoull(argv[++i], nullptr, 0);
+        }
+        else if (arg == "--rng-check")
+        {
+            options.rng_check = true;
+        }
+        else if (arg == "--bench-update" && has_value)
+        {
+            options.bench_update = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--parse" && has_value)
+        {
+            options.parse_file = argv[++i];
+        }
+        else if (arg == "--fetch" && has_value)
+        {
+            options.fetch_file = argv[++i];
+        }
+        else if (arg == "--serve-delay" && has_value)
+        {
+            options.serve_delay_ms = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--fixed-check")
+        {
+            options.fixed_check = true;
+        }
+        else if (arg == "--store-check")
+        {
+            options.store_check = true;
+        }
+        else if (arg == "--light-check")
+        {
+            options.light_check = true;
+        }
+        else if (arg == "--sensor-check")
+        {
+            options.sensor_check = true;
+        }
+        else if (arg == "--idle-check")
+        {
+            options.idle_check = true;
+        }
+        else if (arg == "--particle-cost" && has_value)
+        {
+            options.particle_cost_us = std::strtof(argv[++i], nullptr);
+        }
+        else if (arg == "--governor-check")
+        {
+            options.governor_check = true;
+        }
+        else if (arg == "--chunk" && has_value)
+        {
+            options.chunk = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg.rfind("--", 0) == 0)
+        {
+            printf("Unknown option: %s\n", arg.c_str());
+            return false;
+        }
+        else
+        {
+            options.weather.push_back(arg);
+        }
+    }
+
+    if (options.weather.empty())
+    {
+        return !options.parse_file.empty() || options.store_check || options.sensor_check || options.fixed_check;
+    }
+
+    const auto valid_types = MockWeatherGenerator::get_valid_types();
+    for (const auto &type : options.weather)
+    {
+        if (std::find(valid_types.begin(), valid_types.end(), type) == valid_types.end())
+        {
+            printf("Unknown weather type: %s\n", type.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Write the frame last sent to the panel as a binary PPM.
+ */
+static void write_ppm(const std::string &path, const Hub75 &panel)
+{
+    std::ofstream file(path, std::ios::binary);
+    file << "P6\n"
+         << panel.frame_width << " " << panel.frame_height << "\n255\n";
+
+    std::vector<uint8_t> row(panel.frame_width * 3);
+    for (uint y = 0; y < panel.frame_height; y++)
+    {
+        for (uint x = 0; x < panel.frame_width; x++)
+        {
+            const uint32_t pixel = panel.back_buffer[y * panel.frame_width + x];
+            row[x * 3] = (pixel >> 16) & 0xFF;
+            row[x * 3 + 1] = (pixel >> 8) & 0xFF;
+            row[x * 3 + 2] = pixel & 0xFF;
+        }
+        file.write(reinterpret_cast<const char *>(row.data()), row.size());
+    }
+}
+
+/**
+ * @brief Build the mock forecast, one weather type per day. The last type
+ * given is repeated for any remaining days.
+ */
+static Forecast build_forecast(const std::vector<std::string> &weather)
+{
+    Forecast forecast;
+    for (uint8_t day = 0; day < NUM_DAYS; day++)
+    {
+        const std::string &type = weather[std::min<size_t>(day, weather.size() - 1)];
+        auto interval = MockWeatherGenerator::generate(type, day + 1)[day];
+        forecast.push_back(interval);
+    }
+    return forecast;
+}
+
+/**
+ * @brief Time update_weather() on the host clock and count the heap
+ * allocations it makes, including those freed again before it returns, for
+ * the three kinds of refresh: forced rebuilds (what every refresh used to
+ * do), the same forecast again, and a forecast whose intensities changed
+ * but whose weather codes didn't. For each it also reports how many of the
+ * particles on screen survive a refresh.
+ */
+static void bench_update_weather(WeatherDisplayHandler &handler, const Forecast &forecast, const uint32_t calls)
+{
+    // Same codes, lighter precipitation and less settling: retuned in place.
+    Forecast lighter = forecast;
+    for (DayForecast &day : lighter)
+    {
+        day.precip_intensity *= 0.6f;
+        day.snow_accumulation *= 0.5f;
+        day.ice_accumulation *= 0.5f;
+    }
+
+    struct Refresh
+    {
+        const char *name;
+        std::function<void(uint32_t)> update; // The i-th refresh, from 0.
+    };
+    const Refresh refreshes[] = {
+        {"rebuilt", [&](uint32_t)
+         { handler.update_weather(forecast, true); }},
+        {"unchanged", [&](uint32_t)
+         { handler.update_weather(forecast); }},
+        {"retuned", [&](const uint32_t i)
+         { handler.update_weather(i % 2 ? forecast : lighter); }}, // Starts on the lighter one.
+    };
+
+    for (const Refresh &refresh : refreshes)
+    {
+        // Logging would dominate the timing.
+        fflush(stdout);
+        FILE *out = stdout;
+        stdout = fopen("/dev/null", "w");
+
+        // Let the particles fill in, then see how many one refresh keeps.
+        handler.update_weather(forecast, true);
+        for (uint16_t frame = 0; frame < 300; frame++)
+        {
+            handler.refresh_and_update_display();
+        }
+        const uint16_t before = handler.get_total_particle_count();
+        refresh.update(0);
+        handler.refresh_and_update_display();
+        const uint16_t after = handler.get_total_particle_count();
+
+        const uint64_t allocations = heap_allocations;
+        const uint64_t bytes = heap_bytes;
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < calls; i++)
+        {
+            refresh.update(i);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        fclose(stdout);
+        stdout = out;
+        printf("update_weather(), %-9s: %7.2f us, %5.1f allocations, %6.0f heap bytes per call; %u of %u particles kept\n",
+               refresh.name, std::chrono::duration<double, std::micro>(elapsed).count() / calls,
+               static_cast<double>(heap_allocations - allocations) / calls,
+               static_cast<double>(heap_bytes - bytes) / calls, after, before);
+    }
+}
+
+static std::string read_file(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        printf("Can't read %s\n", path.c_str());
+        return {};
+    }
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+/**
+ * @brief The days in a Tomorrow.io response, read the usual way: the whole
+ * document parsed into a json.hpp tree, then the fields looked up in it.
+ */
+static bool parse_with_json(const std::string &response, std::span<DayForecast> days)
+{
+    const auto json = nlohmann::json::parse(response, nullptr, false);
+    if (json.is_discarded())
+    {
+        return false;
+    }
+
+    const auto clock_minutes = [](const std::string &time)
+    {
+        const size_t t = time.find('T');
+        return static_cast<uint16_t>(std::stoi(time.substr(t + 1, 2)) * 60 + std::stoi(time.substr(t + 4, 2)));
+    };
+    const auto percent = [](const float value)
+    {
+        return static_cast<uint8_t>(std::clamp(value, 0.0f, 100.0f) + 0.5f);
+    };
+
+    const auto &intervals = json.at("data").at("timelines").at(0).at("intervals");
+    for (size_t i = 0; i < std::min(intervals.size(), days.size()); i++)
+    {
+        const auto &values = intervals[i].at("values");
+        DayForecast &day = days[i];
+        day = DayForecast{};
+        day.weather_code = values.value("weatherCodeDay", 10000u);
+        day.temperature = values.value("temperature", 0.0f);
+        day.wind_speed = values.value("windSpeed", 0.0f);
+        day.wind_direction = values.value("windDirection", 0.0f);
+        day.cloud_cover = percent(values.value("cloudCover", 0.0f));
+        day.precip_probability = percent(values.value("precipitationProbability", 0.0f));
+        day.precip_intensity = values.value("precipitationIntensity", 0.0f);
+        day.precip_type = values.value("precipitationType", 0u);
+        day.snow_accumulation = values.value("snowAccumulation", 0.0f);
+        day.ice_accumulation = values.value("iceAccumulation", 0.0f);
+        day.sunrise_minutes = clock_minutes(values.at("sunriseTime").get<std::string>());
+        day.sunset_minutes = clock_minutes(values.at("sunsetTime").get<std::string>());
+
+        // std::chrono's calendar, as a check on the parser's own day of the week.
+        const std::string date = intervals[i].at("startTime").get<std::string>();
+        const std::chrono::year_month_day ymd{std::chrono::year(std::stoi(date.substr(0, 4))),
+                                              std::chrono::month(std::stoi(date.substr(5, 2))),
+                                              std::chrono::day(std::stoi(date.substr(8, 2)))};
+        const unsigned weekday = std::chrono::weekday(std::chrono::sys_days(ymd)).c_encoding();
+        day.set_day_name(DAYS_OF_WEEK[(weekday + 1) % 7]);
+    }
+    return true;
+}
+
+/**
+ * @brief Parse a recorded Tomorrow.io response with ForecastParser, check the
+ * days come out the same whatever the chunk size and the same as json.hpp
+ * gives, then compare the time and peak heap use of the two.
+ */
+static bool bench_parse(const std::string &path, const size_t chunk)
+{
+    const std::string response = read_file(path);
+    if (response.empty())
+    {
+        return false;
+    }
+
+    std::array<DayForecast, NUM_DAYS> streamed{};
+    const auto stream = [&response, &streamed](const size_t size)
+    {
+        ForecastParser parser(streamed);
+        for (size_t i = 0; i < response.size() && parser.feed(response.data() + i, std::min(size, response.size() - i)); i += size)
+        {
+        }
+        return parser.complete();
+    };
+    std::array<DayForecast, NUM_DAYS> tree{};
+
+    if (!stream(chunk) || !parse_with_json(response, tree))
+    {
+        printf("%s isn't a forecast response\n", path.c_str());
+        return false;
+    }
+    const auto expected = streamed;
+    for (const size_t size : {size_t{1}, size_t{7}, size_t{64}, response.size()})
+    {
+        if (!stream(size) || streamed != expected)
+        {
+            printf("FAIL: %zu byte chunks give different days\n", size);
+            return false;
+        }
+    }
+    if (tree != expected)
+    {
+        printf("FAIL: ForecastParser and json.hpp disagree\n");
+        for (uint8_t day = 0; day < NUM_DAYS; day++)
+        {
+            for (const auto &[key, value] : forecast_to_map(expected[day]))
+            {
+                const std::string other = forecast_to_map(tree[day])[key];
+                if (value != other)
+                {
+                    printf("  day %u %s: %s vs %s\n", day, key.c_str(), value.c_str(), other.c_str());
+                }
+            }
+        }
+        return false;
+    }
+
+    // Time over many runs, and the peak heap in use above what was live before.
+    constexpr uint32_t kRuns = 2000;
+    const auto measure = [](const char *name, const auto &parse)
+    {
+        const int64_t base = heap_live;
+        heap_peak = base;
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < kRuns; i++)
+        {
+            parse();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        printf("  %-16s %8.2f us %8lld peak heap bytes\n", name,
+               std::chrono::duration<double, std::micro>(elapsed).count() / kRuns,
+               static_cast<long long>(heap_peak - base));
+    };
+
+    printf("%s: %zu bytes, %u days, same as json.hpp at every chunk size\n", path.c_str(), response.size(), NUM_DAYS);
+    measure("ForecastParser", [&stream, chunk]()
+            { stream(chunk); });
+    measure("json.hpp", [&response, &tree]()
+            { parse_with_json(response, tree); });
+    printf("  ForecastParser state is %zu bytes, fed %zu bytes at a time\n\n", sizeof(ForecastParser), chunk);
+
+    for (uint8_t day = 0; day < NUM_DAYS; day++)
+    {
+        printf("Day %u:", day);
+        for (const auto &[key, value] : forecast_to_map(expected[day]))
+        {
+            printf(" %s=%s", key.c_str(), value.c_str());
+        }
+        printf("\n");
+    }
+    return true;
+}
+
+/**
+ * @brief A one-request HTTP server on a loopback port, standing in for
+ * Tomorrow.io. It sends the response body chunk encoded, a piece at a time
+ * with a pause between pieces, like a slow link.
+ */
+class LoopbackServer
+{
+    int listener_ = -1;
+    uint16_t port_ = 0;
+    std::thread thread_;
+
+public:
+    std::string request; // Request line received, once the response has gone.
+
+    LoopbackServer(const std::string &body, const size_t piece, const uint32_t delay_ms)
+    {
+        listener_ = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(listener_, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+        listen(listener_, 1);
+        socklen_t size = sizeof(address);
+        getsockname(listener_, reinterpret_cast<sockaddr *>(&address), &size);
+        port_ = ntohs(address.sin_port);
+
+        thread_ = std::thread([this, body, piece, delay_ms]()
+                              {
+            const int client = accept(listener_, nullptr, nullptr);
+            std::string received;
+            char buffer[512];
+            while (received.find("\r\n\r\n") == std::string::npos)
+            {
+                const ssize_t got = recv(client, buffer, sizeof(buffer), 0);
+                if (got <= 0)
+                {
+                    break;
+                }
+                received.append(buffer, got);
+            }
+            request = received.substr(0, received.find("\r\n"));
+
+            const auto write_all = [client](const std::string &data)
+            { send(client, data.data(), data.size(), MSG_NOSIGNAL); };
+            write_all("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\n\r\n");
+            for (size_t i = 0; i < body.size(); i += piece)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+                const std::string chunk = body.substr(i, piece);
+                char size_line[16];
+                snprintf(size_line, sizeof(size_line), "%zx\r\n", chunk.size());
+                write_all(size_line + chunk + "\r\n");
+            }
+            write_all("0\r\n\r\n");
+            close(client); });
+    }
+
+    ~LoopbackServer()
+    {
+        thread_.join();
+        close(listener_);
+    }
+
+    [[nodiscard]] uint16_t port() const { return port_; }
+};
+
+/**
+ * @brief Animate on the host clock while a forecast is fetched from a
+ * loopback server, and compare frame times during the fetch with those
+ * before it. Checks the forecast that arrives is the one served, that it
+ * still arrives when lwIP won't close the connection, and that the copy in
+ * flash counts as fresh after a reboot.
+ */
+static bool bench_fetch(WeatherDisplayHandler &handler, const HostOptions &options)
+{
+    const std::string body = read_file(options.fetch_file);
+    if (body.empty())
+    {
+        return false;
+    }
+    std::array<DayForecast, NUM_DAYS> expected{};
+    ForecastParser reference(expected);
+    if (!reference.feed(body) || !reference.complete())
+    {
+        printf("%s isn't a forecast response\n", options.fetch_file.c_str());
+        return false;
+    }
+
+    host_use_real_clock();
+    handler.update_weather(build_forecast(options.weather));
+    handler.set_render_mode(options.mode);
+    LoopbackServer server(body, options.chunk, options.serve_delay_ms);
+    WebHandler web("", "", "host-key");
+    web.set_weather_api("127.0.0.1", server.port(), false);
+    web.sync_time();
+
+    struct FrameTimes
+    {
+        uint32_t frames = 0;
+        double total_us = 0;
+        double max_us = 0;
+        double poll_max_us = 0;
+
+        void add(const double frame_us, const double poll_us)
+        {
+            frames++;
+            total_us += frame_us;
+            max_us = std::max(max_us, frame_us);
+            poll_max_us = std::max(poll_max_us, poll_us);
+        }
+    };
+    FrameTimes before;
+    FrameTimes during;
+
+    constexpr uint32_t kWarmupFrames = 60;
+    std::array<DayForecast, NUM_DAYS> received{};
+    size_t days = 0;
+    uint64_t last_us = time_us_64();
+    for (uint32_t frame = 0; days == 0 && frame < kWarmupFrames + 20 * 75; frame++)
+    {
+        if (frame == kWarmupFrames && !web.start_weather_fetch(NUM_DAYS))
+        {
+            return false;
+        }
+
+        const uint64_t poll_start = time_us_64();
+        web.poll_weather_fetch();
+        const uint64_t poll_us = time_us_64() - poll_start;
+        if ((days = web.take_forecast(received)) != 0)
+        {
+            handler.update_weather(std::span<const DayForecast>(received).first(days));
+        }
+        handler.refresh_and_update_display();
+
+        const uint64_t now = time_us_64();
+        (frame < kWarmupFrames ? before : during).add(now - last_us, poll_us);
+        last_us = now;
+    }
+    handler.set_render_mode(RenderMode::kSerial);
+
+    const double target_us = 1e6 / options.fps;
+    printf("\n%s: %zu bytes in %zu byte pieces %u ms apart, target frame %.0f us\n", options.fetch_file.c_str(),
+           body.size(), options.chunk, options.serve_delay_ms, target_us);
+    printf("  request: %s\n", server.request.c_str());
+    printf("  before fetch: %4u frames, mean %.0f us, max %.0f us\n", before.frames, before.total_us / before.frames, before.max_us);
+    printf("  during fetch: %4u frames, mean %.0f us, max %.0f us, poll max %.0f us\n", during.frames,
+           during.total_us / during.frames, during.max_us, during.poll_max_us);
+    printf("  fetch took %.0f ms; a blocking fetch would have frozen the animation that long\n", during.total_us / 1000);
+
+    if (days != NUM_DAYS || received != expected)
+    {
+        printf("FAIL: the forecast fetched isn't the one served\n");
+        return false;
+    }
+    for (uint8_t day = 0; day < NUM_DAYS; day++)
+    {
+        if (handler.get_forecast(day) != expected[day])
+        {
+            printf("FAIL: day %u isn't showing the fetched forecast\n", day);
+            return false;
+        }
+    }
+    printf("  forecast fetched and shown matches the one served\n");
+
+    // Again with lwIP refusing to close, so the client aborts from inside its receive callback.
+    host_close_fails = true;
+    LoopbackServer refusing(body, options.chunk, 0);
+    WebHandler aborting("", "", "host-key");
+    aborting.set_weather_api("127.0.0.1", refusing.port(), false);
+    std::array<DayForecast, NUM_DAYS> refetched{};
+    size_t refetched_days = 0;
+    aborting.start_weather_fetch(NUM_DAYS);
+    for (uint32_t frame = 0; refetched_days == 0 && frame < 20 * 75; frame++)
+    {
+        aborting.poll_weather_fetch();
+        refetched_days = aborting.take_forecast(refetched);
+        sleep_us(lroundf(1e6f / options.fps));
+    }
+    host_close_fails = false;
+    if (refetched_days != NUM_DAYS || refetched != expected)
+    {
+        printf("FAIL: the fetch didn't survive lwIP refusing to close the connection\n");
+        return false;
+    }
+    if (host_lwip_bad_returns != 0)
+    {
+        printf("FAIL: %lu callbacks returned ERR_ABRT without aborting, or aborted and didn't\n",
+               static_cast<unsigned long>(host_lwip_bad_returns));
+        return false;
+    }
+    printf("  fetched again with lwIP refusing to close, every callback returned ERR_ABRT exactly when it aborted\n");
+
+    // As after a reboot: the time is lost, the forecast comes back from flash,
+    // and it must still count as fresh once the clock has had time to sync.
+    // The simulated clock gets past kClockWaitUs without the wait.
+    host_real_clock = false;
+    wall_clock::set(0);
+    WebHandler rebooted("", "", "host-key");
+    std::array<DayForecast, NUM_DAYS> cached{};
+    if (rebooted.load_cached_forecast() != NUM_DAYS || rebooted.take_forecast(cached) != NUM_DAYS || cached != expected)
+    {
+        printf("FAIL: the forecast wasn't cached in flash\n");
+        return false;
+    }
+    rebooted.sync_time();
+    const uint64_t synced_from_us = time_us_64();
+    while (time_us_64() - synced_from_us < 2 * WebHandler::kClockWaitUs)
+    {
+        rebooted.poll_weather_fetch();
+        if (rebooted.weather_fetch_due(5 * 60))
+        {
+            printf("FAIL: a fresh cached forecast would be fetched again %llu ms after boot, the clock %s\n",
+                   static_cast<unsigned long long>((time_us_64() - synced_from_us) / 1000),
+                   wall_clock::known() ? "known" : "never synced");
+            return false;
+        }
+        sleep_us(lroundf(1e6f / options.fps));
+    }
+    printf("  after a reboot the forecast loads from flash, the clock syncs and no fetch is due\n");
+    return true;
+}
+
+/**
+ * @brief Exercise ForecastStore on the emulated flash: a round trip, the
+ * rewrite policy, how erases spread over many saves, and recovery from a
+ * write cut short by a power cut.
+ */
+static bool store_check()
+{
+    using Store = ForecastStore<WebHandler::kMaxDays>;
+    constexpr uint32_t kStart = 1'790'000'000;
+
+    bool ok = true;
+    const auto check = [&ok](const bool pass, const char *what)
+    {
+        printf("  %s %s\n", pass ? "ok  " : "FAIL", what);
+        ok &= pass;
+    };
+
+    // Whatever was in flash before the store was first used.
+    for (uint32_t i = Store::kOffset; i < PICO_FLASH_SIZE_BYTES; i++)
+    {
+        host_flash()[i] = static_cast<uint8_t>(i * 37);
+    }
+
+    Forecast days = build_forecast({"heavy_rain", "heavy_snow", "thunderstorm"});
+    std::array<DayForecast, WebHandler::kMaxDays> loaded{};
+    uint32_t fetched = 0;
+    const auto loads = [&loaded, &fetched, &days](const Store &store, const uint32_t when)
+    {
+        return store.load(loaded, fetched) == days.size() && std::equal(days.begin(), days.end(), loaded.begin()) && fetched == when;
+    };
+
+    printf("Forecast store, %u sectors at 0x%06lx, %zu byte days, %lu records of %u days per cycle\n", Store::kSectors,
+           static_cast<unsigned long>(Store::kOffset), sizeof(DayForecast), static_cast<unsigned long>(Store::records_per_cycle(NUM_DAYS)), NUM_DAYS);
+    {
+        Store store;
+        check(store.load(loaded, fetched) == 0, "nothing loads from flash the store hasn't written");
+        check(store.save(days, kStart), "a forecast saves");
+        check(loads(store, kStart), "and loads back the same");
+        check(!store.save(days, kStart + 5 * 60), "the same forecast five minutes later isn't written again");
+        check(store.save(days, kStart + Store::kRewriteAfterS), "but is an hour later");
+    }
+    {
+        const Store rebooted;
+        check(loads(rebooted, kStart + Store::kRewriteAfterS), "after a reboot the newest record loads");
+    }
+
+    // Wear over many saves of a changing forecast, one every five minutes.
+    constexpr uint32_t kSaves = 10'000;
+    const uint32_t first_sector = Store::kOffset / FLASH_SECTOR_SIZE;
+    std::fill(host_flash_erases().begin(), host_flash_erases().end(), 0);
+    uint32_t when = kStart;
+    {
+        Store store;
+        for (uint32_t i = 0; i < kSaves; i++)
+        {
+            days[0].temperature = static_cast<float>(i);
+            when += 5 * 60;
+            store.save(days, when);
+        }
+        check(store.writes() == kSaves && loads(store, when), "every changed forecast is written");
+    }
+    uint32_t most_erases = 0;
+    for (uint32_t sector = 0; sector < Store::kSectors; sector++)
+    {
+        const uint32_t erases = host_flash_erases()[first_sector + sector];
+        most_erases = std::max(most_erases, erases);
+        printf("  sector %lu: %lu erases\n", static_cast<unsigned long>(sector), static_cast<unsigned long>(erases));
+    }
+    const uint32_t expected_erases = kSaves / Store::records_per_cycle(NUM_DAYS) + 1;
+    check(most_erases <= expected_erases, "erases are shared evenly, one per sector of records");
+    printf("  at one save every 5 minutes a 100k-cycle sector lasts %.0f years\n",
+           100'000.0 / most_erases * kSaves * 5 / (60 * 24 * 365));
+
+    // Erasing ahead, as when the display idles, leaves a sector of saves that only program.
+    {
+        Store store;
+        const uint32_t erases = store.erases();
+        const bool erased = store.erase_ahead();
+        for (uint32_t i = 0; i < Store::records_per_cycle(NUM_DAYS) / Store::kSectors; i++)
+        {
+            days[0].temperature = static_cast<float>(kSaves + i);
+            when += 5 * 60;
+            store.save(days, when);
+        }
+        check(erased && store.erases() == erases + 1 && loads(store, when), "after erasing ahead, a sector of saves erases nothing");
+        check(!store.erase_ahead() || store.erases() == erases + 2, "and erasing ahead again is safe");
+        check(loads(store, when), "and keeps the newest record");
+    }
+
+    // A save cut short by a power cut: the end of the record is never programmed and stays erased.
+    const DayForecast before_cut = days[0];
+    days[0].temperature = -1.0f;
+    {
+        Store store;
+        store.save(days, when + 300);
+        const auto record = host_flash().begin() + Store::kOffset + store.newest_page() * FLASH_PAGE_SIZE;
+        std::fill(record + 100, record + FLASH_PAGE_SIZE, 0xFF);
+    }
+    days[0] = before_cut;
+    {
+        Store rebooted;
+        check(loads(rebooted, when), "a record cut short is passed over for the one before it");
+        days[0].temperature = -2.0f;
+        check(rebooted.save(days, when + 600), "and the next save goes past it");
+    }
+    {
+        const Store rebooted;
+        check(loads(rebooted, when + 600), "and loads after another reboot");
+    }
+
+    printf("%s\n", ok ? "Forecast store OK" : "Forecast store FAILED");
+    return ok;
+}
+
+/**
+ * @brief Take the display through a room getting lighter and darker, with the
+ * light falling on the emulated AP3216, once in each of AmbientLight's modes.
+ * Checks the brightness settles on the right level in each phase, and counts
+ * the bus transfers it took.
+ */
+static bool light_check(WeatherDisplayHandler &handler, const Forecast &forecast, const float fps)
+{
+    struct Phase
+    {
+        float seconds;
+        float lux;
+    };
+    static constexpr Phase kPhases[] = {{3.0f, 0.5f}, {3.0f, 3.0f}, {12.0f, 40.0f}, {3.0f, 0.5f}};
+
+    handler.update_weather(forecast);
+    bool ok = true;
+    for (const AmbientLight::Mode mode : {AmbientLight::Mode::kPolled, AmbientLight::Mode::kThresholds})
+    {
+        host_ap3216.lux = kPhases[0].lux;
+        handler.set_ambient_light_mode(mode);
+        const AmbientLight &light = handler.get_ambient_light();
+        printf("%s:\n", AmbientLight::mode_name(mode));
+
+        uint32_t total = 0;
+        for (const Phase &phase : kPhases)
+        {
+            host_ap3216.lux = phase.lux;
+            const uint32_t transfers = host_ap3216.transfers;
+            const uint32_t frames = lroundf(phase.seconds * fps);
+            for (uint32_t frame = 0; frame < frames; frame++)
+            {
+                handler.refresh_and_update_display();
+            }
+            const uint32_t used = host_ap3216.transfers - transfers;
+            total += used;
+
+            const bool settled = light.brightness() == AmbientLight::to_brightness(phase.lux);
+            ok &= settled;
+            printf("  %5.1f lux for %4.1f s: brightness %2u%s, %4lu bus transfers (%.1f/s)\n", phase.lux, phase.seconds,
+                   light.brightness(), settled ? "" : " (WRONG)", static_cast<unsigned long>(used), used / phase.seconds);
+        }
+        printf("  %lu bus transfers, %lu readings, %lu interrupts; %ld us/frame recovered\n", static_cast<unsigned long>(total),
+               static_cast<unsigned long>(light.samples()), static_cast<unsigned long>(light.interrupts()),
+               static_cast<long>(handler.get_ambient_light_saving_us()));
+    }
+
+    // Only the sensor's first reading, before its timer and interrupt start, may wait on the bus.
+    const bool off_interrupts = host_i2c_blocking_in_irq == 0;
+    ok &= off_interrupts;
+    printf("  %lu blocking transfers from interrupts%s\n", static_cast<unsigned long>(host_i2c_blocking_in_irq),
+           off_interrupts ? "" : " (WRONG)");
+
+    printf("%s\n", ok ? "Light sensor OK" : "Light sensor FAILED");
+    return ok;
+}
+
+/**
+ * @brief Read the emulated AP3216's IR, ALS and PS data every way the driver
+ * can: a register at a time, through the getters, in one burst and in one
+ * burst queued in the controller's FIFO. Checks they all decode the same and
+ * counts the transactions and the time each way holds the caller.
+ */
+static bool sensor_check()
+{
+    // Exposes the single-register read the getters were built on.
+    struct Sensor : AP3216_WE
+    {
+        using AP3216_WE::readReg;
+    };
+
+    bool ok = true;
+    const auto check = [&ok](const bool passed, const char *what)
+    {
+        printf("  %-58s %s\n", what, passed ? "ok" : "FAILED");
+        ok &= passed;
+    };
+    const auto same = [](const AP3216Data &a, const AP3216Data &b)
+    {
+        return a.ir == b.ir && a.als == b.als && a.proximity == b.proximity && a.irOverflowed == b.irOverflowed &&
+               a.proximityValid == b.proximityValid && a.objectNear == b.objectNear;
+    };
+    const auto decode = [](const uint8_t *data)
+    {
+        return AP3216Data{static_cast<uint16_t>((data[1] << 2) + (data[0] & 0b11)),
+                          static_cast<uint16_t>((data[3] << 8) + data[2]),
+                          static_cast<uint16_t>(((data[5] & 0x3F) << 4) + (data[4] & 0x0F)),
+                          (data[0] & 0x80) != 0,
+                          (data[4] & 0x40) == 0,
+                          (data[5] >> 7) == 1};
+    };
+
+    // Times a way of reading, and counts the transactions it made.
+    struct Cost
+    {
+        uint32_t transactions;
+        uint32_t transfers;
+        uint64_t held_us;
+    };
+    const auto measure = [](const std::function<void()> &read)
+    {
+        const uint32_t transactions = host_ap3216.transactions;
+        const uint32_t transfers = host_ap3216.transfers;
+        const uint64_t start = time_us_64();
+        read();
+        return Cost{host_ap3216.transactions - transactions, host_ap3216.transfers - transfers, time_us_64() - start};
+    };
+    const auto report = [](const char *way, const Cost &cost)
+    {
+        printf("  %-20s %2lu transactions, %2lu transfers, %4llu us held\n", way, static_cast<unsigned long>(cost.transactions),
+               static_cast<unsigned long>(cost.transfers), static_cast<unsigned long long>(cost.held_us));
+    };
+
+    Sensor sensor;
+    sensor.init(i2c0);
+    sensor.setPSThresholds(100, 500);
+    host_ap3216.lux = 123.4f;
+    host_ap3216.ir = 777;
+    host_ap3216.proximity = 600;
+    sleep_ms(150); // One conversion.
+
+    uint8_t bytes[6];
+    const Cost single = measure([&]
+                                {
+                                    for (uint8_t i = 0; i < 6; i++)
+                                    {
+                                        bytes[i] = sensor.readReg(AP3216_WE::IR_DATA_LOW_REG + i);
+                                    }
+                                });
+    const AP3216Data by_register = decode(bytes);
+
+    AP3216Data by_getter{};
+    const Cost getters = measure([&]
+                                 {
+                                     by_getter.ir = sensor.getIRData();
+                                     by_getter.irOverflowed = sensor.irDataIsOverflowed();
+                                     by_getter.als = static_cast<uint16_t>(lroundf(sensor.getAmbientLight() / sensor.alsToLux(1)));
+                                     by_getter.proximity = sensor.getProximity();
+                                     by_getter.proximityValid = sensor.proximityIsValid();
+                                     by_getter.objectNear = sensor.objectIsNear();
+                                 });
+
+    AP3216Data burst{};
+    const Cost burst_cost = measure([&]
+                                    { burst = sensor.getAllData(); });
+
+    uint8_t queued_bytes[6] = {};
+    ap3216_burst_status first = BURST_IDLE;
+    bool refused = false;
+    const Cost queue_cost = measure([&]
+                                    {
+                                        sensor.startReadRegs(AP3216_WE::IR_DATA_LOW_REG, 6);
+                                        refused = !sensor.startReadRegs(AP3216_WE::IR_DATA_LOW_REG, 6);
+                                        first = sensor.pollReadRegs(queued_bytes);
+                                    });
+    sleep_us(500);
+    const ap3216_burst_status later = sensor.pollReadRegs(queued_bytes);
+    const AP3216Data queued = decode(queued_bytes);
+
+    report("a register at a time", single);
+    report("getters", getters);
+    report("one burst", burst_cost);
+    report("one queued burst", queue_cost);
+
+    check(by_register.ir == 777 && by_register.proximity == 600 && by_register.objectNear && by_register.proximityValid &&
+              std::fabs(sensor.alsToLux(by_register.als) - host_ap3216.lux) <= sensor.alsToLux(1),
+          "single registers read what the sensor latched");
+    check(same(by_getter, by_register), "the getters agree");
+    check(same(burst, by_register), "one burst agrees");
+    check(burst_cost.transactions == 1, "in one transaction");
+    check(first == BURST_BUSY && queue_cost.held_us == 0, "a queued burst returns at once");
+    check(refused, "and refuses a second while it is queued");
+    check(later == BURST_DONE && same(queued, by_register), "then collects the same data");
+    check(queue_cost.transactions == 1, "in one transaction");
+    check(sensor.pollReadRegs(queued_bytes) == BURST_IDLE, "and nothing is left queued");
+    check(!sensor.startReadRegs(AP3216_WE::IR_DATA_LOW_REG, MAX_BURST_LEN + 1), "a burst longer than the FIFO is refused");
+
+    printf("%s\n", ok ? "Sensor driver OK" : "Sensor driver FAILED");
+    return ok;
+}
+
+// Simulated time charged per particle with each panel update, see --particle-cost.
+static float particle_cost_us = 0.0f;
+
+/**
+ * @brief Run a forecast with each particle costing enough to overrun the
+ * frame budget, then with the cost gone again. Checks the governor cuts the
+ * particle load until the frames fit, holds it there without oscillating,
+ * thins the particles without a sudden drop, and gives the load back once
+ * the frames are cheap again.
+ */
+static bool governor_check(WeatherDisplayHandler &handler, const Forecast &forecast, const float fps)
+{
+    bool ok = true;
+    const auto check = [&ok](const bool passed, const char *what)
+    {
+        printf("  %-58s %s\n", what, passed ? "ok" : "FAILED");
+        ok &= passed;
+    };
+
+    handler.set_render_mode(RenderMode::kSerial);
+    handler.update_weather(forecast);
+    const FrameGovernor &governor = handler.get_frame_governor();
+    const uint32_t period_us = lroundf(1e6f / fps);
+
+    // Fill the segments at no cost, then charge enough that the full load takes 1.5 frame periods.
+    particle_cost_us = 0.0f;
+    for (uint32_t frame = 0; frame < lroundf(5.0f * fps); frame++)
+    {
+        handler.refresh_and_update_display();
+    }
+    const uint16_t full = handler.get_total_particle_count();
+    particle_cost_us = 1.5f * period_us / full;
+    printf("%u particles at full load, %.1f us each\n", full, particle_cost_us);
+
+    struct Phase
+    {
+        float seconds;
+        uint32_t misses;      // Budget misses in the phase's last kTailS seconds.
+        uint32_t changes;     // Load changes in them.
+        float biggest_drop;   // Largest share of the particles lost from one frame to the next.
+    };
+    static constexpr float kTailS = 10.0f;
+    const auto run = [&](const float seconds)
+    {
+        Phase phase{seconds, 0, 0, 0.0f};
+        const uint32_t frames = lroundf(seconds * fps);
+        const uint32_t tail = frames - lroundf(kTailS * fps);
+        uint16_t particles = handler.get_total_particle_count();
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            const uint32_t misses = governor.misses();
+            const uint32_t changes = governor.cuts() + governor.raises();
+            handler.refresh_and_update_display();
+            const uint16_t now = handler.get_total_particle_count();
+            phase.biggest_drop = std::max(phase.biggest_drop, particles ? (particles - std::min(particles, now)) / float(particles) : 0.0f);
+            particles = now;
+            if (frame >= tail)
+            {
+                phase.misses += governor.misses() - misses;
+                phase.changes += governor.cuts() + governor.raises() - changes;
+            }
+            if ((frame + 1) % lroundf(5.0f * fps) == 0)
+            {
+                printf("  %5.1f s: load %.2f, %3u particles, work %5.0f us of %lu\n", (frame + 1) / fps, governor.load(), now,
+                       governor.work_us(), static_cast<unsigned long>(period_us));
+            }
+        }
+        return phase;
+    };
+
+    char what[80];
+    printf("Overloaded:\n");
+    const Phase overloaded = run(60.0f);
+    snprintf(what, sizeof(what), "cuts the load to %.2f", governor.load());
+    check(governor.load() < 1.0f / 1.5f + 0.05f && governor.load() > 0.4f, what);
+    snprintf(what, sizeof(what), "frames fit: %lu budget misses in the last %.0f s", static_cast<unsigned long>(overloaded.misses), kTailS);
+    check(overloaded.misses <= kTailS * fps / 100, what);
+    snprintf(what, sizeof(what), "load holds: %lu changes in the last %.0f s", static_cast<unsigned long>(overloaded.changes), kTailS);
+    check(overloaded.changes == 0, what);
+    snprintf(what, sizeof(what), "thinned gradually: at most %.0f%% of the particles in a frame", overloaded.biggest_drop * 100);
+    check(overloaded.biggest_drop < 0.1f, what);
+
+    printf("Cheap again:\n");
+    particle_cost_us = 0.0f;
+    const Phase cheap = run(60.0f);
+    snprintf(what, sizeof(what), "gives the load back: %.2f", governor.load());
+    check(governor.load() == 1.0f && cheap.misses == 0 && cheap.changes == 0, what);
+    check(handler.get_total_particle_count() == full, "and the particles fill back up");
+
+    printf("%lu cuts, %lu raises, %lu budget misses in %lu frames\n", static_cast<unsigned long>(governor.cuts()),
+           static_cast<unsigned long>(governor.raises()), static_cast<unsigned long>(governor.misses()),
+           static_cast<unsigned long>(governor.frames()));
+    printf("%s\n", ok ? "Frame governor OK" : "Frame governor FAILED");
+    return ok;
+}
+
+/**
+ * @brief Leave the emulated room dark and empty until the display idles, then
+ * wake it twice: once by coming near the sensor, once by turning the light
+ * on. Checks the idle display holds its frame at the lower clock, and that
+ * waking draws on the first frame after the sensor notices.
+ */
+static bool idle_check(WeatherDisplayHandler &handler, const Forecast &forecast)
+{
+    bool ok = true;
+    const auto check = [&ok](const bool passed, const char *what)
+    {
+        printf("  %-58s %s\n", what, passed ? "ok" : "FAILED");
+        ok &= passed;
+    };
+
+    handler.update_weather(forecast);
+    const AmbientLight &light = handler.get_ambient_light();
+    const IdleMode &idle = handler.get_idle_mode();
+    const uint32_t active_khz = host_sys_clock_khz;
+
+    // Runs frames until done() or the time is up; false if it ran out.
+    const auto run_until = [&handler](const float seconds, const std::function<bool()> &done)
+    {
+        const uint64_t until = time_us_64() + static_cast<uint64_t>(seconds * 1e6f);
+        while (time_us_64() < until)
+        {
+            handler.refresh_and_update_display();
+            if (done())
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Wakes the display some way and checks it draws on the first frame after
+    // the sensor reading that showed it.
+    const auto wake = [&](const char *how, const std::function<void()> &change, const std::function<bool()> &noticed)
+    {
+        printf("%s:\n", how);
+        change();
+        const bool seen = run_until(1.0f, noticed);
+        const uint32_t frames = hub75.frames;
+        const uint64_t seen_us = time_us_64();
+        handler.refresh_and_update_display();
+        char what[64];
+        snprintf(what, sizeof(what), "a frame drawn %llu us after the sensor noticed",
+                 static_cast<unsigned long long>(time_us_64() - seen_us));
+        check(seen && hub75.frames == frames + 1 && idle.state() == PowerState::kActive, what);
+        check(host_sys_clock_khz == active_khz, "at the full clock");
+    };
+
+    const auto go_idle = [&]()
+    {
+        host_ap3216.lux = 0.5f;
+        host_ap3216.proximity = 0;
+        const float before = idle.seconds_in(PowerState::kActive);
+        const bool idled = run_until(IdleMode::kIdleAfterMs / 1000.0f + 2.0f, [&idle]
+                                     { return idle.state() == PowerState::kIdle; });
+        char what[64];
+        snprintf(what, sizeof(what), "idles after %.1f s dark and empty", idle.seconds_in(PowerState::kActive) - before);
+        check(idled, what);
+        check(host_sys_clock_khz == IdleMode::kIdleClockKhz, "at the idle clock");
+
+        const uint32_t frames = hub75.frames;
+        const uint32_t transfers = host_ap3216.transfers;
+        const uint32_t samples = light.samples();
+        const uint32_t particles = handler.get_total_particle_count();
+        run_until(20.0f, []
+                  { return false; });
+        check(hub75.frames == frames && handler.get_total_particle_count() == particles,
+              "holds its frame and the simulation for 20 s");
+        snprintf(what, sizeof(what), "reading the sensor %lu times, %lu bus transfers", static_cast<unsigned long>(light.samples() - samples),
+                 static_cast<unsigned long>(host_ap3216.transfers - transfers));
+        // Polled, the sensor is still read every conversion; following thresholds, only on the safety re-read.
+        check(light.mode() == AmbientLight::Mode::kPolled ? light.samples() - samples >= 20'000 / AmbientLight::kSamplePeriodMs - 1
+                                                          : light.samples() - samples <= 20'000 / AmbientLight::kRecheckPeriodMs,
+              what);
+    };
+
+    for (const AmbientLight::Mode mode : {AmbientLight::Mode::kThresholds, AmbientLight::Mode::kPolled})
+    {
+        printf("Following the light %s:\n", AmbientLight::mode_name(mode));
+        host_ap3216.proximity = 1023;
+        host_ap3216.lux = 0.5f;
+        handler.set_ambient_light_mode(mode);
+        run_until(2.0f, []
+                  { return false; });
+        check(idle.state() == PowerState::kActive, "stays active in the dark with someone near");
+
+        go_idle();
+        wake("Someone comes near", []
+             { host_ap3216.proximity = 1023; },
+             [&light]
+             { return light.near(); });
+
+        go_idle();
+        wake("The light comes on", []
+             { host_ap3216.lux = 40.0f; },
+             [&light]
+             { return light.brightness() > AmbientLight::kMinBrightness; });
+    }
+
+    printf("Active %.1f s, idle %.1f s, %lu wakes, %lu interrupts\n", idle.seconds_in(PowerState::kActive),
+           idle.seconds_in(PowerState::kIdle), static_cast<unsigned long>(idle.wakes()),
+           static_cast<unsigned long>(light.interrupts()));
+    printf("%s\n", ok ? "Idle mode OK" : "Idle mode FAILED");
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    HostOptions options;
+    if (!parse_options(argc, argv, options))
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (!options.parse_file.empty())
+    {
+        return bench_parse(options.parse_file, options.chunk) ? 0 : 1;
+    }
+    if (options.store_check)
+    {
+        return store_check() ? 0 : 1;
+    }
+    if (options.sensor_check)
+    {
+        return sensor_check() ? 0 : 1;
+    }
+    if (options.fixed_check)
+    {
+        return bench::fixed_point_accuracy(10'000) ? 0 : 1;
+    }
+
+    if (options.real_clock)
+    {
+        host_use_real_clock();
+    }
+
+    if (!options.out_dir.empty())
+    {
+        std::filesystem::create_directories(options.out_dir);
+        hub75.on_update = [&options](const Hub75 &panel)
+        {
+            const uint32_t frame = panel.frames - 1;
+            if (frame % options.every == 0)
+            {
+                char name[32];
+                snprintf(name, sizeof(name), "frame_%05lu.ppm", static_cast<unsigned long>(frame));
+                write_ppm((std::filesystem::path(options.out_dir) / name).string(), panel);
+            }
+        };
+    }
+
+    seed_rng(options.seed);
+
+    // Someone is in the emulated room, so long runs never idle.
+    host_ap3216.proximity = 1023;
+
+    WeatherDisplayHandler weather_handler(graphics, hub75, NUM_DAYS, options.fps);
+    particle_cost_us = options.particle_cost_us;
+    hub75.on_update = [previous = hub75.on_update, &weather_handler](const Hub75 &panel)
+    {
+        if (previous)
+        {
+            previous(panel);
+        }
+        host_busy_us(lroundf(weather_handler.get_total_particle_count() * particle_cost_us));
+    };
+    if (!options.fetch_file.empty())
+    {
+        return bench_fetch(weather_handler, options) ? 0 : 1;
+    }
+    if (options.rng_check)
+    {
+        // Segments cost nothing on the simulated clock unless charged for, and
+        // split mode would leave them all on core 0 with nothing for the check
+        // to catch.
+        if (particle_cost_us == 0.0f)
+        {
+            particle_cost_us = 1.0f;
+        }
+        return bench::frame_determinism(weather_handler, build_forecast(options.weather), options.seed, options.frames) ? 0 : 1;
+    }
+    if (options.light_check)
+    {
+        return light_check(weather_handler, build_forecast(options.weather), options.fps) ? 0 : 1;
+    }
+    if (options.idle_check)
+    {
+        return idle_check(weather_handler, build_forecast(options.weather)) ? 0 : 1;
+    }
+    if (options.governor_check)
+    {
+        return governor_check(weather_handler, build_forecast(options.weather), options.fps) ? 0 : 1;
+    }
+    if (options.bench_update > 0)
+    {
+        bench_update_weather(weather_handler, build_forecast(options.weather), options.bench_update);
+        return 0;
+    }
+    weather_handler.update_weather(build_forecast(options.weather));
+    weather_handler.set_render_mode(options.mode);
+
+    uint64_t particle_sum = 0;
+    uint64_t simulate_sum = 0;
+    uint64_t render_sum = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < options.frames; frame++)
+    {
+        weather_handler.refresh_and_update_display();
+        particle_sum += weather_handler.get_total_particle_count();
+        simulate_sum += weather_handler.get_simulate_us();
+        render_sum += weather_handler.get_render_us();
+    }
+    // Let the last frame finish on core 1.
+    weather_handler.set_render_mode(RenderMode::kSerial);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    const double frames = std::max<uint32_t>(options.frames, 1);
+    printf("\n%lu frames, %s mode\n", static_cast<unsigned long>(options.frames), render_mode_name(options.mode));
+    printf("Host time: %.2f us/frame\n", std::chrono::duration<double, std::micro>(elapsed).count() / frames);
+    printf("Average particles: %.1f\n", particle_sum / frames);
+    const FrameGovernor &governor = weather_handler.get_frame_governor();
+    printf("Particle load: %.2f, %lu cuts, %lu raises; frame budget missed %lu times\n", governor.load(),
+           static_cast<unsigned long>(governor.cuts()), static_cast<unsigned long>(governor.raises()),
+           static_cast<unsigned long>(governor.misses()));
+    const AmbientLight &light = weather_handler.get_ambient_light();
+    printf("Light sensor: %lu readings of %lu us, %ld us/frame recovered\n", static_cast<unsigned long>(light.samples()),
+           static_cast<unsigned long>(light.read_us()), static_cast<long>(weather_handler.get_ambient_light_saving_us()));
+    if (options.real_clock)
+    {
+        printf("Average simulate: %.2f us, render: %.2f us\n", simulate_sum / frames, render_sum / frames);
+    }
+    return 0;
+}
@@ -0,0 +1,12 @@
+#ifndef HOST_ARM_MATH_H
+#define HOST_ARM_MATH_H
+
+// Host stand-in for the parts of CMSIS-DSP arm_math.h used outside the
+// ARM_MATH_CM33 paths.
+
+#include <stdint.h>
+#include <math.h>
+
+#define PI 3.14159265358979f
+
+#endif
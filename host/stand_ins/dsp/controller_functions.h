@@ -0,0 +1,15 @@
+#ifndef HOST_DSP_CONTROLLER_FUNCTIONS_H
+#define HOST_DSP_CONTROLLER_FUNCTIONS_H
+
+// Host stand-in for the CMSIS-DSP controller functions, using libm.
+
+#include <cmath>
+
+inline void arm_sin_cos_f32(float theta, float *p_sin, float *p_cos)
+{
+    const float rad = theta * 0.0174532925f;
+    *p_sin = sinf(rad);
+    *p_cos = cosf(rad);
+}
+
+#endif
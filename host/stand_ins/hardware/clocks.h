@@ -0,0 +1,22 @@
+#ifndef HOST_HARDWARE_CLOCKS_H
+#define HOST_HARDWARE_CLOCKS_H
+
+// Host stand-in for hardware/clocks.h. Reports the clock the firmware last
+// asked for, so cycle counts in benchmarks are scaled as on the target.
+
+#include <cstdint>
+
+enum clock_handle
+{
+    clk_ref = 4,
+    clk_sys = 5
+};
+
+inline uint32_t host_sys_clock_khz = 150'000;
+
+inline uint32_t clock_get_hz(clock_handle)
+{
+    return host_sys_clock_khz * 1000;
+}
+
+#endif
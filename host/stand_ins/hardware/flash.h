@@ -0,0 +1,59 @@
+#ifndef HOST_HARDWARE_FLASH_H
+#define HOST_HARDWARE_FLASH_H
+
+// Host stand-in for hardware/flash.h: the flash is an array in memory that
+// behaves like NOR flash. Erasing sets a sector to 0xFF and programming can
+// only clear bits, so a write to unerased flash corrupts it as it would on
+// the board. Erases are counted per sector, for checking wear.
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (4 * 1024 * 1024) // As on the Pico 2 W.
+#endif
+
+inline std::vector<uint8_t> &host_flash()
+{
+    static std::vector<uint8_t> flash(PICO_FLASH_SIZE_BYTES, 0xFF);
+    return flash;
+}
+
+inline std::vector<uint32_t> &host_flash_erases()
+{
+    static std::vector<uint32_t> erases(PICO_FLASH_SIZE_BYTES / FLASH_SECTOR_SIZE, 0);
+    return erases;
+}
+
+// Flash is read through the XIP window, here the array itself.
+#define XIP_BASE (reinterpret_cast<uintptr_t>(host_flash().data()))
+
+inline void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    assert(flash_offs % FLASH_SECTOR_SIZE == 0 && count % FLASH_SECTOR_SIZE == 0);
+    assert(flash_offs + count <= PICO_FLASH_SIZE_BYTES);
+    for (size_t i = 0; i < count; i++)
+    {
+        host_flash()[flash_offs + i] = 0xFF;
+    }
+    for (size_t sector = flash_offs / FLASH_SECTOR_SIZE; sector < (flash_offs + count) / FLASH_SECTOR_SIZE; sector++)
+    {
+        host_flash_erases()[sector]++;
+    }
+}
+
+inline void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+    assert(flash_offs % FLASH_PAGE_SIZE == 0 && count % FLASH_PAGE_SIZE == 0);
+    assert(flash_offs + count <= PICO_FLASH_SIZE_BYTES);
+    for (size_t i = 0; i < count; i++)
+    {
+        host_flash()[flash_offs + i] &= data[i];
+    }
+}
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef HOST_HARDWARE_GPIO_H
+#define HOST_HARDWARE_GPIO_H
+
+// Host stand-in for hardware/gpio.h. Pins are levels in memory: an input
+// reads its pull until host code drives it with host_gpio_drive(), the way a
+// sensor's open-drain interrupt line does. Edges run the IRQ callback at
+// once, as the GPIO interrupt would.
+
+#include <array>
+#include <cstdint>
+
+typedef unsigned int uint;
+
+enum gpio_function
+{
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_SIO = 5
+};
+
+enum gpio_irq_level
+{
+    GPIO_IRQ_LEVEL_LOW = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u,
+    GPIO_IRQ_EDGE_RISE = 0x8u
+};
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+#define GPIO_IN false
+#define GPIO_OUT true
+
+struct HostGpio
+{
+    bool pull_up = false;  // Level when nothing drives it.
+    bool driven = false;   // Held by host code.
+    bool level = false;    // Level it's held at.
+    uint32_t irq_events = 0; // Edges that run the callback.
+};
+
+inline std::array<HostGpio, 48> host_gpios{};
+inline gpio_irq_callback_t host_gpio_callback = nullptr;
+inline bool host_in_gpio_irq = false; // The IRQ callback is running.
+
+inline bool gpio_get(const uint gpio)
+{
+    const HostGpio &pin = host_gpios[gpio];
+    return pin.driven ? pin.level : pin.pull_up;
+}
+
+/**
+ * @brief Run the callback if the pin's level change is an edge it listens for.
+ */
+inline void host_gpio_edge(const uint gpio, const bool was)
+{
+    const bool now = gpio_get(gpio);
+    const uint32_t event = was && !now ? GPIO_IRQ_EDGE_FALL : !was && now ? GPIO_IRQ_EDGE_RISE : 0;
+    if ((host_gpios[gpio].irq_events & event) && host_gpio_callback && !host_in_gpio_irq)
+    {
+        host_in_gpio_irq = true;
+        host_gpio_callback(gpio, event);
+        host_in_gpio_irq = false;
+    }
+}
+
+/**
+ * @brief Hold a pin at a level, as an external device does.
+ */
+inline void host_gpio_drive(const uint gpio, const bool level)
+{
+    const bool was = gpio_get(gpio);
+    host_gpios[gpio].driven = true;
+    host_gpios[gpio].level = level;
+    host_gpio_edge(gpio, was);
+}
+
+/**
+ * @brief Let go of a pin, so it goes back to its pull.
+ */
+inline void host_gpio_release(const uint gpio)
+{
+    const bool was = gpio_get(gpio);
+    host_gpios[gpio].driven = false;
+    host_gpio_edge(gpio, was);
+}
+
+inline void gpio_set_function(uint, gpio_function)
+{
+}
+
+inline void gpio_init(uint)
+{
+}
+
+inline void gpio_set_dir(uint, bool)
+{
+}
+
+inline void gpio_pull_up(const uint gpio)
+{
+    host_gpios[gpio].pull_up = true;
+}
+
+inline void gpio_set_irq_enabled(const uint gpio, const uint32_t events, const bool enabled)
+{
+    if (enabled)
+    {
+        host_gpios[gpio].irq_events |= events;
+    }
+    else
+    {
+        host_gpios[gpio].irq_events &= ~events;
+    }
+}
+
+inline void gpio_set_irq_enabled_with_callback(const uint gpio, const uint32_t events, const bool enabled, const gpio_irq_callback_t callback)
+{
+    host_gpio_callback = callback;
+    gpio_set_irq_enabled(gpio, events, enabled);
+}
+
+#endif
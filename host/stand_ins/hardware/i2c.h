@@ -0,0 +1,476 @@
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+// Host stand-in for hardware/i2c.h. The AP3216 at 0x1E is emulated as a
+// register file (HostAp3216 below) so the driver runs unchanged; any other
+// address accepts writes and reads zeros. Each blocking transfer holds the
+// caller for as long as it would hold the bus. The controller's command FIFO
+// is emulated too (i2c_hw_t below), for drivers that queue a transaction and
+// collect the result later.
+
+#include "hardware/gpio.h"
+#include "pico/time.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+typedef unsigned int uint;
+
+#define I2C_IC_DATA_CMD_CMD_BITS 0x00000100u
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200u
+#define I2C_IC_DATA_CMD_RESTART_BITS 0x00000400u
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x00000040u
+
+/**
+ * @brief The AP3216 light and proximity sensor.
+ *
+ * Registers auto-increment from the pointer set by the first byte of a write,
+ * through any number of bytes in a transaction. While the ALS or PS is
+ * enabled a conversion runs every 100 ms on a host timer. It latches the
+ * light level set with `lux` into the ALS data registers, and after the
+ * configured number of conversions outside the ALS thresholds raises the ALS
+ * interrupt and pulls the INT pin low. The interrupt clears when the ALS data
+ * is read, or when its status bit is written, depending on the clear manner.
+ * With the PS enabled it also latches `ir` and `proximity`, and sets the
+ * object bit above the PS high threshold until it falls below the low one.
+ * The PS interrupt is raised each time the object bit changes in hysteresis
+ * mode, or on each conversion outside the thresholds in zone mode, with no
+ * persistence; it clears as the ALS one does, on reading the PS data.
+ */
+struct HostAp3216
+{
+    static constexpr uint8_t kAddress = 0x1E;
+    static constexpr int64_t kConversionUs = 100'000;
+
+    std::array<uint8_t, 0x30> regs{};
+    uint8_t pointer = 0;
+    float lux = 0.0f;             // Light falling on the sensor.
+    uint16_t ir = 0;              // IR count, 10 bits.
+    uint16_t proximity = 0;       // PS count, 10 bits.
+    bool near = false;            // Object bit, with the PS thresholds' hysteresis.
+    uint int_pin = 22;            // Where INT is wired, I2C_DEFAULT_INT.
+    uint8_t outside = 0;          // Conversions in a row outside the thresholds.
+    repeating_timer_t conversions{};
+    bool converting = false;
+    uint32_t transfers = 0;       // Bus transfers addressed to the sensor: each start or repeated start.
+    uint32_t transactions = 0;    // Transactions with the sensor: each stop.
+    bool first_write = false;     // The next byte written sets the pointer.
+
+    [[nodiscard]] float lux_per_count() const
+    {
+        static constexpr float kLuxPerCount[] = {0.35f, 0.0788f, 0.0197f, 0.0049f};
+        return kLuxPerCount[(regs[0x10] >> 4) & 0b11];
+    }
+
+    [[nodiscard]] uint16_t reg16(const uint8_t low) const
+    {
+        return regs[low] | (regs[low + 1] << 8);
+    }
+
+    void update_pin()
+    {
+        if (regs[0x01] & 0b11)
+        {
+            host_gpio_drive(int_pin, false);
+        }
+        else
+        {
+            host_gpio_release(int_pin);
+        }
+    }
+
+    static bool on_conversion(repeating_timer_t *timer)
+    {
+        static_cast<HostAp3216 *>(timer->user_data)->convert();
+        return true;
+    }
+
+    [[nodiscard]] uint16_t ps_threshold(const uint8_t low) const
+    {
+        return (regs[low] & 0b11) | (regs[low + 1] << 2);
+    }
+
+    void convert()
+    {
+        if (regs[0x00] & 0b010)
+        {
+            const uint16_t ir10 = std::min<uint16_t>(ir, 0x3FF);
+            const uint16_t ps10 = std::min<uint16_t>(proximity, 0x3FF);
+            const bool was_near = near;
+            const bool above = ps10 > ps_threshold(0x2C);
+            const bool below = ps10 < ps_threshold(0x2A);
+            if (above)
+            {
+                near = true;
+            }
+            else if (below)
+            {
+                near = false;
+            }
+            regs[0x0A] = ir10 & 0b11;
+            regs[0x0B] = ir10 >> 2;
+            regs[0x0E] = ps10 & 0x0F;
+            regs[0x0F] = ((ps10 >> 4) & 0x3F) | (near ? 0x80 : 0);
+            // Latch first: the pin's interrupt handler reads the data at once.
+            if ((regs[0x22] & 1) ? near != was_near : above || below)
+            {
+                regs[0x01] |= 0b10;
+                update_pin();
+            }
+        }
+        if ((regs[0x00] & 0b001) == 0)
+        {
+            return;
+        }
+
+        const uint16_t als = static_cast<uint16_t>(std::clamp(std::lround(lux / lux_per_count()), 0L, 65535L));
+        regs[0x0C] = als & 0xFF;
+        regs[0x0D] = als >> 8;
+
+        const uint8_t persist = regs[0x10] & 0x0F;
+        if (als < reg16(0x1A) || als > reg16(0x1C))
+        {
+            if (++outside >= (persist == 0 ? 1 : persist * 4))
+            {
+                outside = 0;
+                regs[0x01] |= 0b01;
+                update_pin();
+            }
+        }
+        else
+        {
+            outside = 0;
+        }
+    }
+
+    void write_reg(const uint8_t reg, const uint8_t value)
+    {
+        if (reg >= regs.size())
+        {
+            return;
+        }
+        if (reg == 0x00)
+        {
+            if (value == 0b100)
+            {
+                regs.fill(0);
+                update_pin();
+                return;
+            }
+            regs[0x00] = value & 0b111;
+            const bool enabled = value & 0b011;
+            if (enabled && !converting)
+            {
+                converting = add_repeating_timer_us(-kConversionUs, on_conversion, this, &conversions);
+            }
+            else if (!enabled && converting)
+            {
+                cancel_repeating_timer(&conversions);
+                converting = false;
+            }
+            return;
+        }
+        if (reg == 0x01)
+        {
+            regs[0x01] &= ~value;
+            update_pin();
+            return;
+        }
+        regs[reg] = value;
+    }
+
+    uint8_t read_reg(const uint8_t reg)
+    {
+        if (reg >= regs.size())
+        {
+            return 0;
+        }
+        const uint8_t value = regs[reg];
+        if ((regs[0x02] & 1) == 0 && reg >= 0x0C && reg <= 0x0F)
+        {
+            const uint8_t cleared = reg <= 0x0D ? 0b01 : 0b10; // ALS data clears the ALS interrupt, PS data the PS one.
+            if (regs[0x01] & cleared)
+            {
+                regs[0x01] &= ~cleared;
+                update_pin();
+            }
+        }
+        return value;
+    }
+
+    /**
+     * @brief A start or repeated start addressed to the sensor.
+     */
+    void address(const bool read)
+    {
+        transfers++;
+        first_write = !read;
+    }
+
+    void write_byte(const uint8_t value)
+    {
+        if (first_write)
+        {
+            pointer = value;
+            first_write = false;
+            return;
+        }
+        write_reg(pointer++, value);
+    }
+
+    uint8_t read_byte()
+    {
+        return read_reg(pointer++);
+    }
+
+    void stop()
+    {
+        transactions++;
+    }
+};
+
+inline HostAp3216 host_ap3216;
+
+/**
+ * @brief Bus time for a number of bits at the controller's baudrate.
+ */
+inline uint64_t host_i2c_bits_us(const uint64_t bits, const uint baudrate)
+{
+    return bits * 1'000'000ULL / baudrate;
+}
+
+/**
+ * @brief The controller's registers, as far as a driver queueing its own
+ * transactions uses them.
+ *
+ * Each command written to data_cmd goes to the target at tar: a byte to
+ * write, or a read whose byte lands in the receive FIFO. A command with the
+ * restart bit, or one that changes direction, starts a new transfer; one
+ * with the stop bit ends the transaction. The sensor sees each command as it
+ * is written, but the received bytes only become readable once the whole
+ * transaction would have crossed the bus, and until then its commands hold
+ * their place in the transmit FIFO. The caller is never held.
+ */
+typedef struct i2c_hw
+{
+    static constexpr size_t kFifoDepth = 16;
+
+    /**
+     * @brief Writing queues a command, reading pops the receive FIFO.
+     */
+    struct DataCmd
+    {
+        i2c_hw *hw;
+
+        DataCmd &operator=(const uint32_t cmd)
+        {
+            hw->command(cmd);
+            return *this;
+        }
+
+        operator uint32_t() const { return hw->pop(); }
+    };
+
+    uint32_t enable = 1;
+    uint32_t tar = 0;
+    DataCmd data_cmd{this};
+    uint32_t raw_intr_stat = 0; // Nothing aborts: the sensor always acknowledges.
+    uint32_t clr_tx_abrt = 0;
+
+    uint baudrate = 400000;     // As main.cpp sets it, I2C_DEFAULT_BAUDRATE.
+    bool active = false;        // A transaction is open.
+    bool reading = false;       // Direction of the current transfer.
+    uint64_t bits = 0;          // Bits in the open transaction.
+    size_t queued = 0;          // Commands in the open transaction.
+    size_t in_flight = 0;       // Commands of the last transaction, on the bus until busy_until_us.
+    uint64_t busy_until_us = 0;
+    std::vector<uint8_t> pending; // Bytes read in the open transaction.
+
+    struct Received
+    {
+        uint8_t value;
+        uint64_t ready_us;
+    };
+    std::deque<Received> rx;
+
+    [[nodiscard]] bool to_sensor() const { return tar == HostAp3216::kAddress; }
+
+    void command(const uint32_t cmd)
+    {
+        const bool read = cmd & I2C_IC_DATA_CMD_CMD_BITS;
+        if (!active || read != reading || (cmd & I2C_IC_DATA_CMD_RESTART_BITS))
+        {
+            bits += 10; // Start and address.
+            if (to_sensor())
+            {
+                host_ap3216.address(read);
+            }
+            active = true;
+            reading = read;
+        }
+        bits += 9;
+        queued++;
+        if (read)
+        {
+            pending.push_back(to_sensor() ? host_ap3216.read_byte() : 0);
+        }
+        else if (to_sensor())
+        {
+            host_ap3216.write_byte(cmd & 0xFF);
+        }
+
+        if (cmd & I2C_IC_DATA_CMD_STOP_BITS)
+        {
+            if (to_sensor())
+            {
+                host_ap3216.stop();
+            }
+            busy_until_us = std::max(time_us_64(), busy_until_us) + host_i2c_bits_us(bits + 1, baudrate);
+            for (const uint8_t value : pending)
+            {
+                rx.push_back({value, busy_until_us});
+            }
+            pending.clear();
+            in_flight = queued;
+            queued = 0;
+            bits = 0;
+            active = false;
+        }
+    }
+
+    uint32_t pop()
+    {
+        if (rx.empty())
+        {
+            return 0;
+        }
+        const uint8_t value = rx.front().value;
+        rx.pop_front();
+        return value;
+    }
+
+    /**
+     * @brief Disabling the controller, as changing its baudrate does, empties
+     * both FIFOs: queued commands are never sent and received bytes are lost.
+     */
+    void flush()
+    {
+        rx.clear();
+        pending.clear();
+        active = false;
+        bits = 0;
+        queued = 0;
+        in_flight = 0;
+        busy_until_us = 0;
+    }
+
+    [[nodiscard]] size_t readable() const
+    {
+        const uint64_t now = time_us_64();
+        return std::count_if(rx.begin(), rx.end(), [now](const Received &received)
+                             { return received.ready_us <= now; });
+    }
+
+    [[nodiscard]] size_t writable() const
+    {
+        const size_t used = active ? queued : (time_us_64() < busy_until_us ? in_flight : 0);
+        return kFifoDepth - std::min(used, kFifoDepth);
+    }
+} i2c_hw_t;
+
+typedef struct i2c_inst
+{
+    i2c_hw_t *hw;
+} i2c_inst_t;
+
+inline i2c_hw_t host_i2c0_hw;
+inline i2c_inst_t host_i2c0{&host_i2c0_hw};
+#define i2c0 (&host_i2c0)
+
+inline uint i2c_init(i2c_inst_t *i2c, uint baudrate)
+{
+    i2c->hw->baudrate = baudrate;
+    return baudrate;
+}
+
+inline uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate)
+{
+    i2c->hw->flush();
+    i2c->hw->baudrate = baudrate;
+    return baudrate;
+}
+
+inline i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c)
+{
+    return i2c->hw;
+}
+
+inline size_t i2c_get_read_available(i2c_inst_t *i2c)
+{
+    return i2c->hw->readable();
+}
+
+inline size_t i2c_get_write_available(i2c_inst_t *i2c)
+{
+    return i2c->hw->writable();
+}
+
+// Blocking transfers made from a timer or GPIO callback, which on the RP2350
+// would hold off the Hub75 DMA interrupt at the same priority.
+inline uint32_t host_i2c_blocking_in_irq = 0;
+
+/**
+ * @brief Hold the caller for a transfer: the address and data bytes at nine
+ * bits each, plus the start and stop conditions.
+ */
+inline void host_i2c_transfer(const i2c_inst_t *i2c, const size_t len)
+{
+    host_i2c_blocking_in_irq += host_in_timer || host_in_gpio_irq;
+    host_busy_us(host_i2c_bits_us((len + 1) * 9 + 2, i2c->hw->baudrate));
+}
+
+inline int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    host_i2c_transfer(i2c, len);
+    if (addr == HostAp3216::kAddress)
+    {
+        host_ap3216.address(false);
+        for (size_t i = 0; i < len; i++)
+        {
+            host_ap3216.write_byte(src[i]);
+        }
+        if (!nostop)
+        {
+            host_ap3216.stop();
+        }
+    }
+    return static_cast<int>(len);
+}
+
+inline int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop)
+{
+    host_i2c_transfer(i2c, len);
+    if (addr == HostAp3216::kAddress)
+    {
+        host_ap3216.address(true);
+        for (size_t i = 0; i < len; i++)
+        {
+            dst[i] = host_ap3216.read_byte();
+        }
+        if (!nostop)
+        {
+            host_ap3216.stop();
+        }
+        return static_cast<int>(len);
+    }
+    for (size_t i = 0; i < len; ++i)
+        dst[i] = 0;
+    return static_cast<int>(len);
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+// Host stand-in for hardware/sync.h. There are no interrupts to mask.
+
+#include <cstdint>
+
+inline uint32_t save_and_disable_interrupts()
+{
+    return 0;
+}
+
+inline void restore_interrupts(uint32_t)
+{
+}
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef HOST_HARDWARE_TIMER_H
+#define HOST_HARDWARE_TIMER_H
+
+// Host stand-in for hardware/timer.h.
+
+#include "pico/time.h"
+
+inline void busy_wait_us_32(const uint32_t us)
+{
+    host_busy_us(us);
+}
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef HOST_INTERSTATE75_HPP
+#define HOST_INTERSTATE75_HPP
+
+// Host stand-in for the Hub75 panel driver. update() copies the whole frame,
+// as the real driver does, so timings stay representative, and hands each
+// frame to an optional callback so it can be written out.
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "libraries/pico_graphics/pico_graphics.hpp"
+
+namespace pimoroni
+{
+    enum PanelType
+    {
+        PANEL_GENERIC = 0,
+        PANEL_FM6126A
+    };
+
+    static const unsigned int I2C_DEFAULT_BAUDRATE = 400000;
+    static const unsigned int I2C_DEFAULT_SDA = 20;
+    static const unsigned int I2C_DEFAULT_SCL = 21;
+    static const unsigned int I2C_DEFAULT_INT = 22;
+
+    class Hub75
+    {
+    public:
+        uint8_t brightness = 4;
+        uint width;                        // Panel width, as passed to the real driver.
+        uint height;                       // Panel height, as passed to the real driver.
+        uint frame_width = 0;              // Width of the last frame sent.
+        uint frame_height = 0;             // Height of the last frame sent.
+        std::vector<uint32_t> back_buffer; // Last frame sent, as 0x00RRGGBB.
+        uint32_t frames = 0;               // Frames sent so far.
+
+        // Called from update() with every frame, on whichever core sent it.
+        std::function<void(const Hub75 &)> on_update;
+
+        Hub75(uint width, uint height, void *, PanelType, bool)
+            : width(width), height(height), back_buffer(width * height)
+        {
+        }
+
+        void start(void (*)()) {}
+        void dma_complete() {}
+
+        void update(PicoGraphics *graphics)
+        {
+            const auto *src = static_cast<const uint32_t *>(graphics->frame_buffer);
+            frame_width = graphics->bounds.w;
+            frame_height = graphics->bounds.h;
+            const size_t count = std::min<size_t>(static_cast<size_t>(frame_width) * frame_height, back_buffer.size());
+            for (size_t i = 0; i < count; ++i)
+            {
+                back_buffer[i] = src[i] & 0x00FFFFFF;
+            }
+            frames++;
+
+            if (on_update)
+            {
+                on_update(*this);
+            }
+        }
+    };
+}
+
+#endif
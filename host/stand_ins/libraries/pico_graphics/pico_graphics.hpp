@@ -0,0 +1,218 @@
+#ifndef HOST_PICO_GRAPHICS_HPP
+#define HOST_PICO_GRAPHICS_HPP
+
+// Minimal stand-in for pimoroni's PicoGraphics, covering the subset the
+// weather display uses. Rasterisation rules mirror the upstream library.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#include "pico/stdlib.h"
+
+namespace pimoroni
+{
+    typedef int Pen;
+
+    struct Point
+    {
+        int32_t x = 0, y = 0;
+
+        Point() = default;
+        Point(int32_t x, int32_t y) : x(x), y(y) {}
+    };
+
+    struct Rect
+    {
+        int32_t x = 0, y = 0, w = 0, h = 0;
+
+        Rect() = default;
+        Rect(int32_t x, int32_t y, int32_t w, int32_t h) : x(x), y(y), w(w), h(h) {}
+        Rect(const Point &tl, const Point &br) : x(tl.x), y(tl.y), w(br.x - tl.x), h(br.y - tl.y) {}
+
+        bool empty() const { return w <= 0 || h <= 0; }
+
+        bool contains(const Point &p) const
+        {
+            return p.x >= x && p.y >= y && p.x < x + w && p.y < y + h;
+        }
+
+        Rect intersection(const Rect &r) const
+        {
+            const int32_t x1 = std::max(x, r.x);
+            const int32_t y1 = std::max(y, r.y);
+            const int32_t x2 = std::min(x + w, r.x + r.w);
+            const int32_t y2 = std::min(y + h, r.y + r.h);
+            return Rect(x1, y1, x2 - x1, y2 - y1);
+        }
+    };
+
+    class PicoGraphics
+    {
+    public:
+        Rect bounds;
+        Rect clip;
+        void *frame_buffer;
+        uint layers;
+        uint layer = 0;
+        uint layer_offset = 0;
+
+        PicoGraphics(uint16_t width, uint16_t height, uint16_t layers, void *frame_buffer)
+            : bounds(0, 0, width, height), clip(0, 0, width, height), frame_buffer(frame_buffer), layers(layers)
+        {
+        }
+
+        virtual ~PicoGraphics() = default;
+
+        virtual void set_pen(uint c) = 0;
+        virtual void set_pen(uint8_t r, uint8_t g, uint8_t b) = 0;
+        virtual int create_pen(uint8_t r, uint8_t g, uint8_t b) = 0;
+        virtual void set_pixel(const Point &p) = 0;
+        virtual void set_pixel_span(const Point &p, uint l) = 0;
+
+        void set_clip(const Rect &r) { clip = bounds.intersection(r); }
+        void remove_clip() { clip = bounds; }
+
+        void clear() { rectangle(clip); }
+
+        void pixel(const Point &p)
+        {
+            if (!clip.contains(p))
+                return;
+            set_pixel(p);
+        }
+
+        void pixel_span(const Point &p, int32_t l)
+        {
+            if (p.x + l < clip.x || p.x >= clip.x + clip.w || p.y < clip.y || p.y >= clip.y + clip.h)
+                return;
+            Point clipped = p;
+            if (clipped.x < clip.x)
+            {
+                l += clipped.x - clip.x;
+                clipped.x = clip.x;
+            }
+            if (clipped.x + l >= clip.x + clip.w)
+            {
+                l = clip.x + clip.w - clipped.x;
+            }
+            set_pixel_span(clipped, l);
+        }
+
+        void rectangle(const Rect &r)
+        {
+            Rect clipped = r.intersection(clip);
+            if (clipped.empty())
+                return;
+            Point dest(clipped.x, clipped.y);
+            while (clipped.h--)
+            {
+                set_pixel_span(dest, clipped.w);
+                dest.y++;
+            }
+        }
+
+        void line(Point p1, Point p2)
+        {
+            if (p1.y == p2.y)
+            {
+                const int32_t start = std::min(p1.x, p2.x);
+                const int32_t end = std::max(p1.x, p2.x);
+                pixel_span(Point(start, p1.y), end - start);
+                return;
+            }
+
+            if (p1.x == p2.x)
+            {
+                const int32_t start = std::min(p1.y, p2.y);
+                int32_t length = std::max(p1.y, p2.y) - start;
+                Point dest(p1.x, start);
+                while (length--)
+                {
+                    pixel(dest);
+                    dest.y++;
+                }
+                return;
+            }
+
+            const int32_t dx = p2.x - p1.x;
+            const int32_t dy = p2.y - p1.y;
+            if (std::abs(dx) > std::abs(dy))
+            {
+                int32_t s = std::abs(dx);
+                const int32_t sx = dx < 0 ? -1 : 1;
+                const int32_t sy = (dy * 65536) / s;
+                int32_t x = p1.x;
+                int32_t y = p1.y * 65536;
+                while (s--)
+                {
+                    pixel(Point(x, y >> 16));
+                    y += sy;
+                    x += sx;
+                }
+            }
+            else
+            {
+                int32_t s = std::abs(dy);
+                const int32_t sy = dy < 0 ? -1 : 1;
+                const int32_t sx = (dx * 65536) / s;
+                int32_t y = p1.y;
+                int32_t x = p1.x * 65536;
+                while (s--)
+                {
+                    pixel(Point(x >> 16, y));
+                    y += sy;
+                    x += sx;
+                }
+            }
+        }
+    };
+
+    class PicoGraphics_PenRGB888 : public PicoGraphics
+    {
+    public:
+        uint32_t color = 0;
+
+        PicoGraphics_PenRGB888(uint16_t width, uint16_t height, void *frame_buffer, uint16_t layers = 1)
+            : PicoGraphics(width, height, layers, frame_buffer)
+        {
+            if (this->frame_buffer == nullptr)
+            {
+                this->frame_buffer = new uint32_t[width * height * layers]();
+            }
+        }
+
+        static size_t buffer_size(uint w, uint h)
+        {
+            return w * h * sizeof(uint32_t);
+        }
+
+        void set_pen(uint c) override { color = c; }
+
+        void set_pen(uint8_t r, uint8_t g, uint8_t b) override
+        {
+            color = (r << 16) | (g << 8) | b;
+        }
+
+        int create_pen(uint8_t r, uint8_t g, uint8_t b) override
+        {
+            return (r << 16) | (g << 8) | b;
+        }
+
+        void set_pixel(const Point &p) override
+        {
+            auto *buf = static_cast<uint32_t *>(frame_buffer) + layer_offset;
+            buf[p.y * bounds.w + p.x] = color;
+        }
+
+        void set_pixel_span(const Point &p, uint l) override
+        {
+            auto *buf = static_cast<uint32_t *>(frame_buffer) + layer_offset;
+            buf = &buf[p.y * bounds.w + p.x];
+            while (l--)
+                *buf++ = color;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,290 @@
+#ifndef HOST_LWIP_ALTCP_H
+#define HOST_LWIP_ALTCP_H
+
+// Host stand-in for lwIP's altcp API, the part the HTTP client uses, over
+// non-blocking POSIX sockets. As with the Pico's poll-mode cyw43 arch, nothing
+// happens between calls: cyw43_arch_poll() finishes connects, flushes writes
+// and hands received data to the callbacks, on the thread that calls it.
+// There is no TLS; altcp_tls_new() gives a plain connection, so tests talk
+// HTTP to a loopback server.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+typedef int8_t err_t;
+typedef uint8_t u8_t;
+typedef uint16_t u16_t;
+
+#define ERR_OK 0
+#define ERR_MEM -1
+#define ERR_TIMEOUT -3
+#define ERR_INPROGRESS -5
+#define ERR_VAL -6
+#define ERR_CONN -11
+#define ERR_ABRT -13
+#define ERR_RST -14
+#define ERR_CLSD -15
+#define ERR_ARG -16
+
+#define IPADDR_TYPE_V4 0U
+#define IPADDR_TYPE_ANY 46U
+#define TCP_WRITE_FLAG_COPY 0x01
+#define TCP_MSS 1460
+
+typedef struct ip_addr
+{
+    uint32_t addr; // IPv4, network byte order.
+} ip_addr_t;
+
+struct pbuf
+{
+    pbuf *next;
+    void *payload;
+    u16_t tot_len;
+    u16_t len;
+};
+
+// Received data lives on cyw43_arch_poll()'s stack, so there is nothing to free.
+inline u8_t pbuf_free(pbuf *)
+{
+    return 1;
+}
+
+struct altcp_pcb;
+typedef err_t (*altcp_connected_fn)(void *arg, altcp_pcb *pcb, err_t err);
+typedef err_t (*altcp_recv_fn)(void *arg, altcp_pcb *pcb, pbuf *p, err_t err);
+typedef err_t (*altcp_sent_fn)(void *arg, altcp_pcb *pcb, u16_t len);
+typedef void (*altcp_err_fn)(void *arg, err_t err);
+
+struct altcp_pcb
+{
+    int fd = -1;
+    void *arg = nullptr;
+    altcp_connected_fn connected = nullptr;
+    altcp_recv_fn recv = nullptr;
+    altcp_sent_fn sent = nullptr;
+    altcp_err_fn err = nullptr;
+    bool connecting = false;
+    bool closed = false;     // Freed by the next cyw43_arch_poll().
+    bool aborted = false;    // Closed by altcp_abort().
+    std::string unsent;      // Written but not yet accepted by the socket.
+};
+
+struct altcp_tls_config
+{
+};
+
+// Every pcb not yet freed, for cyw43_arch_poll() to service.
+inline std::vector<altcp_pcb *> host_pcbs;
+
+// Connected and recv callbacks that broke lwIP's rule: return ERR_ABRT if,
+// and only if, the pcb was aborted inside the callback. Either way round
+// lwIP goes on to use a freed pcb or leaks one.
+inline uint32_t host_lwip_bad_returns = 0;
+
+// Make altcp_close() fail as lwIP's does when it's out of memory, leaving the
+// caller to altcp_abort().
+inline bool host_close_fails = false;
+
+inline void host_check_callback_result(const altcp_pcb *pcb, const err_t result)
+{
+    host_lwip_bad_returns += (result == ERR_ABRT) != pcb->aborted;
+}
+
+inline altcp_pcb *altcp_tcp_new_ip_type(u8_t)
+{
+    auto *pcb = new altcp_pcb;
+    host_pcbs.push_back(pcb);
+    return pcb;
+}
+
+inline altcp_pcb *altcp_new(void *)
+{
+    return altcp_tcp_new_ip_type(IPADDR_TYPE_ANY);
+}
+
+inline void altcp_arg(altcp_pcb *pcb, void *arg) { pcb->arg = arg; }
+inline void altcp_recv(altcp_pcb *pcb, altcp_recv_fn recv) { pcb->recv = recv; }
+inline void altcp_sent(altcp_pcb *pcb, altcp_sent_fn sent) { pcb->sent = sent; }
+inline void altcp_err(altcp_pcb *pcb, altcp_err_fn err) { pcb->err = err; }
+
+inline err_t altcp_connect(altcp_pcb *pcb, const ip_addr_t *ip, u16_t port, altcp_connected_fn connected)
+{
+    pcb->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (pcb->fd < 0)
+    {
+        return ERR_MEM;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = ip->addr;
+    if (connect(pcb->fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 && errno != EINPROGRESS)
+    {
+        return ERR_CONN;
+    }
+    pcb->connected = connected;
+    pcb->connecting = true;
+    return ERR_OK;
+}
+
+inline u16_t altcp_sndbuf(altcp_pcb *)
+{
+    return 8 * TCP_MSS;
+}
+
+inline err_t altcp_write(altcp_pcb *pcb, const void *data, u16_t len, u8_t)
+{
+    pcb->unsent.append(static_cast<const char *>(data), len);
+    return ERR_OK;
+}
+
+inline err_t altcp_output(altcp_pcb *pcb)
+{
+    if (pcb->connecting || pcb->unsent.empty())
+    {
+        return ERR_OK;
+    }
+    const ssize_t sent = send(pcb->fd, pcb->unsent.data(), pcb->unsent.size(), MSG_NOSIGNAL);
+    if (sent > 0)
+    {
+        pcb->unsent.erase(0, sent);
+        if (pcb->sent)
+        {
+            pcb->sent(pcb->arg, pcb, static_cast<u16_t>(sent));
+        }
+    }
+    return ERR_OK;
+}
+
+inline void altcp_recved(altcp_pcb *, u16_t)
+{
+}
+
+inline void host_pcb_release(altcp_pcb *pcb)
+{
+    if (pcb->fd >= 0)
+    {
+        close(pcb->fd);
+        pcb->fd = -1;
+    }
+    pcb->closed = true;
+}
+
+inline err_t altcp_close(altcp_pcb *pcb)
+{
+    if (host_close_fails)
+    {
+        return ERR_MEM;
+    }
+    host_pcb_release(pcb);
+    return ERR_OK;
+}
+
+inline void altcp_abort(altcp_pcb *pcb)
+{
+    host_pcb_release(pcb);
+    pcb->aborted = true;
+}
+
+/**
+ * @brief Fail a connection the way lwIP does: the pcb is freed, then the error callback runs.
+ */
+inline void host_pcb_error(altcp_pcb *pcb, const err_t error)
+{
+    host_pcb_release(pcb);
+    if (pcb->err)
+    {
+        pcb->err(pcb->arg, error);
+    }
+}
+
+/**
+ * @brief One pass over every connection, as lwIP does on each poll.
+ */
+inline void host_lwip_poll()
+{
+    for (size_t i = 0; i < host_pcbs.size(); i++)
+    {
+        altcp_pcb *pcb = host_pcbs[i];
+        if (pcb->closed || pcb->fd < 0)
+        {
+            continue;
+        }
+
+        if (pcb->connecting)
+        {
+            pollfd ready{pcb->fd, POLLOUT, 0};
+            if (poll(&ready, 1, 0) <= 0)
+            {
+                continue;
+            }
+            int error = 0;
+            socklen_t size = sizeof(error);
+            getsockopt(pcb->fd, SOL_SOCKET, SO_ERROR, &error, &size);
+            if (error != 0)
+            {
+                host_pcb_error(pcb, ERR_CONN);
+                continue;
+            }
+            pcb->connecting = false;
+            if (pcb->connected)
+            {
+                const err_t result = pcb->connected(pcb->arg, pcb, ERR_OK);
+                host_check_callback_result(pcb, result);
+                if (result != ERR_OK)
+                {
+                    continue;
+                }
+            }
+        }
+
+        altcp_output(pcb);
+
+        // Whatever has arrived, a segment at a time.
+        char segment[TCP_MSS];
+        while (!pcb->closed)
+        {
+            const ssize_t size = ::recv(pcb->fd, segment, sizeof(segment), 0);
+            if (size < 0)
+            {
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    host_pcb_error(pcb, ERR_RST);
+                }
+                break;
+            }
+            if (size == 0)
+            {
+                host_check_callback_result(pcb, pcb->recv(pcb->arg, pcb, nullptr, ERR_OK));
+                break;
+            }
+            pbuf p{nullptr, segment, static_cast<u16_t>(size), static_cast<u16_t>(size)};
+            host_check_callback_result(pcb, pcb->recv(pcb->arg, pcb, &p, ERR_OK));
+        }
+    }
+
+    const auto closed = std::remove_if(host_pcbs.begin(), host_pcbs.end(), [](altcp_pcb *pcb)
+                                       {
+        if (pcb->closed)
+        {
+            delete pcb;
+            return true;
+        }
+        return false; });
+    host_pcbs.erase(closed, host_pcbs.end());
+}
+
+#endif
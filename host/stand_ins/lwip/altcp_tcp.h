@@ -0,0 +1,8 @@
+#ifndef HOST_LWIP_ALTCP_TCP_H
+#define HOST_LWIP_ALTCP_TCP_H
+
+// Host stand-in for lwip/altcp_tcp.h, see lwip/altcp.h.
+
+#include "lwip/altcp.h"
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef HOST_LWIP_ALTCP_TLS_H
+#define HOST_LWIP_ALTCP_TLS_H
+
+// Host stand-in for lwip/altcp_tls.h. There is no TLS on the host: a TLS
+// connection is a plain one, see lwip/altcp.h.
+
+#include "lwip/altcp.h"
+
+inline altcp_tls_config *altcp_tls_create_config_client(const u8_t *, size_t)
+{
+    static altcp_tls_config config;
+    return &config;
+}
+
+inline void altcp_tls_free_config(altcp_tls_config *)
+{
+}
+
+inline altcp_pcb *altcp_tls_new(altcp_tls_config *, u8_t ip_type)
+{
+    return altcp_tcp_new_ip_type(ip_type);
+}
+
+inline void *altcp_tls_context(altcp_pcb *)
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef HOST_LWIP_APPS_SNTP_H
+#define HOST_LWIP_APPS_SNTP_H
+
+// Host stand-in for lwIP's SNTP client. The first poll after sntp_init()
+// sets the time from the host clock, through the same hook lwipopts.h gives
+// the real client.
+
+#include "lwip/altcp.h"
+
+#include <ctime>
+
+#define SNTP_OPMODE_POLL 0
+
+extern "C" void sntp_set_unix_time(uint32_t sec);
+
+inline bool host_sntp_running = false;
+
+inline void sntp_setoperatingmode(u8_t)
+{
+}
+
+inline void sntp_setservername(u8_t, const char *)
+{
+}
+
+inline void sntp_init()
+{
+    host_sntp_running = true;
+}
+
+inline void sntp_stop()
+{
+    host_sntp_running = false;
+}
+
+inline void host_sntp_poll()
+{
+    if (host_sntp_running)
+    {
+        sntp_set_unix_time(static_cast<uint32_t>(std::time(nullptr)));
+        host_sntp_running = false;
+    }
+}
+
+#endif
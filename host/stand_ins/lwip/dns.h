@@ -0,0 +1,25 @@
+#ifndef HOST_LWIP_DNS_H
+#define HOST_LWIP_DNS_H
+
+// Host stand-in for lwip/dns.h. Names resolve at once through the host's
+// resolver, so the callback is never needed.
+
+#include "lwip/altcp.h"
+
+typedef void (*dns_found_callback)(const char *name, const ip_addr_t *ipaddr, void *arg);
+
+inline err_t dns_gethostbyname(const char *hostname, ip_addr_t *addr, dns_found_callback, void *)
+{
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    addrinfo *found = nullptr;
+    if (getaddrinfo(hostname, nullptr, &hints, &found) != 0 || found == nullptr)
+    {
+        return ERR_ARG;
+    }
+    addr->addr = reinterpret_cast<sockaddr_in *>(found->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(found);
+    return ERR_OK;
+}
+
+#endif
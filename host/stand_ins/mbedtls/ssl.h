@@ -0,0 +1,15 @@
+#ifndef HOST_MBEDTLS_SSL_H
+#define HOST_MBEDTLS_SSL_H
+
+// Host stand-in for mbedtls/ssl.h. There is no TLS on the host.
+
+typedef struct mbedtls_ssl_context
+{
+} mbedtls_ssl_context;
+
+inline int mbedtls_ssl_set_hostname(mbedtls_ssl_context *, const char *)
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef HOST_PICO_CYW43_ARCH_H
+#define HOST_PICO_CYW43_ARCH_H
+
+// Host stand-in for pico/cyw43_arch.h in poll mode. There is no Wi-Fi: the
+// chip always comes up and joins the network, and the host's own network
+// stands in for lwIP, pumped by cyw43_arch_poll().
+
+#include "lwip/altcp.h"
+#include "lwip/apps/sntp.h"
+
+#include <cstdint>
+
+#define CYW43_AUTH_WPA2_AES_PSK 0x00400004
+#define CYW43_NO_POWERSAVE_MODE 0
+
+typedef struct cyw43_t
+{
+} cyw43_t;
+
+inline cyw43_t cyw43_state;
+
+inline int cyw43_arch_init()
+{
+    return 0;
+}
+
+inline void cyw43_arch_enable_sta_mode()
+{
+}
+
+inline int cyw43_wifi_pm(cyw43_t *, uint32_t)
+{
+    return 0;
+}
+
+inline int cyw43_arch_wifi_connect_timeout_ms(const char *, const char *, uint32_t, uint32_t)
+{
+    return 0;
+}
+
+inline void cyw43_arch_poll()
+{
+    host_lwip_poll();
+    host_sntp_poll();
+}
+
+inline void cyw43_arch_lwip_begin()
+{
+}
+
+inline void cyw43_arch_lwip_end()
+{
+}
+
+#endif
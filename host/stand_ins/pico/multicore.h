@@ -0,0 +1,74 @@
+#ifndef HOST_PICO_MULTICORE_H
+#define HOST_PICO_MULTICORE_H
+
+// Core 1 is modelled as a std::thread, with the inter-core FIFOs as
+// blocking queues so the pipelined render paths can run on a host.
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+class HostFifo
+{
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<uintptr_t> words_;
+
+public:
+    void push(uintptr_t word)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            words_.push_back(word);
+        }
+        ready_.notify_one();
+    }
+
+    uintptr_t pop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this] { return !words_.empty(); });
+        const uintptr_t word = words_.front();
+        words_.pop_front();
+        return word;
+    }
+
+    bool has_data()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return !words_.empty();
+    }
+};
+
+// Never destroyed: core 1 is still blocked on its FIFO when the process exits.
+inline HostFifo &host_fifo_to_core1 = *new HostFifo;
+inline HostFifo &host_fifo_to_core0 = *new HostFifo;
+inline thread_local bool host_is_core1 = false;
+
+inline void multicore_launch_core1(void (*entry)())
+{
+    std::thread([entry] {
+        host_is_core1 = true;
+        entry();
+    }).detach();
+}
+
+// Words are pointer sized on the host so jobs can pass pointers, as on the 32-bit target.
+inline void multicore_fifo_push_blocking(uintptr_t data)
+{
+    (host_is_core1 ? host_fifo_to_core0 : host_fifo_to_core1).push(data);
+}
+
+inline uintptr_t multicore_fifo_pop_blocking()
+{
+    return (host_is_core1 ? host_fifo_to_core1 : host_fifo_to_core0).pop();
+}
+
+inline bool multicore_fifo_rvalid()
+{
+    return (host_is_core1 ? host_fifo_to_core1 : host_fifo_to_core0).has_data();
+}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef HOST_PICO_RAND_H
+#define HOST_PICO_RAND_H
+
+// Host stand-in for pico/rand.h, backed by a fixed-seed generator so runs
+// are repeatable.
+
+#include <cstdint>
+#include <random>
+
+inline std::mt19937_64 &host_rand_engine()
+{
+    static std::mt19937_64 engine(0x5eed);
+    return engine;
+}
+
+inline uint32_t get_rand_32()
+{
+    return static_cast<uint32_t>(host_rand_engine()());
+}
+
+inline uint64_t get_rand_64()
+{
+    return host_rand_engine()();
+}
+
+#endif
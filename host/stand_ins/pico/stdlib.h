@@ -0,0 +1,63 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+// Host stand-in for pico/stdlib.h: stdio, clocks and GPIO calls the firmware
+// makes, reduced to what a headless run needs. There is no serial input.
+
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#include "pico/time.h"
+#include "hardware/timer.h"
+
+typedef unsigned int uint;
+
+#define PICO_ERROR_TIMEOUT (-1)
+#define __isr
+#define __not_in_flash_func(name) name
+
+inline int stdio_getchar_timeout_us(uint32_t)
+{
+    return PICO_ERROR_TIMEOUT;
+}
+
+inline void stdio_putchar(int c)
+{
+    putchar(c);
+}
+
+inline void stdio_set_chars_available_callback(void (*)(void *), void *)
+{
+}
+
+inline bool stdio_usb_init()
+{
+    return true;
+}
+
+inline bool stdio_usb_connected()
+{
+    return false;
+}
+
+#include "hardware/clocks.h"
+
+inline bool set_sys_clock_khz(uint32_t khz, bool)
+{
+    host_sys_clock_khz = khz;
+    return true;
+}
+
+#include "hardware/gpio.h"
+
+#include "pico/multicore.h"
+
+inline uint get_core_num()
+{
+    return host_is_core1 ? 1 : 0;
+}
+
+#endif
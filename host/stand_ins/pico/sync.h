@@ -0,0 +1,6 @@
+#ifndef HOST_PICO_SYNC_H
+#define HOST_PICO_SYNC_H
+
+// Host stand-in for pico/sync.h. Nothing from it is used on the host yet.
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef HOST_PICO_TIME_H
+#define HOST_PICO_TIME_H
+
+// Host stand-in for pico/time.h.
+//
+// By default the clock is simulated: it only moves when something sleeps, so
+// a frame paced by sleep_us() always takes exactly the frame period and runs
+// are reproducible however fast the host is. Call host_use_real_clock() to
+// follow the host's steady clock instead, for timing and profiling.
+//
+// Repeating timers run when the clock reaches them during a sleep, the way an
+// alarm interrupt lands while the Pico waits out a frame. They never cut into
+// other code, so a run sees them at the same points every time.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+inline bool host_real_clock = false;
+inline std::atomic<uint64_t> host_simulated_us{0};
+
+inline void host_use_real_clock()
+{
+    host_real_clock = true;
+}
+
+inline uint64_t time_us_64()
+{
+    if (!host_real_clock)
+    {
+        return host_simulated_us.load();
+    }
+
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline uint32_t time_us_32()
+{
+    return static_cast<uint32_t>(time_us_64());
+}
+
+/**
+ * @brief Keep the caller busy for a while, as a blocking bus transfer does.
+ */
+inline void host_busy_us(const uint64_t us)
+{
+    if (!host_real_clock)
+    {
+        host_simulated_us += us;
+        return;
+    }
+    const uint64_t until = time_us_64() + us;
+    while (time_us_64() < until)
+    {
+    }
+}
+
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *rt);
+
+struct repeating_timer
+{
+    int64_t delay_us;                   // Negative: between callback starts. Positive: from one callback's end to the next's start.
+    repeating_timer_callback_t callback;
+    void *user_data;
+    uint64_t host_due_us;               // When the callback next runs.
+};
+
+inline std::vector<repeating_timer_t *> host_timers;
+inline bool host_in_timer = false;
+
+inline bool add_repeating_timer_us(const int64_t delay_us, const repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out)
+{
+    *out = {delay_us, callback, user_data, time_us_64() + std::llabs(delay_us)};
+    host_timers.push_back(out);
+    return true;
+}
+
+inline bool add_repeating_timer_ms(const int32_t delay_ms, const repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out)
+{
+    return add_repeating_timer_us(static_cast<int64_t>(delay_ms) * 1000, callback, user_data, out);
+}
+
+inline bool cancel_repeating_timer(repeating_timer_t *timer)
+{
+    const auto found = std::find(host_timers.begin(), host_timers.end(), timer);
+    if (found == host_timers.end())
+    {
+        return false;
+    }
+    host_timers.erase(found);
+    return true;
+}
+
+/**
+ * @brief Run every timer callback due by a time, in the order they fall due.
+ */
+inline void host_run_timers(const uint64_t until)
+{
+    if (host_in_timer)
+    {
+        return;
+    }
+    host_in_timer = true;
+    while (true)
+    {
+        const auto next = std::min_element(host_timers.begin(), host_timers.end(), [](const repeating_timer_t *a, const repeating_timer_t *b)
+                                           { return a->host_due_us < b->host_due_us; });
+        if (next == host_timers.end() || (*next)->host_due_us > until)
+        {
+            break;
+        }
+
+        repeating_timer_t *timer = *next;
+        const uint64_t due = timer->host_due_us;
+        if (!host_real_clock)
+        {
+            host_simulated_us = std::max<uint64_t>(host_simulated_us, due);
+        }
+        while (time_us_64() < due)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(due - time_us_64()));
+        }
+
+        if (!timer->callback(timer))
+        {
+            cancel_repeating_timer(timer);
+            continue;
+        }
+        timer->host_due_us = timer->delay_us < 0 ? due - timer->delay_us : time_us_64() + timer->delay_us;
+    }
+    host_in_timer = false;
+}
+
+/**
+ * @brief Sleep, running any timers that fall due meanwhile. As on the Pico,
+ * the sleep still ends on time unless a callback overruns it.
+ */
+inline void sleep_us(uint64_t us)
+{
+    const uint64_t until = time_us_64() + us;
+    host_run_timers(until);
+    if (!host_real_clock)
+    {
+        host_simulated_us = std::max<uint64_t>(host_simulated_us, until);
+        return;
+    }
+    const uint64_t now = time_us_64();
+    if (now < until)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(until - now));
+    }
+}
+
+inline void sleep_ms(uint32_t ms)
+{
+    sleep_us(static_cast<uint64_t>(ms) * 1000);
+}
+
+#endif
@@ -42,6 +42,14 @@ typedef enum AP3216Mode : uint8_t
     AP3216_ALS_PS_ONCE = 0b00000111
 } ap3216_mode;
 
+typedef enum AP3216BurstStatus : uint8_t
+{
+    BURST_IDLE = 0, // No read queued
+    BURST_BUSY,     // Still on the bus
+    BURST_DONE,     // Data copied out
+    BURST_FAILED    // The sensor didn't acknowledge, nothing copied
+} ap3216_burst_status;
+
 typedef enum AP3216LuxRange : uint8_t
 {
     RANGE_20661 = 0b00000000,
@@ -50,6 +58,19 @@ typedef enum AP3216LuxRange : uint8_t
     RANGE_323 = 0b00110000
 } ap3216_lux_range;
 
+/**
+ * @brief The IR, ALS and PS data registers, decoded.
+ */
+struct AP3216Data
+{
+    uint16_t ir;
+    uint16_t als;
+    uint16_t proximity;
+    bool irOverflowed;
+    bool proximityValid;
+    bool objectNear;
+};
+
 /****************************************
  * Definitions
  ****************************************/
@@ -66,6 +87,7 @@ static constexpr uint8_t PS_MEAN_TIME_12_5{0x00};
 static constexpr uint8_t PS_MEAN_TIME_25{0x01};
 static constexpr uint8_t PS_MEAN_TIME_37_5{0x02};
 static constexpr uint8_t PS_MEAN_TIME_50{0x03};
+static constexpr uint8_t MAX_BURST_LEN{15}; // The register address and the reads share the 16 deep TX FIFO
 
 class AP3216_WE
 {
@@ -138,6 +160,40 @@ public:
     uint8_t getLEDWaitingTime();
     void setPSCalibration(uint16_t);
     void setPSThresholds(uint16_t, uint16_t);
+    AP3216Data getAllData();                   // IR, ALS and PS data in one transaction
+    static AP3216Data decodeData(const uint8_t *); // The six data registers, IR_DATA_LOW_REG first
+    float alsToLux(uint16_t);                  // Raw ALS count to lux in the current range
+
+    /**
+     * @brief Read consecutive registers in one transaction: the register
+     * address, then a repeated start into a read of len bytes. The sensor
+     * auto-increments the address after each byte.
+     */
+    void readRegs(uint8_t reg, uint8_t *dst, uint8_t len);
+
+    /**
+     * @brief Queue the same transaction in the I2C controller's FIFO and
+     * return at once. Collect the bytes with pollReadRegs() once the bus has
+     * had time to carry them. No other transfer may use the bus until then.
+     *
+     * @return false if a read is already queued, len is 0 or more than
+     * MAX_BURST_LEN, or the FIFO hasn't room.
+     */
+    bool startReadRegs(uint8_t reg, uint8_t len);
+
+    /**
+     * @brief Collect a read queued by startReadRegs(), without waiting.
+     *
+     * @param dst Where the bytes go once the read is done.
+     */
+    ap3216_burst_status pollReadRegs(uint8_t *dst);
+
+    /**
+     * @brief Wait for a read queued by startReadRegs() and collect it.
+     */
+    ap3216_burst_status waitReadRegs(uint8_t *dst);
+
+    bool readQueued() { return burstLen != 0; }
 
     /**
      * @brief Get the Lux Range object
@@ -161,6 +217,7 @@ public:
         case RANGE_323:
             return 323.0f;
         }
+        return 20661.0f;
     }
 
 protected:
@@ -177,6 +234,7 @@ protected:
     AP3216Mode deviceMode;
 
     AP3216LuxRange luxRange;
+    uint8_t burstLen = 0; // Bytes of the queued read, 0 if none
 };
 
 #endif
@@ -0,0 +1,545 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include "pico/stdlib.h"
+#include "pico/time.h"
+#include "pico/rand.h"
+#include "hardware/clocks.h"
+
+#include "helpers_rand.h"
+
+#include "particles/particle_integrator.h"
+#include "display/z_buffer.h"
+#include "display/depth_palette.h"
+#include "display/weather_display_handler.h"
+
+#include <cstring>
+#include <memory>
+#include <numbers>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace weather::bench
+{
+
+    /**
+     * @brief Convert a duration into CPU cycles at the current system clock.
+     *
+     * @param elapsed_us Duration in us.
+     * @return float
+     */
+    inline float us_to_cycles(const uint64_t elapsed_us)
+    {
+        return elapsed_us * (clock_get_hz(clk_sys) / 1'000'000.0f);
+    }
+
+    /**
+     * @brief Small LCG so every run of a benchmark sees the same inputs.
+     */
+    class BenchRandom
+    {
+        uint32_t state_;
+
+    public:
+        explicit BenchRandom(const uint32_t seed) : state_(seed) {}
+
+        float next(const float start, const float end)
+        {
+            state_ = state_ * 1664525u + 1013904223u;
+            return start + ((end - start) * ((state_ >> 8) * (1.0f / 16777216.0f)));
+        }
+    };
+
+    /**
+     * @brief Convert a float into the storage type of a pool.
+     */
+    template <typename T>
+    constexpr T from_float(const float value)
+    {
+        if constexpr (std::is_same_v<T, q16_t>)
+        {
+            return float_to_q16(value);
+        }
+        else
+        {
+            return value;
+        }
+    }
+
+    /**
+     * @brief Fill a pool with a reproducible spread of particle states.
+     * Every pool filled with the same seed is identical.
+     *
+     * @param pool Pool to fill, must already be allocated.
+     * @param seed Seed for the generator.
+     */
+    template <typename T>
+    void fill_pool(BasicParticlePool<T> &pool, const uint32_t seed)
+    {
+        BenchRandom random(seed);
+
+        pool.clear();
+        while (!pool.full())
+        {
+            const uint16_t i = pool.spawn();
+            pool.x[i] = from_float<T>(random.next(0.0f, 128.0f));
+            pool.y[i] = from_float<T>(random.next(-15.0f, 142.0f));
+            pool.z[i] = from_float<T>(random.next(0.1f, 1.0f));
+            pool.vx[i] = from_float<T>(random.next(-2.0f, 2.0f));
+            pool.vy[i] = from_float<T>(random.next(-10.0f, 0.0f));
+            pool.ax[i] = from_float<T>(random.next(-1.0f, 1.0f));
+            pool.ay[i] = from_float<T>(random.next(-1.0f, 1.0f));
+            pool.weight[i] = from_float<T>(random.next(0.25f, 1.0f));
+            pool.drag[i] = from_float<T>(random.next(0.4f, 1.1f));
+        }
+    }
+
+    /**
+     * @brief Check whether two pools hold bit-identical particle state.
+     */
+    template <typename T>
+    bool pools_identical(const BasicParticlePool<T> &a, const BasicParticlePool<T> &b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        const size_t bytes = a.size() * sizeof(T);
+        return memcmp(a.x, b.x, bytes) == 0 && memcmp(a.y, b.y, bytes) == 0 &&
+               memcmp(a.z, b.z, bytes) == 0 && memcmp(a.vx, b.vx, bytes) == 0 &&
+               memcmp(a.vy, b.vy, bytes) == 0;
+    }
+
+    /**
+     * @brief Time one integrator over a pool.
+     *
+     * @return float Cycles spent per particle per step.
+     */
+    template <typename Pool, typename Integrator>
+    float time_integrator(Integrator integrator, Pool &pool, const IntegratorParams &params, const uint16_t iterations)
+    {
+        const uint64_t start = time_us_64();
+        for (uint16_t i = 0; i < iterations; i++)
+        {
+            integrator(pool, params);
+        }
+        const uint64_t elapsed = time_us_64() - start;
+        return us_to_cycles(elapsed) / (static_cast<float>(pool.size()) * iterations);
+    }
+
+    /**
+     * @brief Benchmark the portable particle integrator against the CMSIS-DSP and
+     * fixed-point ones, reporting cycles per particle for each and whether the
+     * float paths agree bit for bit.
+     *
+     * @param count Number of particles.
+     * @param iterations Number of integration steps to time.
+     */
+    inline void particle_integrator(const uint16_t count = 1024, const uint16_t iterations = 200)
+    {
+        const IntegratorParams params{0.0f, -9.8f, 1.0f / 75.0f};
+
+        printf("\n=== Particle integrator: %d particles x %d steps ===\n", count, iterations);
+
+        BasicParticlePool<float> scalar_pool;
+        scalar_pool.allocate(count);
+        fill_pool(scalar_pool, 1234);
+        const float scalar_cycles = time_integrator(integrate_particles_scalar, scalar_pool, params, iterations);
+        printf("Scalar:      %.2f cycles/particle\n", scalar_cycles);
+
+#if defined(ARM_MATH_CM33)
+        BasicParticlePool<float> cmsis_pool;
+        cmsis_pool.allocate(count);
+        fill_pool(cmsis_pool, 1234);
+        const float cmsis_cycles = time_integrator(integrate_particles_cmsis, cmsis_pool, params, iterations);
+        printf("CMSIS-DSP:   %.2f cycles/particle (%.2fx)\n", cmsis_cycles, scalar_cycles / cmsis_cycles);
+        printf("Results bit-identical: %s\n", pools_identical(scalar_pool, cmsis_pool) ? "yes" : "NO");
+#else
+        printf("CMSIS-DSP path not built for this target.\n");
+#endif
+
+        BasicParticlePool<q16_t> fixed_pool;
+        fixed_pool.allocate(count);
+        fill_pool(fixed_pool, 1234);
+        const float fixed_cycles = time_integrator(integrate_particles_fixed, fixed_pool, params, iterations);
+        printf("Fixed Q16:   %.2f cycles/particle (%.2fx)\n", fixed_cycles, scalar_cycles / fixed_cycles);
+    }
+
+    /**
+     * @brief Run the float and fixed-point integrators side by side and report how
+     * far the fixed-point trajectories drift from the float reference.
+     *
+     * Particles that leave the segment are wrapped back by a whole number of pixels
+     * in both representations, decided by the float reference, so they stay in the
+     * same range as a real run without breaking the comparison.
+     *
+     * @param frames Number of frames to simulate.
+     * @param count Number of particles.
+     * @return true if no position drifted a pixel or more from the reference.
+     */
+    inline bool fixed_point_accuracy(const uint32_t frames = 10'000, const uint16_t count = 64)
+    {
+        static constexpr float kTop = -15.0f;    // Top of the out of bounds limits.
+        static constexpr float kBottom = 142.0f; // Bottom of the out of bounds limits.
+        static constexpr float kSpan = kBottom - kTop;
+        const IntegratorParams params{0.0f, -9.8f, 1.0f / 75.0f};
+
+        printf("\n=== Fixed-point accuracy: %d particles x %lu frames ===\n", count, frames);
+
+        BasicParticlePool<float> reference;
+        BasicParticlePool<q16_t> fixed;
+        reference.allocate(count);
+        fixed.allocate(count);
+
+        // Start both pools from the same, exactly representable, state.
+        BenchRandom random(99);
+        while (!reference.full())
+        {
+            const uint16_t i = reference.spawn();
+            fixed.spawn();
+            const float drag = 9.8f / (random.next(0.0f, 1.0f) < 0.5f ? 24.0f : 9.5f);
+            const float values[] = {random.next(0.0f, 128.0f), random.next(kTop, kBottom), random.next(0.2f, 1.0f),
+                                    random.next(-1.0f, 1.0f), random.next(-10.0f, 0.0f), random.next(0.25f, 1.0f), drag};
+            float *targets[] = {&reference.x[i], &reference.y[i], &reference.z[i], &reference.vx[i], &reference.vy[i],
+                                &reference.weight[i], &reference.drag[i]};
+            q16_t *fixed_targets[] = {&fixed.x[i], &fixed.y[i], &fixed.z[i], &fixed.vx[i], &fixed.vy[i],
+                                      &fixed.weight[i], &fixed.drag[i]};
+            for (uint8_t v = 0; v < 7; v++)
+            {
+                *fixed_targets[v] = float_to_q16(values[v]);
+                *targets[v] = q16_to_float(*fixed_targets[v]);
+            }
+        }
+
+        float max_error = 0.0f;
+        uint32_t pixel_mismatches = 0;
+        for (uint32_t frame = 0; frame < frames; frame++)
+        {
+            integrate_particles_scalar(reference, params);
+            integrate_particles_fixed(fixed, params);
+
+            for (uint16_t i = 0; i < count; i++)
+            {
+                max_error = std::max(max_error, std::abs(reference.x[i] - q16_to_float(fixed.x[i])));
+                max_error = std::max(max_error, std::abs(reference.y[i] - q16_to_float(fixed.y[i])));
+                if (std::abs(static_cast<int32_t>(floorf(reference.y[i])) - particle_to_pixel(fixed.y[i])) > 1)
+                {
+                    pixel_mismatches++;
+                }
+
+                if (reference.y[i] < kTop)
+                {
+                    reference.y[i] += kSpan;
+                    fixed.y[i] += float_to_q16(kSpan);
+                }
+                else if (reference.y[i] > kBottom)
+                {
+                    reference.y[i] -= kSpan;
+                    fixed.y[i] -= float_to_q16(kSpan);
+                }
+            }
+        }
+
+        printf("Max deviation from float reference: %.4f px\n", max_error);
+        printf("Samples more than one pixel apart: %lu\n", pixel_mismatches);
+        printf("Result: %s\n", max_error < 1.0f ? "PASS" : "FAIL");
+        return max_error < 1.0f;
+    }
+
+    /**
+     * @brief Time drawing short rain streaks through the generic PicoGraphics
+     * line() against PicoZGraphics::draw_streak().
+     *
+     * Streaks are 2-6 pixels long in a random direction, starting anywhere in a
+     * segment sized rectangle, so some cross its edge and need clipping. They
+     * come round from a ring of kRing made up front, so the benchmark's memory
+     * doesn't grow with count.
+     *
+     * @param count Number of streaks.
+     * @param iterations Number of times to draw every streak.
+     */
+    inline void streak_rasterizer(const uint16_t count = 10'000, const uint16_t iterations = 10)
+    {
+        struct Streak
+        {
+            pimoroni::Point start;
+            pimoroni::Point end;
+            uint32_t color;
+            uint8_t depth;
+        };
+        static constexpr uint16_t kRing = 256; // Power of two, to index with a mask.
+
+        const RectMod segment(43, 0, 42, 128);
+
+        printf("\n=== Streak rasterizer: %d streaks x %d passes ===\n", count, iterations);
+
+        BenchRandom random(4321);
+        auto streaks = std::make_unique<Streak[]>(kRing);
+        for (uint16_t i = 0; i < kRing; i++)
+        {
+            const pimoroni::Point start(random.next(segment.x, segment.x_end + 1), random.next(segment.y, segment.y_end + 1));
+            const float length = random.next(2.0f, 7.0f);
+            const float angle = random.next(0.0f, 2.0f * std::numbers::pi_v<float>);
+            streaks[i] = {start,
+                          pimoroni::Point(start.x + static_cast<int32_t>(length * cosf(angle)), start.y + static_cast<int32_t>(length * sinf(angle))),
+                          static_cast<uint32_t>(random.next(0.0f, 16777215.0f)), static_cast<uint8_t>(random.next(1.0f, 255.0f))};
+        }
+
+        // PicoGraphics never frees a buffer it allocates, so own it here.
+        const auto buffer = std::make_unique<uint32_t[]>(128 * 128);
+        pimoroni::PicoZGraphics graphics(128, 128, buffer.get());
+        graphics.clear_framebuffer();
+
+        uint64_t start = time_us_64();
+        for (uint16_t pass = 0; pass < iterations; pass++)
+        {
+            for (uint16_t i = 0; i < count; i++)
+            {
+                const Streak &streak = streaks[i & (kRing - 1)];
+                graphics.set_pen(streak.color);
+                graphics.set_depth(streak.depth);
+                graphics.line(streak.start, streak.end);
+            }
+        }
+        const float line_ns = (time_us_64() - start) * 1000.0f / (static_cast<float>(count) * iterations);
+        printf("PicoGraphics line(): %.1f ns/streak\n", line_ns);
+
+        graphics.clear_framebuffer();
+
+        start = time_us_64();
+        for (uint16_t pass = 0; pass < iterations; pass++)
+        {
+            for (uint16_t i = 0; i < count; i++)
+            {
+                const Streak &streak = streaks[i & (kRing - 1)];
+                graphics.set_pen(streak.color);
+                graphics.set_depth(streak.depth);
+                graphics.draw_streak(streak.start, streak.end, segment);
+            }
+        }
+        const float streak_ns = (time_us_64() - start) * 1000.0f / (static_cast<float>(count) * iterations);
+        printf("draw_streak():       %.1f ns/streak (%.2fx)\n", streak_ns, line_ns / streak_ns);
+    }
+
+    /**
+     * @brief Compare the cost of drawing snowflakes one pixel at a time, with the
+     * pen worked out from depth per flake, against building a batch from a depth
+     * palette and drawing it with PicoZGraphics::draw_points(). The physics step for
+     * the same flakes is timed alongside for scale.
+     *
+     * @param count Number of flakes.
+     * @param iterations Number of frames to time.
+     */
+    inline void point_sprites(const uint16_t count = 1024, const uint16_t iterations = 200)
+    {
+        const IntegratorParams params{0.0f, -9.8f, 1.0f / 75.0f};
+        const RectMod segment(0, 0, 128, 128);
+
+        printf("\n=== Snowflake drawing: %d flakes x %d frames ===\n", count, iterations);
+
+        ParticlePool pool;
+        pool.allocate(count);
+        fill_pool(pool, 2468);
+        // Keep the flakes on screen so every one is drawn.
+        for (uint16_t i = 0; i < count; i++)
+        {
+            pool.y[i] = pool.x[i];
+        }
+
+        const DepthPalette palette(kWhite, 255);
+
+        // PicoGraphics never frees a buffer it allocates, so own it here.
+        const auto buffer = std::make_unique<uint32_t[]>(128 * 128);
+        pimoroni::PicoZGraphics graphics(128, 128, buffer.get());
+        auto points = std::make_unique<pimoroni::DepthPoint[]>(count);
+
+        BasicParticlePool<particle_scalar_t> physics_pool;
+        physics_pool.allocate(count);
+        fill_pool(physics_pool, 2468);
+        const float physics_cycles = time_integrator([](ParticlePool &p, const IntegratorParams &ip)
+                                                     { integrate_particles(p, ip); },
+                                                     physics_pool, params, iterations);
+        printf("Physics:        %.2f cycles/flake\n", physics_cycles);
+
+        graphics.clear_framebuffer();
+        uint64_t start = time_us_64();
+        for (uint16_t frame = 0; frame < iterations; frame++)
+        {
+            for (uint16_t i = 0; i < count; i++)
+            {
+                const pimoroni::Point p(particle_to_pixel(pool.x[i]), particle_to_pixel(pool.y[i]));
+                if (segment.contains_inclusive(p))
+                {
+                    const float z = particle_to_float(pool.z[i]);
+                    graphics.set_pen((z * kWhite.r), (z * kWhite.g), (z * kWhite.b));
+                    graphics.set_depth(z);
+                    graphics.set_pixel(p);
+                }
+            }
+        }
+        const float pixel_cycles = us_to_cycles(time_us_64() - start) / (static_cast<float>(count) * iterations);
+        printf("Per pixel:      %.2f cycles/flake (%.0f%% of physics)\n", pixel_cycles, 100.0f * pixel_cycles / physics_cycles);
+
+        graphics.clear_framebuffer();
+        start = time_us_64();
+        for (uint16_t frame = 0; frame < iterations; frame++)
+        {
+            uint16_t n = 0;
+            for (uint16_t i = 0; i < count; i++)
+            {
+                const pimoroni::Point p(particle_to_pixel(pool.x[i]), particle_to_pixel(pool.y[i]));
+                if (segment.contains_inclusive(p))
+                {
+                    points[n++] = {static_cast<int16_t>(p.x), static_cast<int16_t>(p.y),
+                                   palette[particle_to_depth(pool.z[i])]};
+                }
+            }
+            graphics.draw_points(points.get(), n, segment);
+        }
+        const float batch_cycles = us_to_cycles(time_us_64() - start) / (static_cast<float>(count) * iterations);
+        printf("Batched:        %.2f cycles/flake (%.0f%% of physics, %.2fx)\n", batch_cycles,
+               100.0f * batch_cycles / physics_cycles, pixel_cycles / batch_cycles);
+    }
+
+    /**
+     * @brief Time a random number source.
+     *
+     * @return float Calls per us.
+     */
+    template <typename Source>
+    float time_random(Source source, const uint32_t calls)
+    {
+        uint32_t sink = 0;
+        const uint64_t start = time_us_64();
+        for (uint32_t i = 0; i < calls; i++)
+        {
+            sink ^= source();
+        }
+        const uint64_t elapsed = std::max<uint64_t>(time_us_64() - start, 1);
+        // Keep the loop from being optimised away.
+        volatile uint32_t keep = sink;
+        (void)keep;
+        return calls / static_cast<float>(elapsed);
+    }
+
+    /**
+     * @brief Compare the particle RNG against the hardware-backed get_rand_32().
+     *
+     * @param calls Number of calls to time for each source.
+     */
+    inline void random_numbers(const uint32_t calls = 100'000)
+    {
+        printf("\n=== Random numbers: %lu calls ===\n", calls);
+
+        const float hardware = time_random([]
+                                           { return get_rand_32(); }, calls);
+        printf("get_rand_32():      %.2f calls/us\n", hardware);
+
+        RNG generator(rng_seed);
+        const float engine = time_random([&generator]
+                                         { return generator.next(); }, calls);
+        printf("RNG::next():        %.2f calls/us (%.2fx)\n", engine, engine / hardware);
+
+        const float floats = time_random([]
+                                         { return static_cast<uint32_t>(get_rand_float(0.0f, 128.0f)); }, calls);
+        printf("get_rand_float():   %.2f calls/us\n", floats);
+    }
+
+    /**
+     * @brief FNV-1a hash of a framebuffer's pixels.
+     */
+    inline uint32_t hash_frame(const pimoroni::PicoZGraphics &graphics)
+    {
+        const auto *bytes = static_cast<const uint8_t *>(graphics.frame_buffer);
+        const size_t size = graphics.bounds.w * graphics.bounds.h * sizeof(uint32_t);
+
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Check that runs of a forecast from the same seed draw identical
+     * frames.
+     *
+     * Every run uses serial rendering and a fixed timestep, so the only thing
+     * that could make them differ is the random numbers. The third run
+     * follows some frames in split segment mode, whose particles core 1 drew
+     * into the same framebuffer, and catches any it leaves behind. The handler is put
+     * back in its previous render mode and timestep afterwards; it is left
+     * showing the test forecast.
+     *
+     * @param handler The display to run.
+     * @param forecast Forecast to show in each run.
+     * @param seed Seed each run starts from.
+     * @param frames Number of frames in each run.
+     * @return true if every run drew the same frames.
+     */
+    inline bool frame_determinism(WeatherDisplayHandler &handler, const std::span<const DayForecast> forecast,
+                                  const uint64_t seed, const uint16_t frames = 150)
+    {
+        printf("\n=== Frame determinism: %d frames, seed %llu, twice serial and once after split mode ===\n", frames, seed);
+
+        const RenderMode mode = handler.get_render_mode();
+        const bool fixed_timestep = handler.get_fixed_timestep();
+        const bool idle = handler.get_idle_mode().enabled();
+        const bool governed = handler.get_frame_governor().enabled();
+        handler.set_render_mode(RenderMode::kSerial);
+        handler.set_fixed_timestep(true);
+        handler.set_idle_enabled(false); // Idling in a dark room would freeze every run alike.
+        handler.set_governor_enabled(false); // Frame times differ between runs, the particle load mustn't.
+
+        std::vector<uint32_t> hashes(frames);
+        int32_t first_mismatch = -1;
+        uint8_t mismatch_run = 0;
+        for (uint8_t run = 0; run < 3; run++)
+        {
+            if (run == 2)
+            {
+                handler.set_render_mode(RenderMode::kSplitSegments);
+                for (uint16_t frame = 0; frame < 30; frame++)
+                {
+                    handler.refresh_and_update_display();
+                }
+                handler.set_render_mode(RenderMode::kSerial);
+            }
+            seed_rng(seed);
+            handler.update_weather(forecast, true);
+            for (uint16_t frame = 0; frame < frames; frame++)
+            {
+                handler.refresh_and_update_display();
+                const uint32_t hash = hash_frame(handler.get_graphics());
+                if (run == 0)
+                {
+                    hashes[frame] = hash;
+                }
+                else if (hash != hashes[frame] && first_mismatch < 0)
+                {
+                    first_mismatch = frame;
+                    mismatch_run = run;
+                }
+            }
+        }
+
+        handler.set_governor_enabled(governed);
+        handler.set_idle_enabled(idle);
+        handler.set_fixed_timestep(fixed_timestep);
+        handler.set_render_mode(mode);
+
+        if (first_mismatch < 0)
+        {
+            printf("Result: PASS, every frame identical\n");
+            return true;
+        }
+        printf("Result: FAIL, first difference at frame %ld of the %s run\n", first_mismatch,
+               mismatch_run == 1 ? "second serial" : "post-split");
+        return false;
+    }
+
+} // namespace weather::bench
+
+#endif // BENCHMARKS_H
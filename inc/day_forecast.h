@@ -0,0 +1,55 @@
+#ifndef DAY_FORECAST_H
+#define DAY_FORECAST_H
+
+#include "weather_codes.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @brief One day of forecast, as the display uses it.
+ *
+ * Plain data with no heap members, so a forecast can be copied, compared and
+ * stored as raw bytes. Fields hold the Tomorrow.io values converted to numbers
+ * once, when the forecast is built, instead of strings parsed on every use.
+ */
+struct DayForecast
+{
+    static constexpr uint8_t kMaxDayName = 10; // "Wednesday" and its terminator.
+
+    uint32_t weather_code = 10000;     // Tomorrow.io day code, see weather_descriptor().
+    float temperature = 0.0f;          // Temperature.
+    float wind_speed = 0.0f;           // Wind speed.
+    float wind_direction = 0.0f;       // Wind direction in degrees.
+    float precip_intensity = 0.0f;     // Precipitation intensity in mm/hr.
+    float snow_accumulation = 0.0f;    // Snow accumulation in mm.
+    float ice_accumulation = 0.0f;     // Ice accumulation in mm.
+    uint16_t sunrise_minutes = 0;      // Sunrise, minutes after midnight.
+    uint16_t sunset_minutes = 0;       // Sunset, minutes after midnight.
+    uint8_t precip_probability = 0;    // Precipitation probability in %.
+    uint8_t precip_type = 0;           // Tomorrow.io precipitation type, see precip_type_parser().
+    uint8_t cloud_cover = 0;           // Cloud cover in %.
+    std::array<char, kMaxDayName> day{}; // Day name, nul terminated.
+
+    [[nodiscard]] constexpr const WeatherDescriptor &weather() const { return weather_descriptor(weather_code); }
+
+    [[nodiscard]] std::string_view day_name() const { return day.data(); }
+
+    /**
+     * @brief Set the day name, cut short if it doesn't fit.
+     */
+    void set_day_name(const std::string_view name)
+    {
+        day.fill('\0');
+        std::copy_n(name.begin(), std::min<size_t>(name.size(), kMaxDayName - 1), day.begin());
+    }
+
+    bool operator==(const DayForecast &) const = default;
+};
+
+static_assert(std::is_trivially_copyable_v<DayForecast>, "DayForecast must stay plain data");
+
+#endif // DAY_FORECAST_H
@@ -12,6 +12,8 @@
 #include <sstream>
 
 #include "display/weather_display_handler.h"
+#include "benchmarks.h"
+#include "forecast_map.h"
 #include "misc.h"
 
 void usb_char_available(void *ptr)
@@ -39,10 +41,10 @@ namespace weather
          * - freezing_rain, ice_pellets
          * - thunderstorm
          */
-        static std::vector<std::map<std::string, std::string>> generate(
+        static std::vector<DayForecast> generate(
             const std::string &weather_type, int num_days = 3)
         {
-            std::vector<std::map<std::string, std::string>> intervals;
+            std::vector<DayForecast> intervals;
 
             // Map simple names to weather codes
             static const std::map<std::string, int> weather_codes = {
@@ -80,7 +82,7 @@ namespace weather
             }
 
             // Determine precipitation type and intensity
-            std::string precip_type = "0"; // N/A
+            uint8_t precip_type = 0; // N/A
             float precip_intensity = 0.0f;
             float snow_accumulation = 0.0f;
             float ice_accumulation = 0.0f;
@@ -95,13 +97,13 @@ namespace weather
             {
                 if (type_lower.find("freezing") != std::string::npos)
                 {
-                    precip_type = "3"; // Freezing Rain
+                    precip_type = 3; // Freezing Rain
                     precip_intensity = type_lower.find("light") != std::string::npos ? 0.5f : type_lower.find("heavy") != std::string::npos ? 2.0f
                                                                                                                                             : 1.0f;
                 }
                 else
                 {
-                    precip_type = "1"; // Rain
+                    precip_type = 1; // Rain
                     precip_intensity = type_lower.find("light") != std::string::npos ||
                                                type_lower.find("drizzle") != std::string::npos
                                            ? 0.3f
@@ -112,7 +114,7 @@ namespace weather
             else if (type_lower.find("snow") != std::string::npos ||
                      type_lower.find("flurries") != std::string::npos)
             {
-                precip_type = "2"; // Snow
+                precip_type = 2; // Snow
                 precip_intensity = type_lower.find("light") != std::string::npos ||
                                            type_lower.find("flurries") != std::string::npos
                                        ? 0.2f
@@ -122,7 +124,7 @@ namespace weather
             }
             else if (type_lower.find("ice") != std::string::npos)
             {
-                precip_type = "4"; // Ice Pellets
+                precip_type = 4; // Ice Pellets
                 precip_intensity = type_lower.find("light") != std::string::npos ? 0.3f : type_lower.find("heavy") != std::string::npos ? 2.0f
                                                                                                                                         : 1.0f;
                 ice_accumulation = 1.0f * precip_intensity;
@@ -131,11 +133,10 @@ namespace weather
             // Generate intervals for each day
             for (int i = 0; i < num_days; ++i)
             {
-                std::map<std::string, std::string> interval;
+                DayForecast interval;
 
-                interval["weather_description"] = weather_code_parser(code);
-                interval["weatherCodeDay"] = std::to_string(code);
-                interval["temperature"] = std::to_string(65 + (i * 2));
+                interval.weather_code = code;
+                interval.temperature = 65 + (i * 2);
 
                 int cloud_cover = 10;
                 if (type_lower.find("mostly_cloudy") != std::string::npos)
@@ -146,21 +147,21 @@ namespace weather
                     cloud_cover = 90;
                 else if (type_lower.find("fog") != std::string::npos)
                     cloud_cover = 100;
-                interval["cloudCover"] = std::to_string(cloud_cover);
-
-                interval["windDirection"] = std::to_string(180 + (i * 45));
-                interval["windSpeed"] = std::to_string(10 + (i * 3));
-                interval["precipitationProbability"] = precip_type != "0" ? "90" : "5";
-                interval["precipitationType"] = precip_type;
-                interval["precipitationIntensity"] = std::to_string(precip_intensity);
-                interval["snowAccumulation"] = std::to_string(snow_accumulation);
-                interval["iceAccumulation"] = std::to_string(ice_accumulation);
-                interval["sunriseTime"] = "07:30:00";
-                interval["sunsetTime"] = "18:45:00";
+                interval.cloud_cover = cloud_cover;
+
+                interval.wind_direction = 180 + (i * 45);
+                interval.wind_speed = 10 + (i * 3);
+                interval.precip_probability = precip_type != 0 ? 90 : 5;
+                interval.precip_type = precip_type;
+                interval.precip_intensity = precip_intensity;
+                interval.snow_accumulation = snow_accumulation;
+                interval.ice_accumulation = ice_accumulation;
+                interval.sunrise_minutes = 7 * 60 + 30;
+                interval.sunset_minutes = 18 * 60 + 45;
 
                 // Day names
                 const char *days[] = {"Monday", "Tuesday", "Wednesday"};
-                interval["day"] = days[i % 3];
+                interval.set_day_name(days[i % 3]);
 
                 intervals.push_back(interval);
             }
@@ -189,7 +190,7 @@ namespace weather
         {
     private:
 
-        static constexpr std::array modifiables = {"FPS", "Gravity Magnitude"};
+        static constexpr std::array modifiables = {"FPS", "Gravity Magnitude", "Palette Brightness"};
 
         WeatherDisplayHandler &weather_handler_;
         std::string current_weather_ = "";
@@ -224,6 +225,75 @@ namespace weather
             weather_handler_.set_new_gravity(read_target());
         }
 
+        static void update_palette_brightness()
+        {
+            palette_brightness = std::clamp(static_cast<int>(read_target()), 0, 255);
+        }
+
+        static void update_seed()
+        {
+            char input[64];
+            printf("Input new seed: \n");
+
+            read_line(input, sizeof(input));
+            const uint64_t seed = std::strtoull(process_line(input).c_str(), nullptr, 0);
+            seed_rng(seed);
+
+            printf("RNG seed: %llu\n", seed);
+        }
+
+        /**
+         * @brief Print the forecast each segment is showing.
+         */
+        void print_forecast()
+        {
+            for (uint8_t day = 0; day < weather_handler_.get_num_segments(); day++)
+            {
+                printf("\nDay %d:\n", day + 1);
+                for (const auto &[key, value] : forecast_to_map(weather_handler_.get_forecast(day)))
+                {
+                    printf("  %s: %s\n", key.c_str(), value.c_str());
+                }
+            }
+        }
+
+        /**
+         * @brief Run a rain, snow and thunderstorm forecast twice from the
+         * current seed and check both runs draw the same frames.
+         */
+        void check_determinism()
+        {
+            const std::array<std::string, 3> types = {"heavy_rain", "heavy_snow", "thunderstorm"};
+            std::vector<DayForecast> forecast;
+            for (uint8_t day = 0; day < weather_handler_.get_num_segments(); day++)
+            {
+                forecast.push_back(MockWeatherGenerator::generate(types[day % types.size()], day + 1)[day]);
+            }
+
+            bench::frame_determinism(weather_handler_, forecast, rng_seed);
+            current_weather_ = "";
+        }
+
+        /**
+         * @brief Switch to a render mode, or back to serial if it's already active.
+         */
+        void toggle_render_mode(const RenderMode mode)
+        {
+            const RenderMode new_mode = weather_handler_.get_render_mode() == mode ? RenderMode::kSerial : mode;
+            weather_handler_.set_render_mode(new_mode);
+            printf("Render mode: %s\n", render_mode_name(new_mode));
+        }
+
+        void print_segment_assignment()
+        {
+            printf("Segments:");
+            for (uint8_t i = 0; i < weather_handler_.get_num_segments(); i++)
+            {
+                printf(" [%d: core %d, %lu us]", i, weather_handler_.get_segment_core(i), weather_handler_.get_segment_cost_us(i));
+            }
+            printf("\n");
+        }
+
         static void print_help()
         {
             printf("\n=== Weather Display Testing Mode ===\n");
@@ -253,6 +323,20 @@ namespace weather
             printf("Commands:\n");
             printf("  help - Show this help\n");
             printf("  list - List all available weather types\n");
+            printf("  forecast - Show the forecast each segment is displaying\n");
+            printf("  bench_physics - Compare scalar, CMSIS-DSP and fixed-point particle integrators\n");
+            printf("  fixed_check - Compare fixed-point trajectories against the float reference\n");
+            printf("  bench_streak - Compare the generic line drawing against the streak rasterizer\n");
+            printf("  bench_points - Compare per pixel snowflake drawing against the batched point drawing\n");
+            printf("  bench_rng - Compare the particle RNG against the hardware random number generator\n");
+            printf("  rng_check - Run a forecast from the current seed, serially and after split mode, and check the frames match\n");
+            printf("  seed - Set the seed for the particle RNG\n");
+            printf("  pipeline - Toggle between serial and pipelined dual-core rendering\n");
+            printf("  split - Toggle sharing segments out between both cores\n");
+            printf("  double_buffer - Toggle double buffering, sending one framebuffer to the panel while drawing the other\n");
+            printf("  light - Toggle following the light sensor by polling or by its threshold interrupt\n");
+            printf("  idle - Toggle idling the display in a dark room with nobody near\n");
+            printf("  governor - Toggle scaling the particle load to hold the target FPS\n");
             printf("  exit - Exit test mode\n\n");
 
             printf("How to use:\n");
@@ -369,6 +453,7 @@ namespace weather
 
             bool animating = false;
             uint32_t last_status_time = 0;
+            uint32_t misses_reported = 0; // Budget misses at the last status report.
             uint32_t pos = 0;
 
             while (true)
@@ -386,9 +471,40 @@ namespace weather
                     if ((frame_count_) % 100 == 0)
                     {
                         float fps_approx = 1.0f / (delta / 1'000'000.0f);
-                        printf("Approximate FPS: %f \n", fps_approx);
+                        const AmbientLight &light = weather_handler_.get_ambient_light();
+                        printf("Approximate FPS: %f (light sensor off the frame path, %ld us/frame recovered)\n", fps_approx,
+                               weather_handler_.get_ambient_light_saving_us());
+                        printf("Light sensor: %s, %lu readings, %lu interrupts, %.1f lux, brightness %u, %s.\n",
+                               AmbientLight::mode_name(light.mode()), light.samples(), light.interrupts(), light.lux(), light.brightness(),
+                               light.near() ? "someone near" : "nobody near");
+                        const IdleMode &idle = weather_handler_.get_idle_mode();
+                        printf("Power: %s%s. Active %.1f s, idle %.1f s, %lu wakes.\n", IdleMode::state_name(idle.state()),
+                               idle.enabled() ? "" : " (idling off)", idle.seconds_in(PowerState::kActive),
+                               idle.seconds_in(PowerState::kIdle), idle.wakes());
                         printf("[Animating - frame %lu. Press any key to halt/change weather.]\n", frame_count_);
                         printf("Total Particle Count: %d. \n", weather_handler_.get_total_particle_count());
+                        const FrameGovernor &governor = weather_handler_.get_frame_governor();
+                        printf("Particle load: %.2f%s, %lu cuts, %lu raises. Frame budget missed %lu times since the last report, %lu of %lu frames in all.\n",
+                               governor.load(), governor.enabled() ? "" : " (governor off)", governor.cuts(), governor.raises(),
+                               governor.misses() - misses_reported, governor.misses(), governor.frames());
+                        misses_reported = governor.misses();
+                        printf("Render mode: %s. Simulate: %lu us, render: %lu us.\n",
+                               render_mode_name(weather_handler_.get_render_mode()),
+                               weather_handler_.get_simulate_us(), weather_handler_.get_render_us());
+                        printf("Core utilisation: core 0 %.1f%%, core 1 %.1f%%.\n",
+                               weather_handler_.get_core_utilisation(0), weather_handler_.get_core_utilisation(1));
+                        printf("Pixels cleared last frame: %lu. Full clears in the last 100 frames: %lu.\n",
+                               weather_handler_.get_pixels_cleared(), weather_handler_.get_full_clears());
+                        weather_handler_.reset_full_clears();
+                        if (weather_handler_.get_render_mode() == RenderMode::kSplitSegments)
+                        {
+                            print_segment_assignment();
+                        }
+                        else if (weather_handler_.get_render_mode() == RenderMode::kDoubleBuffered)
+                        {
+                            printf("Panel update: %lu us on core 1, saving %ld us/frame over a synchronous update.\n",
+                                   weather_handler_.get_panel_us(), weather_handler_.get_double_buffer_saving_us());
+                        }
                     }
 
                     last_status_time = now;
@@ -439,10 +555,87 @@ namespace weather
                         update_fps_target();
                     }
 
+                    else if (line == "palette_brightness" || line == "brightness")
+                    {
+                        update_palette_brightness();
+                    }
+
+                    else if (line == "light" || line == "light_mode")
+                    {
+                        const bool polled = weather_handler_.get_ambient_light().mode() == AmbientLight::Mode::kPolled;
+                        weather_handler_.set_ambient_light_mode(polled ? AmbientLight::Mode::kThresholds : AmbientLight::Mode::kPolled);
+                        printf("Light sensor: %s.\n", AmbientLight::mode_name(weather_handler_.get_ambient_light().mode()));
+                    }
+
+                    else if (line == "idle")
+                    {
+                        const bool enabled = !weather_handler_.get_idle_mode().enabled();
+                        weather_handler_.set_idle_enabled(enabled);
+                        printf("Idling in a dark, empty room %s.\n", enabled ? "on" : "off");
+                    }
+
+                    else if (line == "governor")
+                    {
+                        const bool enabled = !weather_handler_.get_frame_governor().enabled();
+                        weather_handler_.set_governor_enabled(enabled);
+                        printf("Particle load governor %s.\n", enabled ? "on" : "off");
+                    }
+
                     else if (line == "unlock" || line == "unlock_fps" || line == "fps_unlock")
                     {
                         weather_handler_.set_new_fps_target(8500.0f);
-                        printf("FPS Unlocked successfully.");
+                        weather_handler_.set_governor_enabled(false); // No load would hold 8500 FPS.
+                        printf("FPS Unlocked successfully, particle load governor off.");
+                    }
+
+                    else if (line == "bench_physics" || line == "bench_integrator")
+                    {
+                        bench::particle_integrator();
+                    }
+
+                    else if (line == "fixed_check")
+                    {
+                        bench::fixed_point_accuracy();
+                    }
+
+                    else if (line == "bench_streak")
+                    {
+                        bench::streak_rasterizer();
+                    }
+
+                    else if (line == "bench_points")
+                    {
+                        bench::point_sprites();
+                    }
+
+                    else if (line == "bench_rng")
+                    {
+                        bench::random_numbers();
+                    }
+
+                    else if (line == "rng_check")
+                    {
+                        check_determinism();
+                    }
+
+                    else if (line == "seed" || line == "set_seed")
+                    {
+                        update_seed();
+                    }
+
+                    else if (line == "pipeline" || line == "pipelined")
+                    {
+                        toggle_render_mode(RenderMode::kPipelined);
+                    }
+
+                    else if (line == "split" || line == "split_segments")
+                    {
+                        toggle_render_mode(RenderMode::kSplitSegments);
+                    }
+
+                    else if (line == "double_buffer" || line == "double_buffered")
+                    {
+                        toggle_render_mode(RenderMode::kDoubleBuffered);
                     }
 
                     else if (line == "list")
@@ -450,6 +643,11 @@ namespace weather
                         print_list();
                     }
 
+                    else if (line == "forecast")
+                    {
+                        print_forecast();
+                    }
+
                     else if (line == "exit" || line == "quit" || line == "return")
                     {
                         printf("Exiting debug console...\n");
@@ -462,8 +660,9 @@ namespace weather
                         printf("\nGenerating mock data for: %s\n", line.c_str());
                         auto mock_data = MockWeatherGenerator::generate(line, 3);
 
+                        // Start the effects afresh even if this weather is already showing.
                         printf("Updating display...\n");
-                        weather_handler_.update_weather(mock_data);
+                        weather_handler_.update_weather(mock_data, true);
 
                         printf("✓ Display updated successfully!\n");
                         printf("Weather: %s\n", line.c_str());
@@ -0,0 +1,321 @@
+#ifndef AMBIENT_LIGHT_H
+#define AMBIENT_LIGHT_H
+
+#include "AP3216_WE.h"
+#include "pico/stdlib.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * @brief Samples the room's light level off the render path and hands the
+ * panel brightness to the renderer, along with whether anyone is near.
+ *
+ * Each reading is one burst of the AP3216's IR, ALS and PS data. The
+ * proximity sensor's thresholds give the object bit its hysteresis, and
+ * its interrupt shares the INT pin with the ALS one.
+ *
+ * Two modes:
+ * - kPolled: a repeating timer reads the AP3216 once per ALS conversion and
+ *   smooths the readings. Each tick queues the read in the I2C controller's
+ *   FIFO and collects the one queued the tick before, so the interrupt never
+ *   waits on the bus.
+ * - kThresholds: the sensor's ALS thresholds bracket the current brightness
+ *   band, and its INT pin raises a GPIO interrupt once the light has been
+ *   outside them for a few conversions, or at once when someone comes or
+ *   goes. Only then is the sensor read and the thresholds moved to the new
+ *   band, so a steady, empty room costs no bus traffic. Reading the data
+ *   clears both interrupts. A slow timer re-reads it anyway, in case an edge
+ *   was missed or INT isn't wired. The interrupt and the timer only flag the
+ *   re-band: its blocking transfers run from service(), on the frame loop,
+ *   so they never hold up the Hub75 DMA interrupt, which shares their
+ *   priority.
+ *
+ * Readings are published through lock-free atomics; the renderer only loads
+ * one. Nothing else may use the sensor while it is running.
+ */
+class AmbientLight
+{
+public:
+    enum class Mode : uint8_t
+    {
+        kPolled,
+        kThresholds,
+    };
+
+    static constexpr int32_t kSamplePeriodMs = 100;     // The sensor makes a new ALS reading about this often.
+    static constexpr int32_t kRecheckPeriodMs = 10'000; // Safety re-read in kThresholds mode.
+    static constexpr float kSmoothing = 0.3f;           // Weight of a new reading in the running average.
+    static constexpr uint8_t kPersistConversions = 4;   // Conversions outside the band before INT fires.
+    static constexpr float kBandMargin = 0.1f;          // Thresholds sit this far outside the band, so light at an edge doesn't chatter.
+    static constexpr int kMinBrightness = 2;            // Panel brightness in the dark.
+    static constexpr int kMaxBrightness = 10;           // Panel brightness in a bright room.
+    static constexpr uint16_t kNearCounts = 400;        // PS count above which someone is near.
+    static constexpr uint16_t kGoneCounts = 200;        // PS count below which they have gone.
+
+private:
+    static constexpr uint8_t kDataBytes = 6; // IR, ALS and PS data registers.
+
+    static inline AmbientLight *interrupt_owner_ = nullptr; // Instance the GPIO callback goes to.
+
+    AP3216_WE &sensor_;
+    repeating_timer_t timer_{};
+    Mode mode_ = Mode::kPolled;
+    uint int_pin_ = 0;
+    bool running_ = false;
+    bool filtering_ = false;    // filtered_lux_ holds a reading.
+    float filtered_lux_ = 0.0f; // Running average, only touched in interrupt context.
+    uint32_t started_us_ = 0;   // When sampling started.
+
+    std::atomic<uint8_t> brightness_{kMinBrightness}; // Panel brightness for the light level.
+    std::atomic<float> lux_{0.0f};                    // Light level, filtered in kPolled mode.
+    std::atomic<bool> near_{false};                   // Someone is near the sensor.
+    std::atomic<bool> band_due_{false};               // INT or the re-read timer asked for a re-band, see service().
+    std::atomic<uint32_t> samples_{0};                // Readings taken since sampling started.
+    std::atomic<uint32_t> interrupts_{0};             // INT edges handled since sampling started.
+    std::atomic<uint32_t> read_us_{0};                // How long the last blocking reading held the caller.
+    std::atomic<uint32_t> bus_us_{0};                 // Time spent on the sensor since sampling started.
+
+    static_assert(std::atomic<float>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                  "Readings are published from an interrupt, so must be lock-free");
+
+    static bool on_timer(repeating_timer_t *timer)
+    {
+        auto *self = static_cast<AmbientLight *>(timer->user_data);
+        if (self->mode_ == Mode::kPolled)
+        {
+            self->poll();
+        }
+        else
+        {
+            self->band_due_.store(true, std::memory_order_release);
+        }
+        return true;
+    }
+
+    static void on_interrupt(const uint gpio, uint32_t)
+    {
+        if (interrupt_owner_ && gpio == interrupt_owner_->int_pin_)
+        {
+            interrupt_owner_->interrupts_.fetch_add(1, std::memory_order_relaxed);
+            interrupt_owner_->band_due_.store(true, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief Read the sensor's data, timing the transfer. Publishes whether
+     * anyone is near and returns the light level.
+     */
+    float read_lux()
+    {
+        const uint32_t start = time_us_32();
+        const AP3216Data data = sensor_.getAllData();
+        const uint32_t elapsed = time_us_32() - start;
+        read_us_.store(elapsed, std::memory_order_relaxed);
+        bus_us_.fetch_add(elapsed, std::memory_order_relaxed);
+        samples_.fetch_add(1, std::memory_order_relaxed);
+        near_.store(data.objectNear, std::memory_order_relaxed);
+        return sensor_.alsToLux(data.als);
+    }
+
+    void publish(const float lux)
+    {
+        lux_.store(lux, std::memory_order_relaxed);
+        brightness_.store(to_brightness(lux), std::memory_order_relaxed);
+    }
+
+    void smooth(const float lux)
+    {
+        filtered_lux_ = filtering_ ? filtered_lux_ + kSmoothing * (lux - filtered_lux_) : lux;
+        filtering_ = true;
+        publish(filtered_lux_);
+    }
+
+    /**
+     * @brief Collect the data queued last tick and queue the next read.
+     * A tick is a whole ALS conversion, so the last read is long done.
+     */
+    void poll()
+    {
+        const uint32_t start = time_us_32();
+        uint8_t bytes[kDataBytes];
+        if (sensor_.pollReadRegs(bytes) == BURST_DONE)
+        {
+            const AP3216Data data = AP3216_WE::decodeData(bytes);
+            samples_.fetch_add(1, std::memory_order_relaxed);
+            near_.store(data.objectNear, std::memory_order_relaxed);
+            smooth(sensor_.alsToLux(data.als));
+        }
+        sensor_.startReadRegs(AP3216_WE::IR_DATA_LOW_REG, kDataBytes);
+        bus_us_.fetch_add(time_us_32() - start, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Read the sensor, publish the brightness and put the thresholds
+     * around its band. Reading the data clears the interrupt. If the light
+     * has already left the new band by the time the thresholds are set, INT
+     * is low again and no edge will come, so go round again next frame.
+     */
+    void follow_band()
+    {
+        const float lux = read_lux();
+        publish(lux);
+
+        const uint8_t brightness = to_brightness(lux);
+        const float low = brightness == kMinBrightness ? 0.0f : std::sqrt(2.0f * brightness) * (1.0f - kBandMargin);
+        // The top band has no upper edge; keep its threshold just under full scale.
+        const float high = brightness == kMaxBrightness ? sensor_.getLuxMax(sensor_.getLuxRange()) * 0.99f
+                                                        : std::sqrt(2.0f * (brightness + 1)) * (1.0f + kBandMargin);
+        const uint32_t start = time_us_32();
+        sensor_.setALSThresholds(low, high);
+        bus_us_.fetch_add(time_us_32() - start, std::memory_order_relaxed);
+
+        if (!gpio_get(int_pin_))
+        {
+            band_due_.store(true, std::memory_order_release);
+        }
+    }
+
+public:
+    explicit AmbientLight(AP3216_WE &sensor) : sensor_(sensor) {}
+
+    ~AmbientLight() { stop(); }
+
+    AmbientLight(const AmbientLight &) = delete;
+    AmbientLight &operator=(const AmbientLight &) = delete;
+
+    /**
+     * @brief Take a first reading, then keep following the light.
+     *
+     * @param mode How to follow it.
+     * @param int_pin GPIO the sensor's INT pin is wired to, for kThresholds.
+     */
+    void start(const Mode mode, const uint int_pin)
+    {
+        stop();
+        mode_ = mode;
+        int_pin_ = int_pin;
+        filtering_ = false;
+        started_us_ = time_us_32();
+        samples_.store(0, std::memory_order_relaxed);
+        interrupts_.store(0, std::memory_order_relaxed);
+        band_due_.store(false, std::memory_order_relaxed);
+        bus_us_.store(0, std::memory_order_relaxed);
+
+        sensor_.setPSThresholds(kGoneCounts, kNearCounts);
+        sensor_.setPSInterruptMode(INT_MODE_HYSTERESIS); // Interrupt when someone comes or goes.
+        sensor_.setPSIntAfterNConversions(1);
+        if (mode_ == Mode::kThresholds)
+        {
+            sensor_.setIntClearManner(CLR_INT_BY_DATA_READ);
+            sensor_.setALSIntAfterNConversions(kPersistConversions);
+        }
+        resume();
+    }
+
+    /**
+     * @brief Carry on following the light after stop(), in the same mode and
+     * keeping the readings and counts so far.
+     */
+    void resume()
+    {
+        if (running_)
+        {
+            return;
+        }
+        if (mode_ == Mode::kPolled)
+        {
+            sample();
+            running_ = add_repeating_timer_ms(-kSamplePeriodMs, on_timer, this, &timer_);
+            return;
+        }
+
+        gpio_init(int_pin_);
+        gpio_set_dir(int_pin_, GPIO_IN);
+        gpio_pull_up(int_pin_); // INT is open drain, active low.
+        interrupt_owner_ = this;
+        gpio_set_irq_enabled_with_callback(int_pin_, GPIO_IRQ_EDGE_FALL, true, on_interrupt);
+        follow_band();
+        running_ = add_repeating_timer_ms(-kRecheckPeriodMs, on_timer, this, &timer_);
+    }
+
+    /**
+     * @brief Stop following the light and leave the bus idle: the timer is
+     * cancelled, INT masked and any queued read collected.
+     */
+    void stop()
+    {
+        if (!running_)
+        {
+            return;
+        }
+        cancel_repeating_timer(&timer_);
+        if (sensor_.readQueued())
+        {
+            uint8_t bytes[kDataBytes];
+            sensor_.waitReadRegs(bytes); // Leave the bus free for the next user.
+        }
+        if (mode_ == Mode::kThresholds)
+        {
+            gpio_set_irq_enabled(int_pin_, GPIO_IRQ_EDGE_FALL, false);
+            interrupt_owner_ = nullptr;
+        }
+        running_ = false;
+    }
+
+    /**
+     * @brief Do the re-band the interrupt or timer asked for, if any. Call it
+     * from the frame loop; in kPolled mode there is never anything to do.
+     */
+    void service()
+    {
+        if (running_ && band_due_.exchange(false, std::memory_order_acquire))
+        {
+            follow_band();
+        }
+    }
+
+    /**
+     * @brief Read the sensor once, waiting on the bus, then smooth the
+     * reading and publish the result. Only call it while stopped.
+     */
+    void sample()
+    {
+        smooth(read_lux());
+    }
+
+    /**
+     * @brief Panel brightness for a light level.
+     */
+    [[nodiscard]] static uint8_t to_brightness(const float lux)
+    {
+        return std::clamp(static_cast<int>(lux * lux / 2.0f), kMinBrightness, kMaxBrightness);
+    }
+
+    [[nodiscard]] static const char *mode_name(const Mode mode)
+    {
+        return mode == Mode::kPolled ? "polled" : "thresholds";
+    }
+
+    [[nodiscard]] Mode mode() const { return mode_; }
+    [[nodiscard]] uint int_pin() const { return int_pin_; }
+    [[nodiscard]] uint8_t brightness() const { return brightness_.load(std::memory_order_relaxed); }
+    [[nodiscard]] float lux() const { return lux_.load(std::memory_order_relaxed); }
+    [[nodiscard]] bool near() const { return near_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint32_t samples() const { return samples_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint32_t interrupts() const { return interrupts_.load(std::memory_order_relaxed); }
+    [[nodiscard]] uint32_t read_us() const { return read_us_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Bus time used per second since sampling started, in us.
+     */
+    [[nodiscard]] float bus_us_per_s() const
+    {
+        const uint32_t elapsed = time_us_32() - started_us_;
+        return elapsed ? bus_us_.load(std::memory_order_relaxed) * 1e6f / elapsed : 0.0f;
+    }
+};
+
+#endif // AMBIENT_LIGHT_H
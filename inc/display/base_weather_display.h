@@ -2,8 +2,9 @@
 #define BASE_WEATHER_DISPLAY_H
 
 #include "z_buffer.h"
+#include "draw_list.h"
 #include "segment/segment_properties.h"
-#include <string>
+#include "day_forecast.h"
 
 /**
  * @brief Base weather display that handles common elements across all weather types
@@ -18,67 +19,51 @@ class BaseWeatherDisplay
 {
 private:
     DisplaySegProperties &seg_properties_;
-    // Weather data
-    float temperature_;
-    float wind_speed_;
-    float wind_direction_;
-    std::string sunrise_time_;
-    std::string sunset_time_;
-    std::string day_name_;
-    int cloud_cover_;
+    DayForecast day_; // Weather data
 
 public:
     BaseWeatherDisplay(DisplaySegProperties &segment)
-        : seg_properties_(segment), temperature_(0), wind_speed_(0), wind_direction_(0), cloud_cover_(0)
+        : seg_properties_(segment)
     {
     }
 
-    void update_data(const float temperature, const float wind_speed, const float wind_direction,
-                     const std::string &sunrise_time, const std::string &sunset_time,
-                     const std::string &day_name, const int cloud_cover)
+    void update_data(const DayForecast &day)
     {
-        temperature_ = temperature;
-        wind_speed_ = wind_speed;
-        wind_direction_ = wind_direction;
-        sunrise_time_ = sunrise_time;
-        sunset_time_ = sunset_time;
-        day_name_ = day_name;
-        cloud_cover_ = cloud_cover;
+        day_ = day;
     }
 
-    void draw(pimoroni::PicoZGraphics &graphics)
+    void draw(DrawList &list)
     {
-        // draw_sky_gradient(graphics);
-        // draw_temperature(graphics);
-        // draw_wind_indicator(graphics);
-        // draw_day_label(graphics);
+        // draw_sky_gradient(list);
+        // draw_temperature(list);
+        // draw_wind_indicator(list);
+        // draw_day_label(list);
     }
 
 private:
-    void draw_sky_gradient(pimoroni::PicoZGraphics &graphics) const {
+    void draw_sky_gradient(DrawList &list) const {
         // TODO: Implement sky gradient based on time of day
         // For now, draw a simple blue sky
-        pimoroni::Pen sky_pen = graphics.create_pen(100, 150, 255);
-        graphics.set_pen(sky_pen);
+        const uint32_t sky_pen = pack_rgb888(100, 150, 255);
 
         const RectMod bounds = seg_properties_.get_seg_bounds();
 
-        graphics.rectangle(bounds);
+        list.add_rect(bounds, sky_pen, 0);
     }
 
-    void draw_temperature(pimoroni::PicoZGraphics &graphics)
+    void draw_temperature(DrawList &list)
     {
         // TODO: Implement temperature display
         // Need text rendering support
     }
 
-    void draw_wind_indicator(pimoroni::PicoZGraphics &graphics)
+    void draw_wind_indicator(DrawList &list)
     {
         // TODO: Implement wind indicator
         // Could draw an arrow showing direction and speed
     }
 
-    void draw_day_label(pimoroni::PicoZGraphics &graphics)
+    void draw_day_label(DrawList &list)
     {
         // TODO: Implement day label
         // Need text rendering support
@@ -0,0 +1,123 @@
+#ifndef CORE1_WORKER_H
+#define CORE1_WORKER_H
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+
+/**
+ * @brief Runs jobs handed over from core 0 on core 1.
+ *
+ * Jobs are passed through the inter-core hardware FIFOs, which are lock-free:
+ * core 0 pushes a function and its argument, core 1 runs it and pushes back a
+ * completion token. Only one job is in flight at a time; submit() must be
+ * paired with wait() before the next submit().
+ */
+class Core1Worker
+{
+public:
+    using Job = void (*)(void *);
+
+private:
+    static constexpr uint32_t kJobDone = 0xD0E5D0E5;
+
+    static inline bool launched_ = false;
+    static inline bool job_pending_ = false;
+    static inline volatile bool parked_ = false;  // Core 1 is spinning in RAM.
+    static inline volatile bool release_ = false; // Core 0 is done, core 1 may go.
+
+    /**
+     * @brief Spin with interrupts off until released. Runs from RAM, so core 1
+     * keeps off the flash bus while core 0 erases or programs it.
+     */
+    static void __not_in_flash_func(park)(void *)
+    {
+        const uint32_t interrupts = save_and_disable_interrupts();
+        parked_ = true;
+        while (!release_)
+        {
+        }
+        restore_interrupts(interrupts);
+    }
+
+    [[noreturn]] static void core1_entry()
+    {
+        while (true)
+        {
+            const auto job = reinterpret_cast<Job>(multicore_fifo_pop_blocking());
+            void *arg = reinterpret_cast<void *>(multicore_fifo_pop_blocking());
+            job(arg);
+            multicore_fifo_push_blocking(kJobDone);
+        }
+    }
+
+public:
+    /**
+     * @brief Start core 1, if it isn't already running.
+     */
+    static void launch()
+    {
+        if (!launched_)
+        {
+            multicore_launch_core1(core1_entry);
+            launched_ = true;
+        }
+    }
+
+    /**
+     * @brief Hand a job to core 1. Returns immediately.
+     *
+     * @param job Function to run on core 1.
+     * @param arg Argument passed to the job.
+     */
+    static void submit(const Job job, void *arg)
+    {
+        launch();
+        multicore_fifo_push_blocking(reinterpret_cast<uintptr_t>(job));
+        multicore_fifo_push_blocking(reinterpret_cast<uintptr_t>(arg));
+        job_pending_ = true;
+    }
+
+    /**
+     * @brief Block until the job in flight, if any, has finished.
+     */
+    static void wait()
+    {
+        if (job_pending_)
+        {
+            multicore_fifo_pop_blocking();
+            job_pending_ = false;
+        }
+    }
+
+    /**
+     * @brief Run a job on core 0 while core 1 is parked in RAM, for jobs that
+     * take the flash away from XIP. Waits for any job in flight first.
+     *
+     * @param job Function to run on core 0.
+     * @param arg Argument passed to the job.
+     */
+    static void run_with_core1_parked(const Job job, void *arg)
+    {
+        if (!launched_)
+        {
+            job(arg);
+            return;
+        }
+
+        wait();
+        parked_ = false;
+        release_ = false;
+        submit(park, nullptr);
+        while (!parked_)
+        {
+        }
+        job(arg);
+        release_ = true;
+        wait();
+    }
+
+    [[nodiscard]] static bool job_pending() { return job_pending_; }
+};
+
+#endif // CORE1_WORKER_H
@@ -0,0 +1,66 @@
+#ifndef DEPTH_PALETTE_H
+#define DEPTH_PALETTE_H
+
+#include "z_buffer.h"
+
+#include <array>
+
+// Scales the colors of every depth palette, 255 is full brightness.
+inline uint8_t palette_brightness = 255;
+
+/**
+ * @brief A color shaded by depth, for every one of the 256 depths the
+ * framebuffer can store. Entries are packed as 0xDDRRGGBB, so drawing a
+ * particle is a single table load.
+ *
+ * The table is built once up front and only rebuilt when the color or the
+ * brightness it was built for changes.
+ */
+class DepthPalette
+{
+    std::array<uint32_t, 256> entries_{}; // Shaded color for each depth.
+    Color color_ = kBlack;                // Color the table was built for.
+    uint8_t brightness_ = 0;              // Brightness the table was built for.
+
+    void build()
+    {
+        for (uint16_t depth = 0; depth < entries_.size(); depth++)
+        {
+            const float scale = (depth / 255.0f) * (brightness_ / 255.0f);
+            entries_[depth] = pack_rgb888((scale * color_.r), (scale * color_.g), (scale * color_.b)) | (depth << 24);
+        }
+    }
+
+public:
+    DepthPalette(const Color color, const uint8_t brightness = palette_brightness)
+        : color_(color), brightness_(brightness)
+    {
+        build();
+    }
+
+    /**
+     * @brief Rebuild the table if the color or brightness has changed since it
+     * was last built. Cheap to call every frame.
+     */
+    void update(const Color color, const uint8_t brightness = palette_brightness)
+    {
+        if (color.r != color_.r || color.g != color_.g || color.b != color_.b || brightness != brightness_)
+        {
+            color_ = color;
+            brightness_ = brightness;
+            build();
+        }
+    }
+
+    /**
+     * @brief Get the packed depth and color for a depth.
+     */
+    [[nodiscard]] uint32_t operator[](const uint8_t depth) const { return entries_[depth]; }
+
+    /**
+     * @brief Get just the color for a depth, without the depth byte.
+     */
+    [[nodiscard]] uint32_t color(const uint8_t depth) const { return entries_[depth] & 0x00FFFFFF; }
+};
+
+#endif // DEPTH_PALETTE_H
@@ -5,11 +5,22 @@
 #include "base_weather_display.h"
 #include "weather_factory.h"
 #include "weather_effect_base.h"
+#include "day_forecast.h"
 
+#include <algorithm>
 #include <vector>
-#include <memory>
-#include <string>
-#include <map>
+#include <string_view>
+#include <variant>
+
+/**
+ * @brief What DisplaySegment::update_state() did with a new day.
+ */
+enum class SegmentUpdate : uint8_t
+{
+    kUnchanged, // Same forecast as before; nothing was touched.
+    kRetuned,   // Same effects, adjusted in place; particles carry on.
+    kRebuilt,   // Effects torn down and created afresh.
+};
 
 /**
  * @brief Represents a single segment of the display showing one day's weather
@@ -27,12 +38,13 @@ class DisplaySegment
 
 private:
     DisplaySegProperties seg_properties_;
-    std::string weather_state_;
-    std::map<std::string, std::string> weather_info_;
+    DayForecast forecast_;      // The day this segment shows.
     // Composition: Base display + weather effects
     BaseWeatherDisplay base_display_;
-    std::vector<std::unique_ptr<WeatherEffectBase>> weather_effects_;
+    std::vector<WeatherEffect> weather_effects_;
     uint32_t prev_time_ = 0;
+    float fixed_dt_ = 0.0f; // Timestep used instead of the measured one, 0 to measure.
+    float load_ = 1.0f;     // Share of the full particle load, given to every effect.
     uint16_t particle_count_ = 0;
 
 public:
@@ -43,154 +55,177 @@ public:
     /**
      * @brief Update the weather state with new weather data
      *
-     * This is called when new weather data arrives from the API.
-     * It creates appropriate weather effects based on the data.
+     * This is called when new weather data arrives from the API. A day that
+     * hasn't changed is left alone. A day that needs the same effects (see
+     * WeatherEffectFactory::same_effects()) keeps them and has them retuned,
+     * so the particles on screen carry on and nothing is allocated unless
+     * the particle limit grows. Only a change of effects rebuilds them.
+     *
+     * @param day_weather The day to show.
+     * @param rebuild Rebuild the effects even if the day hasn't changed,
+     * e.g. to restart them from a known RNG state.
+     * @return What was done.
      */
-    void update_state(const std::map<std::string, std::string> &day_weather)
+    SegmentUpdate update_state(const DayForecast &day_weather, const bool rebuild = false)
     {
-        weather_info_ = day_weather;
-
-        // Extract weather description
-        const auto it = day_weather.find("weather_description");
-        weather_state_ = (it != day_weather.end()) ? it->second : "Unknown";
+        if (!rebuild && day_weather == forecast_)
+        {
+            return SegmentUpdate::kUnchanged;
+        }
+        const bool keep_effects = !rebuild && WeatherEffectFactory::same_effects(forecast_.weather(), day_weather.weather());
+        forecast_ = day_weather;
 
         // Update base display with common data
-        const float temperature = get_float_value("temperature", 0.0f);
-        const float wind_speed = get_float_value("windSpeed", 0.0f);
-        const float wind_direction = get_float_value("windDirection", 0.0f);
-        std::string sunrise_time = get_string_value("sunriseTime", "");
-        std::string sunset_time = get_string_value("sunsetTime", "");
-        std::string day_name = get_string_value("day", "");
-        const int cloud_cover = get_int_value("cloudCover", 0);
+        base_display_.update_data(forecast_);
+        seg_properties_.set_intensity(forecast_.precip_intensity);
 
-        base_display_.update_data(temperature, wind_speed, wind_direction,
-                                  sunrise_time, sunset_time, day_name, cloud_cover);
+        if (keep_effects)
+        {
+            WeatherEffectFactory::retune_effects(weather_effects_, forecast_.weather(),
+                                                 forecast_.snow_accumulation, forecast_.ice_accumulation, forecast_.cloud_cover);
+            return SegmentUpdate::kRetuned;
+        }
 
         // Clean up old weather effects
-        for (const auto &effect : weather_effects_)
+        for (auto &effect : weather_effects_)
         {
-            effect->stop();
+            std::visit([](auto &e)
+                       { e.stop(); }, effect);
         }
         weather_effects_.clear();
 
         // Create new weather effects based on current weather
-        int weather_code = get_int_value("weatherCodeDay", 10000); // Default to clear
-        std::string precip_type = get_string_value("precipitationType", "N/A");
-        float precip_intensity = get_float_value("precipitationIntensity", 0.0f);
-        float snow_accumulation = get_float_value("snowAccumulation", 0.0f);
-        float ice_accumulation = get_float_value("iceAccumulation", 0.0f);
-
-        seg_properties_.set_intensity(precip_intensity);
-
         weather_effects_ = WeatherEffectFactory::create_effects(
-            weather_code, weather_state_, seg_properties_,
-            precip_type, snow_accumulation,
-            ice_accumulation, cloud_cover);
+            forecast_.weather(), seg_properties_,
+            forecast_.snow_accumulation, forecast_.ice_accumulation, forecast_.cloud_cover);
+        set_load(load_);
+        return SegmentUpdate::kRebuilt;
     }
 
     /**
-     * @brief Draw this segment to the display
+     * @brief Scale every effect's particle limit and spawn rate, see
+     * WeatherEffectBase::set_load().
      *
-     * Rendering order:
-     * 1. Update particles (physics, spawning, cleanup)
-     * 2. Base display (sky, temperature, wind, day label)
-     * 3. Weather effects in order (clouds, precipitation, storms)
+     * @param load Share of the full particle load, 0 to 1.
      */
-    void draw_seg(pimoroni::PicoZGraphics &graphics)
+    void set_load(const float load)
     {
-
-        const uint32_t current_time = time_us_32();
-        const uint32_t delta = current_time - prev_time_;
-        seg_properties_.set_dt((delta / 1'000'000.0f));
-
-        // Update particle positions before drawing
-        uint16_t particle_count_temp = 0;
-        for (const auto &effect : weather_effects_)
+        load_ = load;
+        for (auto &effect : weather_effects_)
         {
-            effect->update_particles();
-            particle_count_temp += effect->get_particle_count();
-        }
-
-        prev_time_ = time_us_32();
-
-        particle_count_ = particle_count_temp;
-
-        // Draw base display first
-        base_display_.draw(graphics);
-
-        // Then draw each weather effect in order
-        for (const auto &effect : weather_effects_)
-        {
-            effect->draw(graphics);
+            std::visit([load](auto &e)
+                       { e.set_load(load); }, effect);
         }
     }
 
-    [[nodiscard]] const std::string &weather_state() const { return weather_state_; }
-    [[nodiscard]] uint16_t get_total_particle_count() const { return particle_count_; }
-    [[nodiscard]] RectMod seg_bounds() const { return seg_properties_.get_seg_bounds(); }
-    DisplaySegProperties &get_segment_properties() { return seg_properties_; }
+    /**
+     * @brief Some effect still has particles past its limit to retire.
+     */
+    [[nodiscard]] bool retiring() const
+    {
+        return std::any_of(weather_effects_.begin(), weather_effects_.end(), [](const WeatherEffect &effect)
+                           { return std::visit([](const auto &e)
+                                               { return e.retiring(); }, effect); });
+    }
 
-private:
-    // Helper functions to extract typed values from weather_info_
-    // Simple string to float conversion without exceptions
-    static float safe_stof(const std::string &str, float default_val)
+    /**
+     * @brief Some effect's particles haven't filled up to its limit yet.
+     */
+    [[nodiscard]] bool filling() const
     {
-        if (str.empty())
-            return default_val;
+        return std::any_of(weather_effects_.begin(), weather_effects_.end(), [](const WeatherEffect &effect)
+                           { return std::visit([](const auto &e)
+                                               { return e.filling(); }, effect); });
+    }
 
-        char *end;
-        float result = strtof(str.c_str(), &end);
+    /**
+     * @brief Step the physics by a fixed amount every frame instead of the
+     * time since the last frame, so a run doesn't depend on frame timing.
+     *
+     * @param dt Timestep in seconds, 0 to go back to the measured one.
+     */
+    void set_fixed_dt(const float dt)
+    {
+        fixed_dt_ = dt;
+    }
 
-        // If no conversion happened or string was invalid, return default
-        if (end == str.c_str() || *end != '\0')
-        {
-            return default_val;
-        }
-        return result;
+    /**
+     * @brief Carry on after a pause: the next step covers one period rather
+     * than the whole pause.
+     *
+     * @param period_us Time the next step should cover.
+     */
+    void resume_clock(const uint32_t period_us)
+    {
+        prev_time_ = time_us_32() - period_us;
     }
 
-    // Simple string to int conversion without exceptions
-    static int safe_stoi(const std::string &str, int default_val)
+    /**
+     * @brief Update particles (physics, spawning, cleanup) for this frame.
+     */
+    void update_seg()
     {
-        if (str.empty())
-            return default_val;
 
-        char *end;
-        long result = strtol(str.c_str(), &end, 10);
+        const uint32_t current_time = time_us_32();
+        const uint32_t delta = current_time - prev_time_;
+        seg_properties_.set_dt(fixed_dt_ > 0.0f ? fixed_dt_ : (delta / 1'000'000.0f));
 
-        // If no conversion happened or string was invalid, return default
-        if (end == str.c_str() || *end != '\0')
+        // Update particle positions before drawing
+        uint16_t particle_count_temp = 0;
+        for (auto &effect : weather_effects_)
         {
-            return default_val;
+            std::visit([&particle_count_temp](auto &e)
+                       {
+                           e.update_particles();
+                           particle_count_temp += e.get_particle_count();
+                       },
+                       effect);
         }
-        return static_cast<int>(result);
+
+        prev_time_ = time_us_32();
+
+        particle_count_ = particle_count_temp;
     }
 
-    float get_float_value(const std::string &key, float default_val) const
+    /**
+     * @brief Respawn every effect's particles, e.g. after gravity changes.
+     */
+    void respawn_particles()
     {
-        auto it = weather_info_.find(key);
-        if (it != weather_info_.end())
+        for (auto &effect : weather_effects_)
         {
-            return safe_stof(it->second, default_val);
+            std::visit([](auto &e)
+                       { e.respawn(); }, effect);
         }
-        return default_val;
     }
 
-    int get_int_value(const std::string &key, int default_val) const
+    /**
+     * @brief Record this segment's drawing for the frame.
+     *
+     * Rendering order:
+     * 1. Base display (sky, temperature, wind, day label)
+     * 2. Weather effects in order (clouds, precipitation, storms)
+     *
+     * @param list Draw list to record into.
+     */
+    void draw_seg(DrawList &list)
     {
-        auto it = weather_info_.find(key);
-        if (it != weather_info_.end())
+        // Draw base display first
+        base_display_.draw(list);
+
+        // Then draw each weather effect in order
+        for (auto &effect : weather_effects_)
         {
-            return safe_stoi(it->second, default_val);
+            std::visit([&list](auto &e)
+                       { e.draw(list); }, effect);
         }
-        return default_val;
     }
 
-    std::string get_string_value(const std::string &key, const std::string &default_val) const
-    {
-        auto it = weather_info_.find(key);
-        return (it != weather_info_.end()) ? it->second : default_val;
-    }
+    [[nodiscard]] std::string_view weather_state() const { return forecast_.weather().description; }
+    [[nodiscard]] const DayForecast &forecast() const { return forecast_; }
+    [[nodiscard]] uint16_t get_total_particle_count() const { return particle_count_; }
+    [[nodiscard]] RectMod seg_bounds() const { return seg_properties_.get_seg_bounds(); }
+    DisplaySegProperties &get_segment_properties() { return seg_properties_; }
 };
 
 #endif // DISPLAY_SEGMENT_H
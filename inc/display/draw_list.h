@@ -0,0 +1,193 @@
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+#include "z_buffer.h"
+
+#include <array>
+
+/**
+ * @brief Primitive types a draw list can hold.
+ */
+enum class DrawOp : uint8_t
+{
+    kPixel, // Single pixel at (x0, y0).
+    kLine,  // Line from (x0, y0) to (x1, y1).
+    kRect,  // Filled rectangle at (x0, y0), x1 wide and y1 tall.
+    kClip,  // Clip following streaks to the rectangle at (x0, y0), x1 wide and y1 tall.
+    kStreak, // Short depth-tested line from (x0, y0) to (x1, y1), clipped to the last kClip.
+    kPoints  // Batch of x1 points starting at index x0 of the point buffer.
+};
+
+/**
+ * @brief One recorded primitive, with its pen and depth baked in.
+ */
+struct DrawCommand
+{
+    DrawOp op;
+    uint8_t depth;
+    int16_t x0, y0;
+    int16_t x1, y1;
+    uint32_t color;
+};
+
+/**
+ * @brief A frame's worth of drawing, recorded up front and rasterised later.
+ *
+ * Effects record their primitives into a draw list instead of touching the
+ * framebuffer directly. Once a list is handed over for rendering it is treated
+ * as immutable, which lets one core simulate and record the next frame while
+ * the other rasterises this one. Storage is fixed, so recording never allocates;
+ * commands beyond capacity are dropped and counted.
+ */
+class DrawList
+{
+public:
+    static constexpr uint16_t kMaxCommands = 2048;
+    static constexpr uint16_t kMaxPoints = 2048;
+
+private:
+    std::array<DrawCommand, kMaxCommands> commands_;
+    std::array<pimoroni::DepthPoint, kMaxPoints> points_; // Points for every kPoints batch.
+    uint16_t count_ = 0;                                  // Commands recorded this frame.
+    uint16_t point_count_ = 0;                            // Points recorded this frame.
+    uint16_t dropped_ = 0;                                // Commands and points that did not fit this frame.
+    DrawCommand *batch_ = nullptr;                        // Points batch being added to, if any.
+
+    bool push(const DrawCommand &command)
+    {
+        batch_ = nullptr;
+        if (count_ >= kMaxCommands)
+        {
+            dropped_++;
+            return false;
+        }
+        commands_[count_++] = command;
+        return true;
+    }
+
+public:
+    /**
+     * @brief Empty the list, ready to record a new frame.
+     */
+    void reset()
+    {
+        count_ = 0;
+        point_count_ = 0;
+        dropped_ = 0;
+        batch_ = nullptr;
+    }
+
+    void add_pixel(const pimoroni::Point &p, const uint32_t color, const uint8_t depth)
+    {
+        push({DrawOp::kPixel, depth, static_cast<int16_t>(p.x), static_cast<int16_t>(p.y), 0, 0, color});
+    }
+
+    void add_line(const pimoroni::Point &start, const pimoroni::Point &end, const uint32_t color, const uint8_t depth)
+    {
+        push({DrawOp::kLine, depth, static_cast<int16_t>(start.x), static_cast<int16_t>(start.y),
+              static_cast<int16_t>(end.x), static_cast<int16_t>(end.y), color});
+    }
+
+    void add_rect(const pimoroni::Rect &rect, const uint32_t color, const uint8_t depth)
+    {
+        push({DrawOp::kRect, depth, static_cast<int16_t>(rect.x), static_cast<int16_t>(rect.y),
+              static_cast<int16_t>(rect.w), static_cast<int16_t>(rect.h), color});
+    }
+
+    /**
+     * @brief Clip every streak and point recorded after this to a rectangle, usually the
+     * bounds of the segment being drawn.
+     */
+    void set_clip(const pimoroni::Rect &rect)
+    {
+        push({DrawOp::kClip, 0, static_cast<int16_t>(rect.x), static_cast<int16_t>(rect.y),
+              static_cast<int16_t>(rect.w), static_cast<int16_t>(rect.h), 0});
+    }
+
+    void add_streak(const pimoroni::Point &start, const pimoroni::Point &end, const uint32_t color, const uint8_t depth)
+    {
+        push({DrawOp::kStreak, depth, static_cast<int16_t>(start.x), static_cast<int16_t>(start.y),
+              static_cast<int16_t>(end.x), static_cast<int16_t>(end.y), color});
+    }
+
+    /**
+     * @brief Start a batch of points. Points added with add_point() belong to
+     * this batch until the next command is recorded.
+     */
+    void begin_points()
+    {
+        if (push({DrawOp::kPoints, 0, static_cast<int16_t>(point_count_), 0, 0, 0, 0}))
+        {
+            batch_ = &commands_[count_ - 1];
+        }
+    }
+
+    /**
+     * @brief Add a point to the current batch.
+     *
+     * @param p Position. Points outside the clip are dropped when rendered.
+     * @param pixel Depth and color packed as 0xDDRRGGBB.
+     */
+    void add_point(const pimoroni::Point &p, const uint32_t pixel)
+    {
+        if (batch_ == nullptr || point_count_ >= kMaxPoints)
+        {
+            dropped_++;
+            return;
+        }
+        points_[point_count_++] = {static_cast<int16_t>(p.x), static_cast<int16_t>(p.y), pixel};
+        batch_->x1++;
+    }
+
+    /**
+     * @brief Rasterise every recorded command, in order, into the framebuffer.
+     *
+     * @param graphics The framebuffer to draw into.
+     */
+    void render(pimoroni::PicoZGraphics &graphics) const
+    {
+        RectMod clip(graphics.bounds.x, graphics.bounds.y, graphics.bounds.w, graphics.bounds.h);
+
+        for (uint16_t i = 0; i < count_; i++)
+        {
+            const DrawCommand &command = commands_[i];
+            graphics.set_pen(command.color);
+            graphics.set_depth(command.depth);
+
+            switch (command.op)
+            {
+            case DrawOp::kPixel:
+                graphics.set_pixel(pimoroni::Point(command.x0, command.y0));
+                break;
+
+            case DrawOp::kLine:
+                graphics.line(pimoroni::Point(command.x0, command.y0), pimoroni::Point(command.x1, command.y1));
+                break;
+
+            case DrawOp::kRect:
+                graphics.rectangle(pimoroni::Rect(command.x0, command.y0, command.x1, command.y1));
+                break;
+
+            case DrawOp::kClip:
+            {
+                const pimoroni::Rect r = pimoroni::Rect(command.x0, command.y0, command.x1, command.y1).intersection(graphics.bounds);
+                clip = RectMod(r.x, r.y, r.w, r.h);
+                break;
+            }
+
+            case DrawOp::kStreak:
+                graphics.draw_streak(pimoroni::Point(command.x0, command.y0), pimoroni::Point(command.x1, command.y1), clip);
+                break;
+
+            case DrawOp::kPoints:
+                graphics.draw_points(&points_[command.x0], command.x1, clip);
+                break;
+            }
+        }
+    }
+
+    [[nodiscard]] uint16_t size() const { return count_; }
+    [[nodiscard]] uint16_t dropped() const { return dropped_; }
+};
+
+#endif // DRAW_LIST_H
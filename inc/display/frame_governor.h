@@ -0,0 +1,112 @@
+#ifndef FRAME_GOVERNOR_H
+#define FRAME_GOVERNOR_H
+
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @brief Holds the target FPS by scaling the particle load.
+ *
+ * Each frame's work, everything but the wait for the frame period, is
+ * smoothed and compared with the period. Work over kCutAbove of it for
+ * kCutAfterFrames frames in a row cuts the load, in proportion, to where the
+ * work would come to kCutTo of the period, and by at least kCutFactor. Work
+ * under kRaiseBelow of it for kRaiseAfterFrames in a row raises it by
+ * kRaiseFactor. The gap between the two, and raising in small steps and more
+ * slowly than cutting, is the hysteresis: a load that fits stays put.
+ *
+ * A change takes a while to show in the work, as particles past a lowered
+ * limit are retired as they leave and a raised limit fills a particle a
+ * frame. So the load isn't cut again while particles are still being
+ * retired, nor raised while the pools are still filling. Falling snow can
+ * take many seconds to leave, hence the single proportional cut rather than
+ * a run of small ones.
+ */
+class FrameGovernor
+{
+public:
+    static constexpr float kMinLoad = 0.2f;            // Never thin the particles further than this.
+    static constexpr float kCutAbove = 0.9f;           // Share of the frame period work may use before the load is cut.
+    static constexpr float kRaiseBelow = 0.7f;         // Share of the frame period under which the load is raised.
+    static constexpr float kCutTo = 0.8f;              // Share of the frame period a cut aims the work at.
+    static constexpr float kCutFactor = 0.85f;         // Most load kept by a cut.
+    static constexpr float kRaiseFactor = 1.1f;        // Load gained by a raise.
+    static constexpr uint16_t kCutAfterFrames = 8;     // Frames over budget before a cut.
+    static constexpr uint16_t kRaiseAfterFrames = 75;  // Frames under budget before a raise.
+    static constexpr float kSmoothing = 0.2f;          // Weight of a new frame in the smoothed work.
+
+private:
+    bool enabled_ = true;
+    float load_ = 1.0f;          // Share of the full particle load in use.
+    float work_us_ = 0.0f;       // Smoothed work per frame.
+    uint16_t over_ = 0;          // Frames in a row over kCutAbove.
+    uint16_t under_ = 0;         // Frames in a row under kRaiseBelow.
+    uint32_t frames_ = 0;        // Frames governed since boot.
+    uint32_t misses_ = 0;        // Of those, frames whose work overran the period.
+    uint32_t cuts_ = 0;
+    uint32_t raises_ = 0;
+
+public:
+    /**
+     * @brief Account for a frame and adjust the load.
+     *
+     * @param work_us Time the frame took before waiting for the period.
+     * @param period_us Frame period.
+     * @param retiring Particles past a lowered limit are still on screen.
+     * @param filling Particles haven't yet filled a raised limit.
+     * @return true if the load changed.
+     */
+    bool update(const uint32_t work_us, const uint32_t period_us, const bool retiring, const bool filling)
+    {
+        frames_++;
+        misses_ += work_us > period_us;
+        work_us_ = frames_ == 1 ? work_us : work_us_ + kSmoothing * (work_us - work_us_);
+
+        const float used = work_us_ / period_us;
+        over_ = used > kCutAbove ? over_ + 1 : 0;
+        under_ = used < kRaiseBelow ? under_ + 1 : 0;
+        if (!enabled_)
+        {
+            return false;
+        }
+
+        if (over_ >= kCutAfterFrames && !retiring && load_ > kMinLoad)
+        {
+            load_ = std::max(kMinLoad, load_ * std::min(kCutFactor, kCutTo / used));
+            over_ = 0;
+            cuts_++;
+            return true;
+        }
+        if (under_ >= kRaiseAfterFrames && !filling && load_ < 1.0f)
+        {
+            load_ = std::min(1.0f, load_ * kRaiseFactor);
+            under_ = 0;
+            raises_++;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Scale the particles to hold the frame rate, or go back to the
+     * full load and leave it there.
+     */
+    void set_enabled(const bool enabled)
+    {
+        enabled_ = enabled;
+        if (!enabled_)
+        {
+            load_ = 1.0f;
+        }
+    }
+
+    [[nodiscard]] bool enabled() const { return enabled_; }
+    [[nodiscard]] float load() const { return load_; }
+    [[nodiscard]] float work_us() const { return work_us_; }
+    [[nodiscard]] uint32_t frames() const { return frames_; }
+    [[nodiscard]] uint32_t misses() const { return misses_; }
+    [[nodiscard]] uint32_t cuts() const { return cuts_; }
+    [[nodiscard]] uint32_t raises() const { return raises_; }
+};
+
+#endif // FRAME_GOVERNOR_H
@@ -0,0 +1,104 @@
+#ifndef IDLE_MODE_H
+#define IDLE_MODE_H
+
+#include "pico/time.h"
+
+#include <array>
+#include <cstdint>
+
+/**
+ * @brief Power states the display runs in.
+ */
+enum class PowerState : uint8_t
+{
+    kActive, // Animating at the target FPS.
+    kIdle,   // Holding the last frame at a lower clock, the simulation paused.
+};
+
+/**
+ * @brief Decides when the display idles, and keeps the time spent in each
+ * power state.
+ *
+ * The display idles once the room has been dark with nobody near for
+ * kIdleAfterMs, and wakes on the first update that finds either has
+ * changed. It is checked once a frame period in both states, so waking takes
+ * at most a frame once the sensor has seen someone.
+ */
+class IdleMode
+{
+public:
+    static constexpr uint32_t kIdleAfterMs = 30'000;  // Dark and empty for this long before idling.
+    static constexpr uint32_t kIdleClockKhz = 96'000; // clk_sys while idle.
+
+private:
+    bool enabled_ = true;
+    PowerState state_ = PowerState::kActive;
+    bool quiet_ = false;                  // Dark and nobody near at the last update.
+    uint32_t quiet_since_us_ = 0;         // When it went quiet.
+    uint32_t last_us_ = time_us_32();     // Last update, time up to it is counted.
+    std::array<uint64_t, 2> state_us_{};  // Time spent in each state.
+    uint32_t wakes_ = 0;                  // Times woken from idle.
+
+public:
+    /**
+     * @brief Count the time since the last update and move between states.
+     *
+     * @param near Someone is near the sensor.
+     * @param dark The room is at the panel's lowest brightness.
+     * @return true if the state changed.
+     */
+    bool update(const bool near, const bool dark)
+    {
+        const uint32_t now = time_us_32();
+        state_us_[static_cast<uint8_t>(state_)] += now - last_us_;
+        last_us_ = now;
+
+        if (!enabled_ || near || !dark)
+        {
+            quiet_ = false;
+            if (state_ == PowerState::kIdle)
+            {
+                state_ = PowerState::kActive;
+                wakes_++;
+                return true;
+            }
+            return false;
+        }
+
+        if (!quiet_)
+        {
+            quiet_ = true;
+            quiet_since_us_ = now;
+        }
+        if (state_ == PowerState::kActive && now - quiet_since_us_ >= kIdleAfterMs * 1000)
+        {
+            state_ = PowerState::kIdle;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Allow idling or not. Disabling wakes the display at the next update.
+     */
+    void set_enabled(const bool enabled) { enabled_ = enabled; }
+
+    [[nodiscard]] bool enabled() const { return enabled_; }
+    [[nodiscard]] PowerState state() const { return state_; }
+    [[nodiscard]] uint32_t wakes() const { return wakes_; }
+
+    /**
+     * @brief Time spent in a power state since boot, in s.
+     */
+    [[nodiscard]] float seconds_in(const PowerState state) const
+    {
+        return state_us_[static_cast<uint8_t>(state)] / 1e6f;
+    }
+
+    [[nodiscard]] static const char *state_name(const PowerState state)
+    {
+        return state == PowerState::kActive ? "active" : "idle";
+    }
+};
+
+#endif // IDLE_MODE_H
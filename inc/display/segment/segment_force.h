@@ -8,6 +8,8 @@
 #include "dsp/controller_functions.h"
 #include "segment_geometry.h"
 
+#include <vector>
+
 class Force
 	{
 protected:
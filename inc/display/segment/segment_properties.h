@@ -7,6 +7,8 @@
 #include "particles/particle_properties.h"
 #include "helpers_rand.h"
 
+#include <vector>
+
 class DisplaySegProperties
 	{
 
@@ -61,7 +63,12 @@ public:
 	 */
 	[[nodiscard]] bool is_particle_oob(const Position &position) const
 	{
-		return !oob_limits_.contains(pimoroni::Point(position.x, position.y));
+		return is_particle_oob(pimoroni::Point(position.x, position.y));
+	}
+
+	[[nodiscard]] bool is_particle_oob(const pimoroni::Point &pixel) const
+	{
+		return !oob_limits_.contains(pixel);
 	}
 
 	/**
@@ -72,7 +79,12 @@ public:
 	 */
 	[[nodiscard]] bool is_particle_in_segment(const Position &position) const
 	{
-		return seg_bounds_.contains_inclusive(pimoroni::Point(position.x, position.y));
+		return is_particle_in_segment(pimoroni::Point(position.x, position.y));
+	}
+
+	[[nodiscard]] bool is_particle_in_segment(const pimoroni::Point &pixel) const
+	{
+		return seg_bounds_.contains_inclusive(pixel);
 	}
 
 	/**
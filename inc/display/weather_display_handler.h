@@ -2,21 +2,57 @@
 #define WEATHER_DISPLAY_HANDLER_H
 
 #include "AP3216_WE.h"
+#include "ambient_light.h"
+#include "idle_mode.h"
+#include "frame_governor.h"
 #include "z_buffer.h"
 #include "display_segment.h"
+#include "draw_list.h"
+#include "core1_worker.h"
 
 #include "libraries/interstate75/interstate75.hpp"
 
+#include "hardware/clocks.h"
 #include "pico/multicore.h"
 #include "pico/time.h"
 
+#include <array>
 #include <vector>
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <algorithm>
 #include <cmath>
 
-uint8_t global_brightness = 3;
+/**
+ * @brief How a frame is split between the two cores.
+ */
+enum class RenderMode : uint8_t
+{
+    kSerial,       // Core 0 simulates and rasterises each frame in turn.
+    kPipelined,    // Core 0 simulates frame N + 1 while core 1 rasterises frame N.
+    kSplitSegments, // Segments are shared out between the cores, each core simulating and drawing its own.
+    kDoubleBuffered // Core 0 draws into the back framebuffer while core 1 sends the front one to the panel.
+};
+
+/**
+ * @brief Get a printable name for a render mode.
+ */
+inline const char *render_mode_name(const RenderMode mode)
+{
+    switch (mode)
+    {
+    case RenderMode::kPipelined:
+        return "pipelined";
+    case RenderMode::kSplitSegments:
+        return "split segments";
+    case RenderMode::kDoubleBuffered:
+        return "double buffered";
+    default:
+        return "serial";
+    }
+}
 
 /**
  * @brief Main weather display handler that manages all segments
@@ -34,8 +70,13 @@ private:
     pimoroni::PicoZGraphics &graphics_;           // The framebuffer instance.
     pimoroni::Hub75 &i75_;                        // The HUB75 object instance.
     AP3216_WE lux_meter_;                         // The lux meter add-on, detects brightness of room to dim or brighten display.
+    AmbientLight ambient_light_{lux_meter_};      // Samples the lux meter on a timer, off the frame path.
+    IdleMode idle_;                               // Idles the display in a dark, empty room.
+    uint32_t active_clock_khz_ = 0;               // clk_sys to go back to on waking.
+    FrameGovernor governor_;                      // Scales the particle load to hold the target FPS.
     uint32_t prev_time_ = 0;                      // Previous time clocked in us.
     float fps_target_;                            // FPS target.
+    bool fixed_timestep_ = false;                 // Step physics by the frame period instead of the measured frame time.
     float fps_period_;                            // FPS period in s.
     uint32_t fps_period_us_;                      // FPS period in us.
     uint16_t width_;                              // Width of display.
@@ -44,10 +85,264 @@ private:
     uint8_t num_days_;                            // Number of days to generate.
     std::vector<DisplaySegment> segment_display_; // Stores each display segment.
     std::vector<uint16_t> frame_points_;          // X coordinates where frame dividers are drawn
+    std::unique_ptr<DrawList[]> draw_lists_;      // Two draw lists, one being recorded while the other renders.
+    uint8_t back_list_ = 0;                       // Index of the draw list being recorded.
+    RenderMode render_mode_ = RenderMode::kSerial; // How frames are split between the cores.
+    uint32_t simulate_us_ = 0;                    // Time spent simulating and recording the last frame.
+    uint32_t render_us_ = 0;                      // Time spent rasterising and sending the last rendered frame.
+    uint32_t frame_us_ = 0;                       // Wall time of the last frame, including the wait for the frame period.
+    std::array<uint32_t, 2> core_busy_us_{};      // Time each core spent working on the last frame.
+    pimoroni::PicoZGraphics core1_graphics_;      // Core 1's pen and depth state, drawing into the same framebuffer.
+    std::vector<uint32_t> segment_cost_us_;       // Smoothed time each segment takes to update and draw.
+    std::vector<uint8_t> segment_core_;           // Core each segment is assigned to in split mode.
+    std::vector<uint8_t> segment_order_;          // Scratch space for balance_segments(), most expensive segment first.
+    std::unique_ptr<uint32_t[]> second_buffer_;   // Pixels of the second framebuffer. PicoGraphics never frees a buffer it allocates, so the handler owns it.
+    std::unique_ptr<pimoroni::PicoZGraphics> second_graphics_; // Second framebuffer, allocated on first use of double buffering.
+    std::array<pimoroni::PicoZGraphics *, 2> framebuffers_{}; // Framebuffers swapped between in double buffered mode.
+    uint8_t back_buffer_ = 0;                     // Index of the framebuffer being drawn into.
+    uint32_t panel_us_ = 0;                       // Time core 1 spent sending the last framebuffer to the panel.
+    uint32_t panel_wait_us_ = 0;                  // Time core 0 spent waiting for that to finish.
+    uint32_t pixels_cleared_ = 0;                 // Pixels cleared at the start of the last frame.
+    uint32_t full_clears_ = 0;                    // Frames where clearing fell back to the whole framebuffer.
+
+    /**
+     * @brief Clear the parts of a framebuffer written last frame, and count them.
+     */
+    void clear_framebuffer(pimoroni::PicoZGraphics &graphics)
+    {
+        graphics.clear_framebuffer();
+        pixels_cleared_ = graphics.get_pixels_cleared();
+        full_clears_ += graphics.was_last_clear_full();
+    }
+
+    /**
+     * @brief A frame handed to core 1 for rendering. Only one is in flight at a time.
+     */
+    struct RenderJob
+    {
+        WeatherDisplayHandler *handler;
+        const DrawList *list;
+        uint32_t elapsed_us; // Filled in by core 1.
+    } render_job_{};
+
+    /**
+     * @brief Rasterise a recorded frame and push it to the panel.
+     *
+     * @param list The frame to draw.
+     * @return uint32_t Time taken in us.
+     */
+    uint32_t render_frame(const DrawList &list)
+    {
+        const uint32_t start = time_us_32();
+        clear_framebuffer(graphics_);
+        list.render(graphics_);
+        i75_.update(&graphics_);
+        return time_us_32() - start;
+    }
+
+    /**
+     * @brief A framebuffer handed to core 1 to be sent to the panel.
+     */
+    struct PanelJob
+    {
+        pimoroni::Hub75 *i75;
+        pimoroni::PicoZGraphics *graphics;
+        uint32_t elapsed_us; // Filled in by core 1.
+    } panel_job_{};
+
+    /**
+     * @brief Core 1 entry point for sending a finished framebuffer to the panel.
+     */
+    static void panel_job(void *arg)
+    {
+        auto *job = static_cast<PanelJob *>(arg);
+        const uint32_t start = time_us_32();
+        job->i75->update(job->graphics);
+        job->elapsed_us = time_us_32() - start;
+    }
+
+    /**
+     * @brief Draw a recorded frame into the back framebuffer, then swap it to
+     * the front and have core 1 send it to the panel while the next frame is
+     * drawn. Only waits on core 1 if it is still busy with the previous frame.
+     *
+     * @param list The frame to draw.
+     */
+    void double_buffered_frame(const DrawList &list)
+    {
+        pimoroni::PicoZGraphics &back = *framebuffers_[back_buffer_];
+
+        const uint32_t render_start = time_us_32();
+        clear_framebuffer(back);
+        list.render(back);
+        render_us_ = time_us_32() - render_start;
+
+        const uint32_t wait_start = time_us_32();
+        if (Core1Worker::job_pending())
+        {
+            Core1Worker::wait();
+            panel_us_ = panel_job_.elapsed_us;
+        }
+        panel_wait_us_ = time_us_32() - wait_start;
+
+        panel_job_ = {&i75_, &back, 0};
+        Core1Worker::submit(panel_job, &panel_job_);
+        back_buffer_ ^= 1;
+
+        core_busy_us_ = {simulate_us_ + render_us_ + panel_wait_us_, panel_us_};
+    }
+
+    /**
+     * @brief Core 1 entry point for a pipelined frame.
+     */
+    static void render_job(void *arg)
+    {
+        auto *job = static_cast<RenderJob *>(arg);
+        job->elapsed_us = job->handler->render_frame(*job->list);
+    }
+
+    /**
+     * @brief Update and draw the segments assigned to one core, timing each one.
+     * Segments have disjoint bounds, so both cores can draw into the framebuffer
+     * at once as long as each uses its own graphics state.
+     *
+     * @param core Core whose segments to run.
+     * @param list Draw list owned by this core.
+     * @param graphics Graphics state owned by this core.
+     * @return uint32_t Time taken in us.
+     */
+    uint32_t run_segments(const uint8_t core, DrawList &list, pimoroni::PicoZGraphics &graphics)
+    {
+        const uint32_t start = time_us_32();
+        for (size_t i = 0; i < segment_display_.size(); i++)
+        {
+            if (segment_core_[i] != core)
+            {
+                continue;
+            }
+
+            const uint32_t segment_start = time_us_32();
+            list.reset();
+            segment_display_[i].update_seg();
+            segment_display_[i].draw_seg(list);
+            list.render(graphics);
+
+            // Smooth the cost so a single slow frame (a lightning flash) doesn't move segments around.
+            const uint32_t elapsed = time_us_32() - segment_start;
+            segment_cost_us_[i] = (segment_cost_us_[i] * 3 + elapsed) / 4;
+        }
+        return time_us_32() - start;
+    }
+
+    /**
+     * @brief Core 1 entry point for a split segment frame.
+     */
+    static void segment_job(void *arg)
+    {
+        auto *handler = static_cast<WeatherDisplayHandler *>(arg);
+        handler->core_busy_us_[1] = handler->run_segments(1, handler->draw_lists_[1], handler->core1_graphics_);
+    }
+
+    /**
+     * @brief Assign segments to cores from their measured cost. Segments are
+     * placed most expensive first onto whichever core has the least work so far.
+     * Core 0 starts with the frame overhead it always carries (clearing, dividers
+     * and the panel update).
+     *
+     * @param core0_overhead_us Time core 0 spends on work outside the segments.
+     */
+    void balance_segments(const uint32_t core0_overhead_us)
+    {
+        std::sort(segment_order_.begin(), segment_order_.end(),
+                  [this](uint8_t a, uint8_t b)
+                  {
+                      return segment_cost_us_[a] > segment_cost_us_[b];
+                  });
+
+        std::array<uint32_t, 2> load = {core0_overhead_us, 0};
+        for (const uint8_t segment : segment_order_)
+        {
+            const uint8_t core = load[0] <= load[1] ? 0 : 1;
+            segment_core_[segment] = core;
+            load[core] += segment_cost_us_[segment];
+        }
+    }
+
+    /**
+     * @brief Draw a frame with the segments shared out between both cores.
+     */
+    void split_frame()
+    {
+        const uint32_t start = time_us_32();
+
+        // Each core's graphics tracks what it drew, so both need clearing.
+        clear_framebuffer(graphics_);
+        const uint32_t core0_cleared = pixels_cleared_;
+        clear_framebuffer(core1_graphics_);
+        pixels_cleared_ += core0_cleared;
+
+        // Draw frame dividers, these sit between segments so neither core draws over them.
+        graphics_.set_pen(pen_white);
+        graphics_.set_depth((uint8_t)255);
+        for (int point : frame_points_)
+        {
+            graphics_.line(pimoroni::Point(point, 0), pimoroni::Point(point, height_));
+        }
+
+        Core1Worker::submit(segment_job, this);
+        const uint32_t overhead_start = time_us_32();
+        const uint32_t core0_segments_us = run_segments(0, draw_lists_[0], graphics_);
+        Core1Worker::wait();
+
+        const uint32_t update_start = time_us_32();
+        i75_.update(&graphics_);
+        const uint32_t end = time_us_32();
+
+        core_busy_us_[0] = end - start;
+        simulate_us_ = core0_segments_us;
+        render_us_ = end - update_start;
+
+        uint16_t total_particles = 0;
+        for (auto &segment : segment_display_)
+        {
+            total_particles += segment.get_total_particle_count();
+        }
+        total_particle_count_ = total_particles;
+
+        balance_segments((overhead_start - start) + (end - update_start));
+    }
+
+    /**
+     * @brief Step the simulation and record the next frame.
+     *
+     * @param list Draw list to record into.
+     */
+    void record_frame(DrawList &list)
+    {
+        list.reset();
+
+        // Draw frame dividers
+        for (int point : frame_points_)
+        {
+            list.add_line(pimoroni::Point(point, 0), pimoroni::Point(point, height_), pen_white, 255);
+        }
+
+        uint16_t total_particles = 0;
+        for (auto &segment : segment_display_)
+        {
+            segment.update_seg();
+            segment.draw_seg(list);
+            total_particles += segment.get_total_particle_count();
+        }
+
+        total_particle_count_ = total_particles;
+    }
 
 public:
     WeatherDisplayHandler(pimoroni::PicoZGraphics &graphics, pimoroni::Hub75 &i75, uint8_t num_days, const float target_fps)
-        : graphics_(graphics), i75_(i75), width_(graphics.bounds.w), height_(graphics.bounds.h), num_days_(num_days), fps_target_(target_fps)
+        : graphics_(graphics), i75_(i75), width_(graphics.bounds.w), height_(graphics.bounds.h), num_days_(num_days), fps_target_(target_fps),
+          draw_lists_(std::make_unique<DrawList[]>(2)),
+          core1_graphics_(graphics.bounds.w, graphics.bounds.h, graphics.frame_buffer)
     {
         printf("Display width: %d, Days: %d\n", width_, num_days);
 
@@ -55,10 +350,19 @@ public:
         prev_time_ = time_us_32();
 
         segment_display_.reserve(num_days);
+        segment_cost_us_.assign(num_days, 0);
+        segment_core_.resize(num_days);
+        segment_order_.resize(num_days);
+        for (uint8_t i = 0; i < num_days; i++)
+        {
+            segment_core_[i] = i % 2;
+            segment_order_[i] = i;
+        }
 
-        lux_meter_.init(i2c0);          // initialize the lux sensor
-        lux_meter_.setMode(AP3216_ALS); // We only care about the ambient light mode.
+        lux_meter_.init(i2c0);             // initialize the lux sensor
+        lux_meter_.setMode(AP3216_ALS_PS); // Light for the brightness, proximity for idling.
         lux_meter_.setLuxRange(RANGE_323);
+        ambient_light_.start(AmbientLight::Mode::kThresholds, pimoroni::I2C_DEFAULT_INT);
 
         uint16_t base_width = width_ / num_days; // Calculate segment widths
         uint16_t remainder = width_ % num_days;
@@ -167,15 +471,38 @@ public:
     /**
      * @brief Update weather data for all segments
      *
-     * @param weather_data Map containing weather intervals data
+     * Only the days that changed are touched, and only those whose weather
+     * needs different effects restart them (see DisplaySegment::update_state()),
+     * so a refresh that brings the same forecast costs next to nothing.
+     *
+     * @param forecast One entry per day, from today
+     * @param rebuild Restart every segment's effects, changed or not
+     * @return Number of segments whose effects were rebuilt
      */
-    void update_weather(const std::vector<std::map<std::string, std::string>> &weather_intervals)
+    uint8_t update_weather(const std::span<const DayForecast> forecast, const bool rebuild = false)
     {
-        for (size_t i = 0; i < weather_intervals.size() && i < segment_display_.size(); ++i)
+        uint8_t rebuilt = 0;
+        for (size_t i = 0; i < forecast.size() && i < segment_display_.size(); ++i)
         {
-            segment_display_[i].update_state(weather_intervals[i]);
-            printf("  Day %zu: %s\n", i + 1, segment_display_[i].weather_state().c_str());
+            const SegmentUpdate update = segment_display_[i].update_state(forecast[i], rebuild);
+            rebuilt += update == SegmentUpdate::kRebuilt;
+            const std::string_view state = segment_display_[i].weather_state();
+            const char *note = update == SegmentUpdate::kUnchanged ? " (unchanged)"
+                               : update == SegmentUpdate::kRetuned ? " (retuned)"
+                                                                    : "";
+            printf("  Day %zu: %.*s%s\n", i + 1, static_cast<int>(state.size()), state.data(), note);
         }
+        return rebuilt;
+    }
+
+    /**
+     * @brief The forecast a segment is showing.
+     *
+     * @param day Segment index, from 0.
+     */
+    [[nodiscard]] const DayForecast &get_forecast(const uint8_t day) const
+    {
+        return segment_display_[day].forecast();
     }
 
     /**
@@ -197,11 +524,28 @@ public:
     {
         fps_period_us_ = roundf((1.0f / (fps_target)) * 1'000'000.0f);
         fps_period_ = (1.0f / fps_target);
+        set_fixed_timestep(fixed_timestep_);
+    }
+
+    /**
+     * @brief Step the physics of every segment by exactly one frame period,
+     * however long frames actually take. Together with a fixed RNG seed this
+     * makes every run of a forecast draw the same frames.
+     *
+     * @param enabled True for a fixed timestep, false to use the measured one.
+     */
+    void set_fixed_timestep(const bool enabled)
+    {
+        fixed_timestep_ = enabled;
+        for (auto &segment : segment_display_)
+        {
+            segment.set_fixed_dt(enabled ? fps_period_ : 0.0f);
+        }
     }
 
     /**
      * @brief Set the magnitude of gravity of all segments to a different
-     * value.
+     * value. Every particle is respawned so none keep the old gravity's drag.
      *
      * @param gravity float, can be any number.
      */
@@ -210,57 +554,322 @@ public:
         for (auto &segment : segment_display_)
         {
             segment.seg_properties_.gravity_.set_magnitude(gravity);
+            segment.respawn_particles();
+        }
+    }
+
+    /**
+     * @brief Change how frames are split between the cores. Any frame still
+     * rendering on core 1 is finished first.
+     *
+     * @param mode The new render mode.
+     */
+    void set_render_mode(const RenderMode mode)
+    {
+        Core1Worker::wait();
+
+        if (mode == RenderMode::kDoubleBuffered && !second_graphics_)
+        {
+            second_buffer_ = std::make_unique<uint32_t[]>(width_ * height_);
+            second_graphics_ = std::make_unique<pimoroni::PicoZGraphics>(width_, height_, second_buffer_.get());
+            framebuffers_ = {&graphics_, second_graphics_.get()};
         }
+
+        // Core 1's particles from the last split frame are still in the shared
+        // framebuffer, depth and all, and only its graphics knows where.
+        if (render_mode_ == RenderMode::kSplitSegments && mode != RenderMode::kSplitSegments)
+        {
+            core1_graphics_.clear_framebuffer();
+        }
+
+        render_mode_ = mode;
+    }
+
+    [[nodiscard]] RenderMode get_render_mode() const { return render_mode_; }
+    [[nodiscard]] bool get_fixed_timestep() const { return fixed_timestep_; }
+    [[nodiscard]] float get_fps_target() const { return 1.0f / fps_period_; }
+
+    /**
+     * @brief The framebuffer holding the last frame drawn in serial mode.
+     */
+    [[nodiscard]] const pimoroni::PicoZGraphics &get_graphics() const { return graphics_; }
+
+    /**
+     * @brief Get the time spent simulating and recording the last frame, in us.
+     */
+    [[nodiscard]] uint32_t get_simulate_us() const { return simulate_us_; }
+
+    /**
+     * @brief Get the time spent rasterising and sending the last rendered frame, in us.
+     */
+    [[nodiscard]] uint32_t get_render_us() const { return render_us_; }
+
+    /**
+     * @brief Get how busy a core was over the last frame.
+     *
+     * @param core Core 0 or 1.
+     * @return float Percentage of the frame the core spent working.
+     */
+    [[nodiscard]] float get_core_utilisation(const uint8_t core) const
+    {
+        return frame_us_ ? (100.0f * core_busy_us_[core]) / frame_us_ : 0.0f;
+    }
+
+    /**
+     * @brief Get the core a segment is drawn on in split segment mode.
+     */
+    [[nodiscard]] uint8_t get_segment_core(const uint8_t segment) const { return segment_core_[segment]; }
+
+    /**
+     * @brief Get the smoothed time a segment takes to update and draw, in us.
+     * Only measured in split segment mode.
+     */
+    [[nodiscard]] uint32_t get_segment_cost_us(const uint8_t segment) const { return segment_cost_us_[segment]; }
+
+    [[nodiscard]] uint8_t get_num_segments() const { return segment_display_.size(); }
+
+    /**
+     * @brief Get the number of pixels cleared at the start of the last frame.
+     */
+    [[nodiscard]] uint32_t get_pixels_cleared() const { return pixels_cleared_; }
+
+    /**
+     * @brief Get the number of frames where clearing fell back to the whole
+     * framebuffer, since the count was last reset.
+     */
+    [[nodiscard]] uint32_t get_full_clears() const { return full_clears_; }
+
+    void reset_full_clears() { full_clears_ = 0; }
+
+    /**
+     * @brief Get the time core 1 spent sending the last framebuffer to the panel,
+     * in us. Only measured in double buffered mode.
+     */
+    [[nodiscard]] uint32_t get_panel_us() const { return panel_us_; }
+
+    /**
+     * @brief Get how much frame time double buffering saved core 0 on the last
+     * frame, compared to sending the framebuffer synchronously.
+     *
+     * @return int32_t Time saved in us. Negative if waiting on core 1 cost more
+     * than the panel update itself.
+     */
+    [[nodiscard]] int32_t get_double_buffer_saving_us() const
+    {
+        return static_cast<int32_t>(panel_us_) - static_cast<int32_t>(panel_wait_us_);
+    }
+
+    [[nodiscard]] const AmbientLight &get_ambient_light() const { return ambient_light_; }
+    [[nodiscard]] const IdleMode &get_idle_mode() const { return idle_; }
+    [[nodiscard]] const FrameGovernor &get_frame_governor() const { return governor_; }
+
+    /**
+     * @brief Scale the particle load to hold the target FPS, or go back to
+     * the full load.
+     */
+    void set_governor_enabled(const bool enabled)
+    {
+        governor_.set_enabled(enabled);
+        apply_load();
+    }
+
+    /**
+     * @brief Allow the display to idle in a dark, empty room, or keep it animating.
+     */
+    void set_idle_enabled(const bool enabled) { idle_.set_enabled(enabled); }
+
+    /**
+     * @brief Follow the room's light a different way, see AmbientLight.
+     */
+    void set_ambient_light_mode(const AmbientLight::Mode mode)
+    {
+        ambient_light_.start(mode, ambient_light_.int_pin());
+    }
+
+    /**
+     * @brief Get the frame time saved by following the light sensor off the
+     * frame path: the read every frame used to make, less the time the
+     * sensor now takes, spread over the frames.
+     *
+     * @return int32_t Time saved per frame in us.
+     */
+    [[nodiscard]] int32_t get_ambient_light_saving_us() const
+    {
+        return static_cast<int32_t>(ambient_light_.read_us()) -
+               static_cast<int32_t>(lroundf(ambient_light_.bus_us_per_s() * frame_us_ / 1e6f));
     }
 
     /**
      * @brief Refresh and update the display (main rendering function)
      *
      * This should be called every frame. It:
-     * 1. Clears the framebuffer
-     * 2. Draws frame dividers
-     * 3. Draws all segments (using dual-core rendering if multiple segments)
-     * 4. Updates the physical display
+     * 1. Steps every segment and records the frame (dividers, segments) into a draw list
+     * 2. Clears the framebuffer and rasterises the draw list
+     * 3. Updates the physical display
+     *
+     * In pipelined mode step 1 runs on core 0 while steps 2 and 3 for the
+     * previous frame run on core 1. Each draw list is left untouched from the
+     * moment it is handed to core 1 until core 1 reports it done.
+     *
+     * In split segment mode each core steps and draws its own share of the
+     * segments straight into the framebuffer, rebalanced every frame.
+     *
+     * In double buffered mode steps 1 and 2 run on core 0 into the back
+     * framebuffer while core 1 runs step 3 for the front one.
      */
     void refresh_and_update_display()
     {
+        ambient_light_.service();
+        i75_.brightness = ambient_light_.brightness();
 
-        graphics_.clear_framebuffer();
+        if (idle_.update(ambient_light_.near(), ambient_light_.brightness() == AmbientLight::kMinBrightness))
+        {
+            idle_.state() == PowerState::kIdle ? enter_idle() : leave_idle();
+        }
+        if (idle_.state() == PowerState::kIdle)
+        {
+            pace_frame(false); // The panel keeps showing the last frame.
+            return;
+        }
 
-        // Draw frame dividers
-        graphics_.set_pen(pen_white);
-        graphics_.set_depth((uint8_t)255);
-        for (int point : frame_points_)
+        if (render_mode_ == RenderMode::kSplitSegments)
         {
-            graphics_.line(pimoroni::Point(point, 0), pimoroni::Point(point, height_));
+            split_frame();
+            pace_frame();
+            return;
         }
 
-        float lux_bright = lux_meter_.getAmbientLight();
+        DrawList &list = draw_lists_[back_list_];
 
-        i75_.brightness = std::clamp(static_cast<int>(lux_bright * lux_bright / 2.0f), 2, 10);
+        const uint32_t simulate_start = time_us_32();
+        record_frame(list);
+        simulate_us_ = time_us_32() - simulate_start;
 
-        uint16_t total_particles = 0;
-        for (auto &segment : segment_display_)
+        if (render_mode_ == RenderMode::kPipelined)
         {
-            segment.draw_seg(graphics_);
-            total_particles += segment.get_total_particle_count();
+            // Core 1 is still on the previous frame, wait for it before handing over this one.
+            if (Core1Worker::job_pending())
+            {
+                Core1Worker::wait();
+                render_us_ = render_job_.elapsed_us;
+            }
+
+            render_job_ = {this, &list, 0};
+            Core1Worker::submit(render_job, &render_job_);
+            back_list_ ^= 1;
+            core_busy_us_ = {simulate_us_, render_us_};
+        }
+        else if (render_mode_ == RenderMode::kDoubleBuffered)
+        {
+            double_buffered_frame(list);
+        }
+        else
+        {
+            render_us_ = render_frame(list);
+            core_busy_us_ = {simulate_us_ + render_us_, 0};
         }
 
-        total_particle_count_ = total_particles;
-        // Update physical display
+        pace_frame();
+    }
 
-        i75_.update(&graphics_);
+private:
+    /**
+     * @brief Change clk_sys with the light sensor stopped. clk_peri follows
+     * clk_sys, so the I2C divider is worked out again for the new clock, and
+     * that disables the controller and empties its FIFOs: a queued read would
+     * be lost for good, and a transfer from the sensor's interrupt cut short.
+     *
+     * @return false if the clock can't be reached and was left as it was.
+     */
+    bool change_clock(const uint32_t khz)
+    {
+        ambient_light_.stop();
+        const bool changed = set_sys_clock_khz(khz, false);
+        if (changed)
+        {
+            i2c_set_baudrate(i2c0, pimoroni::I2C_DEFAULT_BAUDRATE);
+        }
+        ambient_light_.resume();
+        return changed;
+    }
 
+    /**
+     * @brief Let core 1 finish, then drop the clock.
+     */
+    void enter_idle()
+    {
+        Core1Worker::wait();
+        active_clock_khz_ = clock_get_hz(clk_sys) / 1000;
+        if (!change_clock(IdleMode::kIdleClockKhz))
+        {
+            printf("Idle: can't reach %lu MHz, holding the last frame at %lu MHz.\n",
+                   static_cast<unsigned long>(IdleMode::kIdleClockKhz / 1000), static_cast<unsigned long>(active_clock_khz_ / 1000));
+            return;
+        }
+        printf("Idle: dark and nobody near, holding the last frame at %lu MHz.\n",
+               static_cast<unsigned long>(IdleMode::kIdleClockKhz / 1000));
+    }
+
+    /**
+     * @brief Restore the clock and carry the simulation on from where it
+     * paused, as if one frame had passed.
+     */
+    void leave_idle()
+    {
+        if (!change_clock(active_clock_khz_))
+        {
+            printf("Awake: can't get back to %lu MHz, running at %lu MHz.\n", static_cast<unsigned long>(active_clock_khz_ / 1000),
+                   static_cast<unsigned long>(clock_get_hz(clk_sys) / 1000000));
+        }
+        for (auto &segment : segment_display_)
+        {
+            segment.resume_clock(fps_period_us_);
+        }
+        printf("Awake: %s.\n", ambient_light_.near() ? "someone is near" : "the light came on");
+    }
+
+    /**
+     * @brief Give every segment the governor's particle load.
+     */
+    void apply_load()
+    {
+        for (auto &segment : segment_display_)
+        {
+            segment.set_load(governor_.load());
+        }
+    }
+
+    /**
+     * @brief Wait out the rest of the frame period.
+     *
+     * @param govern Count the frame's work towards the particle load.
+     */
+    void pace_frame(const bool govern = true)
+    {
         uint32_t current_time = time_us_32();
         uint32_t delta = current_time - prev_time_;
 
+        if (govern)
+        {
+            const bool retiring = std::any_of(segment_display_.begin(), segment_display_.end(), [](const DisplaySegment &segment)
+                                              { return segment.retiring(); });
+            const bool filling = std::any_of(segment_display_.begin(), segment_display_.end(), [](const DisplaySegment &segment)
+                                             { return segment.filling(); });
+            if (governor_.update(delta, fps_period_us_, retiring, filling))
+            {
+                apply_load();
+            }
+        }
+
         if (delta < fps_period_us_)
         {
             uint32_t time_wait = fps_period_us_ - delta;
             sleep_us(time_wait);
         }
 
-        prev_time_ = time_us_32();
+        const uint32_t now = time_us_32();
+        frame_us_ = now - prev_time_;
+        prev_time_ = now;
     }
 };
 
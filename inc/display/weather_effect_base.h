@@ -2,11 +2,12 @@
 #define WEATHER_EFFECT_BASE_H
 
 #include "particles/particle_base.h"
+#include "particles/particle_pool.h"
 #include "segment/segment_properties.h"
 #include "z_buffer.h"
-
-#include <list>
-#include <memory>
+#include "draw_list.h"
+#include "depth_palette.h"
+#include "helpers_rand.h"
 
 #include "particles/wind_gusts.h"
 
@@ -14,8 +15,18 @@ class WindGust;
 /**
  * @brief Base class for all weather effects (rain, snow, clouds, thunderstorms, etc.)
  *
- * This provides a common interface that all weather effects must implement.
- * The DisplaySegment will call update_particles() and draw() on each effect.
+ * This holds the state every effect shares. It is not polymorphic: the set of
+ * effects is closed (see WeatherEffect in weather_factory.h), and the
+ * DisplaySegment calls update_particles() and draw() on the concrete type
+ * through std::visit, so the calls can be inlined into the frame loop.
+ *
+ * Every effect must provide:
+ * - void update_particles(): update particle positions, spawn new particles,
+ *   remove old ones. Called once per frame before drawing.
+ * - void draw(DrawList &list): record the effect's drawing for this frame.
+ *
+ * Effects whose look depends on the forecast also provide a retune() that
+ * follows a change in it without restarting (see WeatherEffectFactory::retune_effects()).
  */
 class WeatherEffectBase
 {
@@ -25,8 +36,33 @@ protected:
     DisplaySegProperties &seg_properties_;               // Reference to the segment properties.
     WindGust windgust_;
     float spawn_rate_;                                   // How quickly new particles are spawned.
-    uint16_t max_particles_;                             // The maximum number of particles for this segment.
-    std::list<std::unique_ptr<ParticleBase>> particles_; // List of particles.
+    uint16_t max_particles_ = 0;                         // The maximum number of particles for this segment.
+    float load_ = 1.0f;                                  // Share of max_particles_ and spawn_rate_ in use, see set_load().
+    ParticlePool particles_;                             // Particle storage, sized once by the derived effect.
+
+    [[nodiscard]] uint16_t particle_limit() const { return roundf(max_particles_ * load_); }
+
+    /**
+     * @brief Whether to spawn a particle this frame, if the pool has room.
+     */
+    [[nodiscard]] bool spawn_due() const { return get_rand_float() < spawn_rate_ * load_; }
+
+    /**
+     * @brief Follow the segment's intensity without restarting: the spawn
+     * rate, particle limit and wind gusts change, and particles already
+     * falling carry on. The pool only allocates if the limit grows past it.
+     *
+     * @param particles_per_px Particles per pixel of segment width at intensity 1.
+     */
+    void retune_particles(const float particles_per_px)
+    {
+        const float intensity = seg_properties_.get_intensity();
+        spawn_rate_ = intensity / 3.0f;
+        max_particles_ = roundf(seg_properties_.get_seg_bounds().w * particles_per_px * intensity);
+        particles_.resize(max_particles_);
+        particles_.limit(particle_limit());
+        windgust_.set_intensity(intensity);
+    }
 
 public:
     WeatherEffectBase(DisplaySegProperties &seg_props) : seg_properties_(seg_props), windgust_(seg_props), spawn_rate_((seg_props.get_intensity() / 3.0f))
@@ -34,25 +70,48 @@ public:
         windgust_.reset();
     }
 
-    virtual ~WeatherEffectBase() = default;
+    /**
+     * @brief Stop the effect (cleanup, stop background threads if any).
+     * Effects that need to clean up hide this with their own.
+     */
+    void stop() {};
+
+    /**
+     * @brief Respawn every particle at once, e.g. after gravity changes.
+     * Effects without particles have nothing to do.
+     */
+    void respawn() {};
 
+    /**
+     * @brief Follow a change in the forecast that keeps this effect.
+     * Effects that depend on more than the segment's intensity hide this
+     * with their own, taking what they need.
+     */
+    void retune() {};
 
     /**
-     * @brief Update particle positions, spawn new particles, remove old ones.
-     * Called once per frame before drawing.
+     * @brief Scale the particle limit and spawn rate, to hold the frame rate.
+     * The storage stays sized for the full load, so raising it again never
+     * allocates. Lowering it drops nothing on screen: particles past the new
+     * limit are retired as they leave the segment.
+     *
+     * @param load Share of the full particle load, 0 to 1.
      */
-    virtual void update_particles() = 0;
+    void set_load(const float load)
+    {
+        load_ = load;
+        particles_.limit(particle_limit());
+    }
 
     /**
-     * @brief Draw the weather effect to the display.
-     * @param graphics Reference to the PicoGraphics object for drawing
+     * @brief Particles past the limit are still being retired.
      */
-    virtual void draw(pimoroni::PicoZGraphics &graphics) = 0;
+    [[nodiscard]] bool retiring() const { return particles_.over_capacity(); }
 
     /**
-     * @brief Stop the effect (cleanup, stop background threads if any).
+     * @brief The pool hasn't filled up to the limit yet.
      */
-    virtual void stop() {};
+    [[nodiscard]] bool filling() const { return particles_.size() < particles_.capacity(); }
 
     /**
      * @brief Get the particle count for this segment.
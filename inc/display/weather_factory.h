@@ -2,97 +2,99 @@
 #define WEATHER_FACTORY_H
 
 #include "segment/segment_properties.h"
+#include "weather_codes.h"
 #include "weather_effect_base.h"
 #include "effects/rain.h"
 #include "effects/snow.h"
 #include "effects/thunderstorm.h"
 #include "effects/clouds.h"
 
+#include <type_traits>
 #include <vector>
-#include <memory>
-#include <string>
-#include <algorithm>
+#include <variant>
+
+/**
+ * @brief Every effect a segment can show. The set is closed, so effects are
+ * stored by value and dispatched with std::visit instead of virtual calls.
+ */
+using WeatherEffect = std::variant<weather::RainEffect, weather::SnowEffect, weather::ThunderstormEffect, weather::CloudsEffect>;
 
 /**
  * @brief Factory for creating weather effect instances based on weather codes
  *
- * This class analyzes weather data and creates appropriate weather effects
- * to render for a given weather condition.
+ * Effects are chosen from the weather code's compile-time descriptor, so
+ * creating them needs no string handling.
  */
 class WeatherEffectFactory
 {
+private:
+    static float thunder_intensity(const WeatherDescriptor &weather)
+    {
+        float intensity = 1.0f;
+
+        if (weather.intensity == Intensity::kHeavy)
+        {
+            intensity += 2.0f;
+        }
+
+        if (weather.intensity == Intensity::kLight)
+        {
+            intensity -= 0.5f;
+        }
+        return intensity;
+    }
+
 public:
     /**
-     * @brief Create weather effects based on weather code and description
+     * @brief Create weather effects for a weather code's descriptor
      *
-     * @param weather_code Tomorrow.io weather code (e.g., 40010 for Rain)
-     * @param weather_description Human-readable description
-     * @param x_start Segment X start coordinate
-     * @param x_end Segment X end coordinate
-     * @param height Display height
-     * @param precip_type Precipitation type (N/A, Rain, Snow, etc.)
-     * @param precip_intensity Precipitation intensity (0.0 to 3.0+)
+     * @param weather Descriptor of the day's weather code (see weather_descriptor())
+     * @param seg_properties Properties of the segment the effects draw in
      * @param snow_accumulation Snow accumulation in mm
      * @param ice_accumulation Ice accumulation in mm
      * @param cloud_cover Cloud cover percentage (0-100)
-     * @return Vector of unique pointers to weather effects
+     * @return Vector of weather effects, in drawing order
      */
-    static std::vector<std::unique_ptr<WeatherEffectBase>> create_effects(
-        int weather_code,
-        const std::string &weather_description,
+    static std::vector<WeatherEffect> create_effects(
+        const WeatherDescriptor &weather,
         DisplaySegProperties &seg_properties,
-        const std::string &precip_type,
         float snow_accumulation,
         float ice_accumulation,
         int cloud_cover)
     {
-        std::vector<std::unique_ptr<WeatherEffectBase>> effects;
-
-        // Convert description to lowercase for comparison
-        std::string desc_lower = weather_description;
-        std::transform(desc_lower.begin(), desc_lower.end(), desc_lower.begin(),
-                       [](unsigned char c)
-                       { return std::tolower(c); });
+        std::vector<WeatherEffect> effects;
+        // Sized up front so effects never move; clear days don't allocate at all.
+        effects.reserve((weather.precip != PrecipKind::kNone) + weather.thunder());
 
         // 1. Check for cloud effects (background layer)
         // TODO: Enable clouds when fully implemented
-        // if (cloud_cover > 30 || desc_lower.find("cloud") != std::string::npos ||
-        //     desc_lower.find("fog") != std::string::npos) {
-        //     effects.push_back(std::make_unique<CloudsEffect>(x_start, x_end, height, cloud_cover));
+        // if (cloud_cover > 30 || weather.cloudiness >= Cloudiness::kMostlyCloudy || weather.fog()) {
+        //     effects.emplace_back(std::in_place_type<weather::CloudsEffect>, seg_properties, cloud_cover);
         // }
 
         // 2. Check for precipitation effects (foreground layer)
-        if (precip_type == "Rain" || desc_lower.find("rain") != std::string::npos ||
-            desc_lower.find("drizzle") != std::string::npos)
-        {
-            bool freezing = (desc_lower.find("freezing") != std::string::npos);
-            effects.push_back(std::make_unique<weather::RainEffect>(seg_properties, freezing));
-        }
-        else if (precip_type == "Snow" || desc_lower.find("snow") != std::string::npos ||
-                 desc_lower.find("flurries") != std::string::npos)
-        {
-            effects.push_back(std::make_unique<weather::SnowEffect>(seg_properties, snow_accumulation, false));
-        }
-        else if (precip_type == "Ice Pellets" || desc_lower.find("ice") != std::string::npos)
-        {
-            effects.push_back(std::make_unique<weather::SnowEffect>(seg_properties, ice_accumulation, true));
-        }
-        // 3. Check for thunderstorm effects (top layer)
-        if (desc_lower.find("thunderstorm") != std::string::npos)
+        switch (weather.precip)
         {
-            float intensity = 1.0f;
+        case PrecipKind::kRain:
+            effects.emplace_back(std::in_place_type<weather::RainEffect>, seg_properties, weather.freezing());
+            break;
+
+        case PrecipKind::kSnow:
+            effects.emplace_back(std::in_place_type<weather::SnowEffect>, seg_properties, snow_accumulation, false);
+            break;
 
-            if (desc_lower.find("severe") != std::string::npos)
-            {
-                intensity += 2.0f;
-            }
+        case PrecipKind::kIce:
+            effects.emplace_back(std::in_place_type<weather::SnowEffect>, seg_properties, ice_accumulation, true);
+            break;
 
-            if (desc_lower.find("light") != std::string::npos)
-            {
-                intensity -= 0.5f;
-            }
+        case PrecipKind::kNone:
+            break;
+        }
 
-            effects.push_back(std::make_unique<weather::ThunderstormEffect>(seg_properties, intensity));
+        // 3. Check for thunderstorm effects (top layer)
+        if (weather.thunder())
+        {
+            effects.emplace_back(std::in_place_type<weather::ThunderstormEffect>, seg_properties, thunder_intensity(weather));
         }
 
         // If no effects were added, it's clear weather (just base display will render)
@@ -101,38 +103,58 @@ public:
     }
 
     /**
-     * @brief Parse weather code to extract information
-     *
-     * @param weather_code Tomorrow.io weather code
-     * @return Struct with flags for different weather components
+     * @brief Whether create_effects() makes the same effects, in the same
+     * order, for both descriptors. If so a segment can keep its effects and
+     * retune them rather than build new ones.
      */
-    struct WeatherCodeInfo
+    static bool same_effects(const WeatherDescriptor &a, const WeatherDescriptor &b)
     {
-        bool is_clear;
-        bool is_cloudy;
-        bool is_fog;
-        bool is_rain;
-        bool is_snow;
-        bool is_freezing;
-        bool is_ice;
-        bool is_thunderstorm;
-    };
-
-    static WeatherCodeInfo parse_weather_code(int weather_code)
+        return a.precip == b.precip && a.thunder() == b.thunder() &&
+               (a.precip != PrecipKind::kRain || a.freezing() == b.freezing());
+    }
+
+    /**
+     * @brief Bring effects made by create_effects() in line with a new
+     * forecast that same_effects() says keeps them, without restarting them.
+     * The segment properties must already hold the new intensity.
+     *
+     * @param effects Effects to retune.
+     * @param weather Descriptor of the new weather code
+     * @param snow_accumulation Snow accumulation in mm
+     * @param ice_accumulation Ice accumulation in mm
+     * @param cloud_cover Cloud cover percentage (0-100)
+     */
+    static void retune_effects(
+        std::vector<WeatherEffect> &effects,
+        const WeatherDescriptor &weather,
+        float snow_accumulation,
+        float ice_accumulation,
+        int cloud_cover)
     {
-        std::string code_str = std::to_string(weather_code);
-
-        WeatherCodeInfo info;
-        info.is_clear = (code_str.rfind("100", 0) == 0);
-        info.is_cloudy = (code_str.rfind("110", 0) == 0) || (code_str.rfind("102", 0) == 0);
-        info.is_fog = (code_str[0] == '2');
-        info.is_rain = (code_str[0] == '4');
-        info.is_snow = (code_str[0] == '5');
-        info.is_freezing = (code_str[0] == '6');
-        info.is_ice = (code_str[0] == '7');
-        info.is_thunderstorm = (code_str[0] == '8');
-
-        return info;
+        for (auto &effect : effects)
+        {
+            std::visit([&](auto &e)
+                       {
+                           using Effect = std::decay_t<decltype(e)>;
+                           if constexpr (std::is_same_v<Effect, weather::SnowEffect>)
+                           {
+                               e.retune(weather.precip == PrecipKind::kIce ? ice_accumulation : snow_accumulation);
+                           }
+                           else if constexpr (std::is_same_v<Effect, weather::ThunderstormEffect>)
+                           {
+                               e.retune(thunder_intensity(weather));
+                           }
+                           else if constexpr (std::is_same_v<Effect, weather::CloudsEffect>)
+                           {
+                               e.retune(cloud_cover);
+                           }
+                           else
+                           {
+                               e.retune();
+                           }
+                       },
+                       effect);
+        }
     }
 };
 
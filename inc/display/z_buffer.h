@@ -2,7 +2,11 @@
 #define ZBUFF_H
 
 #include "libraries/pico_graphics/pico_graphics.hpp"
+#include "segment/segment_geometry.h"
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <type_traits>
 
 #pragma once
@@ -29,6 +33,22 @@ inline int32_t color_to_pen(const Color color)
     return color_creator.create_pen(color.r, color.g, color.b);
 }
 
+/**
+ * @brief Pack 8 bit channels into an RGB888 pen, as create_pen would.
+ */
+constexpr uint32_t pack_rgb888(const uint8_t r, const uint8_t g, const uint8_t b)
+{
+    return (r << 16) | (g << 8) | b;
+}
+
+/**
+ * @brief Convert a 0 - 1.0f depth into the 8 bit depth stored in the framebuffer.
+ */
+constexpr uint8_t depth_to_u8(const float depth)
+{
+    return static_cast<uint8_t>(depth * UINT8_MAX);
+}
+
 const int pen_black = color_to_pen(kBlack);
 const int pen_red = color_to_pen(kRed);
 const int pen_white = color_to_pen(kWhite);
@@ -38,6 +58,17 @@ const int pen_blue = color_to_pen(kBlue);
 namespace pimoroni
 {
 
+    /**
+     * @brief A point ready to be written to a PicoZGraphics framebuffer, with its
+     * depth and color already packed as 0xDDRRGGBB.
+     */
+    struct DepthPoint
+    {
+        int16_t x;
+        int16_t y;
+        uint32_t pixel;
+    };
+
     /**
      * @brief Modified PicoGraphics_PenRGB888 derivative that adds depth testing.
      * Stores depth in the high byte of the 32-bit color (0xDDRRGGBB format).
@@ -52,15 +83,98 @@ namespace pimoroni
      */
     class PicoZGraphics : public PicoGraphics_PenRGB888
     {
+    public:
+        static constexpr uint8_t kTileShift = 4;                  // Dirty tiles are 16x16 pixels.
+        static constexpr uint8_t kTileSize = 1 << kTileShift;
+        static constexpr uint8_t kFullClearPercent = 50;          // Clear the whole buffer once this many tiles are dirty.
+
+    private:
         uint8_t depth_;
         bool is_depth_active;
+        uint16_t tiles_x_;                                        // Tiles across the framebuffer.
+        uint16_t tiles_y_;                                        // Tiles down the framebuffer.
+        std::unique_ptr<uint8_t[]> dirty_tiles_;                  // Non-zero for every tile written since the last clear.
+        uint32_t pixels_cleared_ = 0;                             // Pixels written by the last clear_framebuffer().
+        bool last_clear_full_ = true;                             // Whether the last clear fell back to clearing everything.
+
+        void mark_dirty(const int32_t x, const int32_t y)
+        {
+            dirty_tiles_[(y >> kTileShift) * tiles_x_ + (x >> kTileShift)] = 1;
+        }
+
+        /**
+         * @brief Clip a line to a rectangle (Liang-Barsky). The clipped end points
+         * are clamped into the rectangle, so every pixel of a line drawn between
+         * them lies inside it.
+         *
+         * @return bool False if no part of the line is inside the rectangle.
+         */
+        static bool clip_streak(Point &p0, Point &p1, const RectMod &clip)
+        {
+            const float dx = p1.x - p0.x;
+            const float dy = p1.y - p0.y;
+            const float p[4] = {-dx, dx, -dy, dy};
+            const float q[4] = {static_cast<float>(p0.x - clip.x), static_cast<float>(clip.x_end - p0.x),
+                                static_cast<float>(p0.y - clip.y), static_cast<float>(clip.y_end - p0.y)};
+
+            float t0 = 0.0f;
+            float t1 = 1.0f;
+            for (uint8_t i = 0; i < 4; i++)
+            {
+                if (p[i] == 0.0f)
+                {
+                    if (q[i] < 0.0f)
+                    {
+                        return false;
+                    }
+                }
+                else if (const float t = q[i] / p[i]; p[i] < 0.0f)
+                {
+                    t0 = std::max(t0, t);
+                }
+                else
+                {
+                    t1 = std::min(t1, t);
+                }
+            }
+
+            if (t0 > t1)
+            {
+                return false;
+            }
+
+            const Point start(lroundf(p0.x + (t0 * dx)), lroundf(p0.y + (t0 * dy)));
+            const Point end(lroundf(p0.x + (t1 * dx)), lroundf(p0.y + (t1 * dy)));
+            p0 = Point(std::clamp(start.x, clip.x, clip.x_end), std::clamp(start.y, clip.y, clip.y_end));
+            p1 = Point(std::clamp(end.x, clip.x, clip.x_end), std::clamp(end.y, clip.y, clip.y_end));
+            return true;
+        }
+
+        /**
+         * @brief Fill a rectangle of the framebuffer with black at depth 0,
+         * without going through the pen or depth test.
+         */
+        void clear_rect(const Rect &r)
+        {
+            auto *buf = static_cast<uint32_t *>(frame_buffer);
+            buf += this->layer_offset;
+
+            for (int32_t y = r.y; y < r.y + r.h; y++)
+            {
+                std::fill_n(&buf[y * bounds.w + r.x], r.w, static_cast<uint32_t>(pen_black));
+            }
+        }
 
     public:
         PicoZGraphics(const uint16_t width, const uint16_t height, void *frame_buffer, uint16_t layers = 1)
-            : PicoGraphics_PenRGB888(width, height, frame_buffer, layers)
+            : PicoGraphics_PenRGB888(width, height, frame_buffer, layers),
+              tiles_x_((width + kTileSize - 1) >> kTileShift), tiles_y_((height + kTileSize - 1) >> kTileShift),
+              dirty_tiles_(std::make_unique<uint8_t[]>(tiles_x_ * tiles_y_))
         {
             is_depth_active = false;
             depth_ = 0;
+            // Nothing is known about the buffer's contents yet, so the first clear must cover all of it.
+            std::fill_n(dirty_tiles_.get(), tiles_x_ * tiles_y_, 1);
         }
         void enable_depth()
         {
@@ -82,7 +196,7 @@ namespace pimoroni
             }
             else if constexpr (std::is_floating_point_v<T>)
             {
-                depth_ = static_cast<uint8_t>(depth * UINT8_MAX);
+                depth_ = depth_to_u8(depth);
             }
         }
 
@@ -90,15 +204,142 @@ namespace pimoroni
          * @brief Automatically clears out the framebuffer
          * to black, with 0 depth.
          *
+         * Only the tiles written since the last clear are cleared. Once more than
+         * kFullClearPercent of the tiles are dirty the whole buffer is cleared in
+         * one pass instead, which is cheaper than going tile by tile.
          */
         void clear_framebuffer()
         {
-            disable_depth();
-            set_pen(pen_black);
-            this->clear();
+            const uint16_t tile_count = tiles_x_ * tiles_y_;
+            const uint16_t dirty_count = std::count(dirty_tiles_.get(), dirty_tiles_.get() + tile_count, 1);
+
+            last_clear_full_ = dirty_count * 100 >= tile_count * kFullClearPercent;
+            if (last_clear_full_)
+            {
+                clear_rect(bounds);
+                pixels_cleared_ = bounds.w * bounds.h;
+            }
+            else
+            {
+                pixels_cleared_ = 0;
+                for (uint16_t tile = 0; tile < tile_count; tile++)
+                {
+                    if (dirty_tiles_[tile])
+                    {
+                        const Rect tile_rect((tile % tiles_x_) << kTileShift, (tile / tiles_x_) << kTileShift, kTileSize, kTileSize);
+                        const Rect clipped = tile_rect.intersection(bounds);
+                        clear_rect(clipped);
+                        pixels_cleared_ += clipped.w * clipped.h;
+                    }
+                }
+            }
+
+            std::fill_n(dirty_tiles_.get(), tile_count, 0);
             enable_depth();
         }
 
+        /**
+         * @brief Draw a short depth-tested line, such as a rain streak, with the
+         * current pen and depth.
+         *
+         * The line is clipped once against the clip rectangle, after which every
+         * pixel is written directly with no virtual call and no bounds check.
+         *
+         * @param p0 Start of the line.
+         * @param p1 End of the line.
+         * @param clip Rectangle to clip to, must lie within the framebuffer.
+         */
+        __attribute__((optimize("O3")))
+        void draw_streak(Point p0, Point p1, const RectMod &clip)
+        {
+            if (std::max(p0.x, p1.x) < clip.x || std::min(p0.x, p1.x) > clip.x_end ||
+                std::max(p0.y, p1.y) < clip.y || std::min(p0.y, p1.y) > clip.y_end)
+            {
+                return;
+            }
+
+            if ((!clip.contains_inclusive(p0) || !clip.contains_inclusive(p1)) && !clip_streak(p0, p1, clip))
+            {
+                return;
+            }
+
+            // Every pixel lies within the end points' bounding box, so marking its tiles covers the line.
+            for (int32_t ty = std::min(p0.y, p1.y) >> kTileShift; ty <= (std::max(p0.y, p1.y) >> kTileShift); ty++)
+            {
+                for (int32_t tx = std::min(p0.x, p1.x) >> kTileShift; tx <= (std::max(p0.x, p1.x) >> kTileShift); tx++)
+                {
+                    dirty_tiles_[ty * tiles_x_ + tx] = 1;
+                }
+            }
+
+            // Bresenham, stepping along the major axis every pixel and along the minor axis when the error overflows.
+            const int32_t dx = std::abs(p1.x - p0.x);
+            const int32_t dy = std::abs(p1.y - p0.y);
+            const int32_t step_x = p0.x < p1.x ? 1 : -1;
+            const int32_t step_y = p0.y < p1.y ? bounds.w : -bounds.w;
+            const bool x_major = dx >= dy;
+            const int32_t major = x_major ? dx : dy;
+            const int32_t minor = x_major ? dy : dx;
+            const int32_t major_step = x_major ? step_x : step_y;
+            const int32_t minor_step = x_major ? step_y : step_x;
+            const uint32_t color_with_depth = color | (depth_ << 24);
+
+            auto *buf = static_cast<uint32_t *>(frame_buffer) + this->layer_offset;
+            int32_t offset = p0.y * bounds.w + p0.x;
+            int32_t error = (2 * minor) - major;
+
+            for (int32_t i = 0; i <= major; i++)
+            {
+                uint32_t &pixel = buf[offset];
+                pixel = depth_ > (pixel >> 24) ? color_with_depth : pixel;
+
+                // Branch-free minor step, the direction changes too often to predict.
+                const int32_t overflow = -static_cast<int32_t>(error > 0);
+                offset += major_step + (minor_step & overflow);
+                error += (2 * minor) - ((2 * major) & overflow);
+            }
+        }
+
+        /**
+         * @brief Depth test and write a batch of points in one pass. There is no
+         * pen or depth state involved and no virtual call; each point carries its
+         * own packed depth and color.
+         *
+         * @param points Points to draw.
+         * @param count Number of points.
+         * @param clip Points outside this are skipped. Must lie within the framebuffer.
+         */
+        __attribute__((optimize("O3")))
+        void draw_points(const DepthPoint *points, const uint16_t count, const RectMod &clip)
+        {
+            auto *buf = static_cast<uint32_t *>(frame_buffer) + this->layer_offset;
+
+            for (uint16_t i = 0; i < count; i++)
+            {
+                const DepthPoint &point = points[i];
+                if (!clip.contains_inclusive(pimoroni::Point(point.x, point.y)))
+                {
+                    continue;
+                }
+                uint32_t &pixel = buf[point.y * bounds.w + point.x];
+                if ((point.pixel >> 24) > (pixel >> 24))
+                {
+                    pixel = point.pixel;
+                }
+                mark_dirty(point.x, point.y);
+            }
+        }
+
+        /**
+         * @brief Get the number of pixels the last clear_framebuffer() wrote.
+         */
+        [[nodiscard]] uint32_t get_pixels_cleared() const { return pixels_cleared_; }
+
+        /**
+         * @brief Get whether the last clear_framebuffer() cleared the whole buffer.
+         */
+        [[nodiscard]] bool was_last_clear_full() const { return last_clear_full_; }
+
     public:
         __attribute__((optimize("O3")))
         void set_pixel(const Point &p) override
@@ -111,6 +352,7 @@ namespace pimoroni
             buf += this->layer_offset;
 
             uint32_t &pixel = buf[p.y * bounds.w + p.x];
+            mark_dirty(p.x, p.y);
 
             if (!is_depth_active)
             {
@@ -137,6 +379,11 @@ namespace pimoroni
             buf += this->layer_offset;
             buf = &buf[p.y * bounds.w + p.x];
 
+            for (int32_t x = p.x & ~(kTileSize - 1); x < p.x + static_cast<int32_t>(l); x += kTileSize)
+            {
+                mark_dirty(x, p.y);
+            }
+
             const uint32_t color_with_depth = color | (depth_ << 24);
 
             if (!is_depth_active)
@@ -21,28 +21,36 @@ namespace weather
         float cloud_cover_;
 
     public:
-        CloudsEffect(DisplaySegProperties seg_properties, float cloud_cover)
+        CloudsEffect(DisplaySegProperties &seg_properties, float cloud_cover)
             : WeatherEffectBase(seg_properties), cloud_cover_(cloud_cover)
         {
         }
 
-        void update_particles() override
+        void update_particles()
         {
             // No particles to update for static clouds
             // Could add cloud movement here
         }
 
-        void draw(pimoroni::PicoZGraphics &graphics) override
+        void draw(DrawList &list)
         {
             // Simple cloud representation: semi-transparent gray overlay
             // TODO: Implement actual cloud rendering
             // For now, this is a placeholder
         }
 
-        void stop() override
+        void stop()
         {
             // Nothing to clean up
         }
+
+        /**
+         * @brief Follow a new cloud cover.
+         */
+        void retune(float cloud_cover)
+        {
+            cloud_cover_ = cloud_cover;
+        }
     };
 
 } // namespace weather
@@ -5,9 +5,7 @@
 #include "particles/particle.h"
 #include "helpers_rand.h"
 
-#include <list>
 #include <cmath>
-#include <memory>
 
 namespace weather
 {
@@ -19,8 +17,11 @@ namespace weather
     {
 
     private:
+        static constexpr float kParticlesPerPx = 0.9f; // Drops per pixel of width at intensity 1.
+
         bool freezing_; // True for freezing rain
         Color draw_color_ = kBlue;
+        DepthPalette palette_{kBlue}; // Drop color shaded by depth.
 
     public:
         RainEffect(DisplaySegProperties &seg_properties, bool freezing = false) : WeatherEffectBase(seg_properties), freezing_(freezing)
@@ -34,44 +35,61 @@ namespace weather
             {
                 draw_color_ = kBlue;
             }
-            max_particles_ = roundf(seg_properties_.get_seg_bounds().w * 0.9f * seg_properties_.get_intensity());
+            max_particles_ = roundf(seg_properties_.get_seg_bounds().w * kParticlesPerPx * seg_properties_.get_intensity());
+            particles_.allocate(max_particles_);
+            palette_.update(draw_color_);
         }
 
-        void update_particles() override
+        void update_particles()
         {
             // Spawn new drops based on spawn rate
-            if (particles_.size() < static_cast<size_t>(max_particles_) && get_rand_float() < spawn_rate_)
+            if (!particles_.full() && spawn_due())
             {
-                particles_.push_back(std::make_unique<Rain>(seg_properties_));
+                spawn_particle<Rain>(particles_, seg_properties_);
             }
             // Update all particles
-            for (const auto &drop : particles_)
-            {
-                drop->update();
-            }
+            step_particles<Rain>(particles_, seg_properties_);
         }
 
-        void draw(pimoroni::PicoZGraphics &graphics) override
+        void draw(DrawList &list)
         {
-            // Draw each raindrop as a line aligned with gravity direction
-            for (const auto &drop : particles_)
+            // Draw each raindrop as a streak aligned with gravity direction, kept within the segment
+            list.set_clip(seg_properties_.get_seg_bounds());
+            palette_.update(draw_color_);
+            const uint16_t count = particles_.size();
+            for (uint16_t i = 0; i < count; i++)
             {
-                if (drop->is_drawable())
+                const particle_scalar_t x = particles_.x[i];
+                const particle_scalar_t y = particles_.y[i];
+                const pimoroni::Point start(particle_to_pixel(x), particle_to_pixel(y));
+                if (seg_properties_.is_particle_in_segment(start))
                 {
-                    Position &position = drop->get_positions();
-                    graphics.set_pen((position.z * draw_color_.r), (position.z * draw_color_.g), (position.z * draw_color_.b));
-                    graphics.set_depth(position.z);
-                    // Calculate line endpoint based on gravity direction and drop length
-                    auto [start, end] = drop->calc_length();
-                    graphics.line(start, end);
+                    const uint8_t depth = particle_to_depth(particles_.z[i]);
+                    // Line endpoint follows the drop's velocity, so streaks align with gravity
+                    const pimoroni::Point end(particle_to_pixel(x + (particles_.vx[i] * 2)),
+                                              particle_to_pixel(y + (particles_.vy[i] * 2)));
+                    list.add_streak(start, end, palette_.color(depth), depth);
                 }
             }
         }
 
-        void stop() override
+        void stop()
         {
             particles_.clear();
         }
+
+        void respawn()
+        {
+            respawn_particles<Rain>(particles_, seg_properties_);
+        }
+
+        /**
+         * @brief Follow a new intensity, keeping the drops already falling.
+         */
+        void retune()
+        {
+            retune_particles(kParticlesPerPx);
+        }
     };
 
 } // namespace weather
@@ -8,7 +8,6 @@
 #include "particles/particle.h"
 
 #include <cmath>
-#include <memory>
 
 namespace weather
 	{
@@ -20,12 +19,14 @@ namespace weather
 		private:
 			static constexpr float MM_TO_INCH_CONST = 0.0393700787f;
 			static constexpr float STICK_PROBABILITY = 0.3f; // 30% chance to stick
+			static constexpr float kParticlesPerPx = 1.2f; // Flakes per pixel of width at intensity 1.
 
 			uint16_t accumulation_depth_pixels_;
 			uint16_t current_accumulation_height_ = 0; // Current snow height on ground
 			Color snow_color_ = kWhite;
 			bool is_ice_; // True for ice pellets
 			DisplaySegProperties &seg_properties_;
+			DepthPalette palette_; // Snow color shaded by depth.
 
 			// Convert snow accumulation (mm) to pixels
 			static uint16_t depth_to_pixels(float snow_depth, int16_t display_height)
@@ -38,68 +39,76 @@ namespace weather
 
 		public:
 			SnowEffect(DisplaySegProperties &seg_properties, const float accumulation, const bool is_ice = false)
-				: WeatherEffectBase(seg_properties), is_ice_(is_ice), seg_properties_(seg_properties)
+				: WeatherEffectBase(seg_properties), is_ice_(is_ice), seg_properties_(seg_properties), palette_(snow_color_)
 				{
 				// Calculate accumulation depth in pixels
 				accumulation_depth_pixels_ = depth_to_pixels(accumulation, seg_properties_.get_seg_bounds().y_end);
 				// Calculate spawn rate and max particles based on intensity
-				max_particles_ = roundf(seg_properties_.get_seg_bounds().w * 1.2f * seg_properties_.get_intensity());
+				max_particles_ = roundf(seg_properties_.get_seg_bounds().w * kParticlesPerPx * seg_properties_.get_intensity());
+				particles_.allocate(max_particles_);
 				}
 
-			void update_particles() override
+			void update_particles()
 				{
 				// Spawn new snowflakes based on spawn rate
-				if (particles_.size() < static_cast<size_t>(max_particles_) && get_rand_float() < spawn_rate_)
+				if (!particles_.full() && spawn_due())
 					{
-					particles_.push_back(std::make_unique<Snow>(seg_properties_));
+					spawn_particle<Snow>(particles_, seg_properties_);
 					}
 
 				windgust_.update();
 
 				if (windgust_.is_gust_alive())
 					{
-					// Update all particles...
-					for (const auto &flake: particles_)
-						{
-						windgust_.apply_wind(flake->get_positions(), flake->get_acceleration());
-						flake->update();
-						}
-					}
-				else
-					{
-					for (const auto &flake: particles_)
-						{
-						flake->update();
-						}
+					windgust_.apply_wind(particles_);
 					}
+
+				// Update all particles...
+				step_particles<Snow>(particles_, seg_properties_);
 				}
 
-			void draw(pimoroni::PicoZGraphics &graphics) override
+			void draw(DrawList &list)
 				{
-				// Draw falling snowflakes
-				for (const auto &flake: particles_)
+				// Draw falling snowflakes as one batch, shaded from the depth palette
+				palette_.update(snow_color_);
+				list.set_clip(seg_properties_.get_seg_bounds());
+				list.begin_points();
+				const uint16_t count = particles_.size();
+				for (uint16_t i = 0; i < count; i++)
 					{
-					if (flake->is_drawable())
+					const pimoroni::Point new_point(particle_to_pixel(particles_.x[i]), particle_to_pixel(particles_.y[i]));
+					if (seg_properties_.is_particle_in_segment(new_point))
 						{
-						Position &position = flake->get_positions();
-						graphics.set_pen((position.z * snow_color_.r), (position.z * snow_color_.g), (position.z * snow_color_.b));
-						graphics.set_depth(position.z);
-						pimoroni::Point new_point(position.x, position.y);
-						graphics.set_pixel(new_point);
+						list.add_point(new_point, palette_[particle_to_depth(particles_.z[i])]);
 						}
 					}
 
-				graphics.set_pen(255, 0, 0);
-				graphics.set_depth(255);
-				graphics.set_pixel(pimoroni::Point(windgust_.get_positions().x, windgust_.get_positions().y));
+				list.add_pixel(pimoroni::Point(windgust_.get_positions().x, windgust_.get_positions().y), pen_red, 255);
 				}
 
-			void stop() override
+			void stop()
 				{
 				particles_.clear();
 				current_accumulation_height_ = 0;
 				}
 
+			void respawn()
+				{
+				respawn_particles<Snow>(particles_, seg_properties_);
+				}
+
+			/**
+			 * @brief Follow a new intensity and accumulation, keeping the flakes
+			 * already falling and the snow already on the ground.
+			 *
+			 * @param accumulation Accumulation in mm.
+			 */
+			void retune(const float accumulation)
+				{
+				accumulation_depth_pixels_ = depth_to_pixels(accumulation, seg_properties_.get_seg_bounds().y_end);
+				retune_particles(kParticlesPerPx);
+				}
+
 			// Get current accumulation height for debugging/display
 			uint16_t get_accumulation_height() const
 				{
@@ -3,7 +3,7 @@
 
 #include "display/weather_effect_base.h"
 #include "misc.h"
-#include "pico/rand.h"
+#include "helpers_rand.h"
 
 namespace weather
 {
@@ -30,7 +30,7 @@ namespace weather
         {
         }
 
-        void update_particles() override
+        void update_particles()
         {
             // Update flash timer
             if (is_flashing_)
@@ -45,7 +45,7 @@ namespace weather
             else
             {
                 // Randomly trigger a flash
-                if (get_rand_32() % MIN_FLASH_INTERVAL == 0)
+                if (get_rand_uint32() % MIN_FLASH_INTERVAL == 0)
                 {
                     is_flashing_ = true;
                     flash_timer_ = 0;
@@ -53,23 +53,29 @@ namespace weather
             }
         }
 
-        void draw(pimoroni::PicoZGraphics &graphics) override
+        void draw(DrawList &list)
         {
             // Draw a white flash across the segment when lightning strikes
             if (is_flashing_)
             {
-                graphics.set_pen(pen_white);
-                graphics.set_depth((uint8_t)255);
                 // Simple flash effect - fill segment with white
                 // TODO: Could draw actual lightning bolts here
-                graphics.rectangle(seg_properties_.get_seg_bounds());
+                list.add_rect(seg_properties_.get_seg_bounds(), pen_white, 255);
             }
         }
 
-        void stop() override
+        void stop()
         {
             // Nothing to clean up
         }
+
+        /**
+         * @brief Follow a new storm intensity; a flash in progress finishes.
+         */
+        void retune(float intensity)
+        {
+            intensity_ = intensity;
+        }
     };
 
 } // namespace weather
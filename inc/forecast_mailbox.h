@@ -0,0 +1,79 @@
+#ifndef FORECAST_MAILBOX_H
+#define FORECAST_MAILBOX_H
+
+#include "day_forecast.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <span>
+
+/**
+ * @brief Hands a finished forecast from the fetch to the display loop.
+ *
+ * Two slots and a sequence number. publish() fills the slot readers aren't
+ * on and makes it current with a single atomic store; take() copies the
+ * current slot and retries if the sequence moved while it did. The display
+ * never sees half a forecast, and neither side waits on the other, so the
+ * fetch can run on either core. One publisher and one reader.
+ *
+ * @tparam kMaxDays Most days a forecast can hold.
+ */
+template <size_t kMaxDays>
+class ForecastMailbox
+{
+private:
+    std::array<std::array<DayForecast, kMaxDays>, 2> slots_{};
+    std::array<uint8_t, 2> counts_{};
+    std::atomic<uint32_t> sequence_{0}; // Forecasts published; the newest is in slots_[sequence_ & 1].
+    uint32_t taken_ = 0;                // Sequence of the forecast the reader last took.
+
+public:
+    /**
+     * @brief Make a forecast the newest, replacing any the reader hasn't taken yet.
+     */
+    void publish(const std::span<const DayForecast> days)
+    {
+        const uint32_t next = sequence_.load(std::memory_order_relaxed) + 1;
+        const uint8_t slot = next & 1;
+        counts_[slot] = static_cast<uint8_t>(std::min(days.size(), kMaxDays));
+        std::copy_n(days.begin(), counts_[slot], slots_[slot].begin());
+        sequence_.store(next, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy out the newest forecast, if there's one not taken yet.
+     *
+     * @param days Where to copy it.
+     * @return Days copied, 0 if nothing new has been published.
+     */
+    size_t take(const std::span<DayForecast> days)
+    {
+        while (true)
+        {
+            const uint32_t sequence = sequence_.load(std::memory_order_acquire);
+            if (sequence == taken_)
+            {
+                return 0;
+            }
+            const uint8_t slot = sequence & 1;
+            const size_t count = std::min<size_t>(counts_[slot], days.size());
+            std::copy_n(slots_[slot].begin(), count, days.begin());
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == sequence)
+            {
+                taken_ = sequence;
+                return count;
+            }
+        }
+    }
+
+    /**
+     * @brief Forecasts published so far.
+     */
+    [[nodiscard]] uint32_t published() const { return sequence_.load(std::memory_order_relaxed); }
+};
+
+#endif // FORECAST_MAILBOX_H
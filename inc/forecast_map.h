@@ -0,0 +1,42 @@
+#ifndef FORECAST_MAP_H
+#define FORECAST_MAP_H
+
+#include "day_forecast.h"
+#include "misc.h"
+
+#include <cstdio>
+#include <map>
+#include <string>
+
+/**
+ * @brief Debugging adapter: a day's forecast as the Tomorrow.io style key/value
+ * strings the display used to pass around. Nothing on the display path uses
+ * this; it exists so a forecast can be dumped in a readable form.
+ */
+inline std::map<std::string, std::string> forecast_to_map(const DayForecast &day)
+{
+    const auto clock = [](const uint16_t minutes)
+    {
+        char text[9];
+        snprintf(text, sizeof(text), "%02u:%02u:00", (minutes / 60) % 24, minutes % 60);
+        return std::string(text);
+    };
+
+    return {
+        {"weather_description", std::string(day.weather().description)},
+        {"weatherCodeDay", std::to_string(day.weather_code)},
+        {"temperature", std::to_string(day.temperature)},
+        {"windSpeed", std::to_string(day.wind_speed)},
+        {"windDirection", std::to_string(day.wind_direction)},
+        {"cloudCover", std::to_string(day.cloud_cover)},
+        {"precipitationProbability", std::to_string(day.precip_probability)},
+        {"precipitationType", std::string(precip_type_parser(day.precip_type))},
+        {"precipitationIntensity", std::to_string(day.precip_intensity)},
+        {"snowAccumulation", std::to_string(day.snow_accumulation)},
+        {"iceAccumulation", std::to_string(day.ice_accumulation)},
+        {"sunriseTime", clock(day.sunrise_minutes)},
+        {"sunsetTime", clock(day.sunset_minutes)},
+        {"day", std::string(day.day_name())}};
+}
+
+#endif // FORECAST_MAP_H
@@ -0,0 +1,581 @@
+#ifndef FORECAST_PARSER_H
+#define FORECAST_PARSER_H
+
+#include "day_forecast.h"
+#include "misc.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <span>
+#include <string_view>
+
+namespace weather
+{
+
+    /**
+     * @brief Streaming parser for Tomorrow.io timeline responses.
+     *
+     * Bytes are fed in as they arrive, in chunks of any size, and each field the
+     * display uses is written straight into the matching DayForecast as soon as
+     * its value ends. Nothing is built up in between: the parser keeps a small
+     * stack of open containers and one short token, so its memory use is fixed
+     * (see sizeof(ForecastParser)) and it never touches the heap.
+     *
+     * Fields are picked out of data.timelines[].intervals[i].values, with the day
+     * name worked out from intervals[i].startTime. The request should ask for
+     * the 1d timestep only; intervals beyond the days given are skipped.
+     */
+    class ForecastParser
+    {
+    public:
+        static constexpr uint8_t kMaxDepth = 16; // Deepest nesting of objects and arrays allowed.
+        static constexpr uint8_t kMaxToken = 40; // Longest key or value kept, longer ones are ignored.
+
+    private:
+        /**
+         * @brief Keys the parser cares about, either as fields or as containers on the path to them.
+         */
+        enum class Key : uint8_t
+        {
+            kOther,
+            kIntervals,
+            kValues,
+            kStartTime,
+            kWeatherCodeDay,
+            kTemperature,
+            kWindSpeed,
+            kWindDirection,
+            kCloudCover,
+            kPrecipProbability,
+            kPrecipIntensity,
+            kPrecipType,
+            kSnowAccumulation,
+            kIceAccumulation,
+            kSunriseTime,
+            kSunsetTime
+        };
+
+        static constexpr std::array<std::pair<std::string_view, Key>, 15> kKeys = {{
+            {"intervals", Key::kIntervals},
+            {"values", Key::kValues},
+            {"startTime", Key::kStartTime},
+            {"weatherCodeDay", Key::kWeatherCodeDay},
+            {"temperature", Key::kTemperature},
+            {"windSpeed", Key::kWindSpeed},
+            {"windDirection", Key::kWindDirection},
+            {"cloudCover", Key::kCloudCover},
+            {"precipitationProbability", Key::kPrecipProbability},
+            {"precipitationIntensity", Key::kPrecipIntensity},
+            {"precipitationType", Key::kPrecipType},
+            {"snowAccumulation", Key::kSnowAccumulation},
+            {"iceAccumulation", Key::kIceAccumulation},
+            {"sunriseTime", Key::kSunriseTime},
+            {"sunsetTime", Key::kSunsetTime},
+        }};
+
+        enum class State : uint8_t
+        {
+            kValue,        // Expecting a value.
+            kValueOrEnd,   // Just after '[': a value or ']'.
+            kKeyOrEnd,     // Just after '{': a key or '}'.
+            kKey,          // After ',' in an object: a key.
+            kColon,        // After a key.
+            kString,       // Inside a string.
+            kEscape,       // After a backslash in a string.
+            kUnicode,      // Inside a \uXXXX escape.
+            kNumber,       // Inside a number.
+            kLiteral,      // Inside true, false or null.
+            kAfterValue,   // After a value: ',' or the end of the container.
+            kDone,         // The whole document has been read.
+            kError         // The document isn't valid JSON, or nests too deep.
+        };
+
+        /**
+         * @brief One open object or array.
+         */
+        struct Level
+        {
+            bool array;    // Array if true, object if false.
+            Key key;       // Key this container is the value of.
+            uint8_t index; // Elements seen so far, for arrays.
+        };
+
+        std::span<DayForecast> days_;           // Where parsed days go.
+        std::array<Level, kMaxDepth> stack_{};  // Open containers, outermost first.
+        std::array<char, kMaxToken + 1> token_{}; // Key or scalar being read.
+        uint8_t depth_ = 0;                     // Number of open containers.
+        uint8_t token_len_ = 0;                 // Characters in token_.
+        bool token_overflow_ = false;           // Token was longer than kMaxToken.
+        bool string_is_key_ = false;            // String being read is a key.
+        uint8_t unicode_left_ = 0;              // Hex digits left in a \uXXXX escape.
+        Key key_ = Key::kOther;                 // Key of the value being read.
+        State state_ = State::kValue;
+        uint8_t days_parsed_ = 0;               // Days that got at least one field.
+
+        static constexpr bool is_space(const char c)
+        {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        }
+
+        static Key lookup(const std::string_view key)
+        {
+            for (const auto &[name, value] : kKeys)
+            {
+                if (name == key)
+                {
+                    return value;
+                }
+            }
+            return Key::kOther;
+        }
+
+        void start_token(const char c = '\0')
+        {
+            token_len_ = 0;
+            token_overflow_ = false;
+            if (c != '\0')
+            {
+                append(c);
+            }
+        }
+
+        void append(const char c)
+        {
+            if (token_len_ < kMaxToken)
+            {
+                token_[token_len_++] = c;
+            }
+            else
+            {
+                token_overflow_ = true;
+            }
+        }
+
+        [[nodiscard]] std::string_view token() const { return {token_.data(), token_len_}; }
+
+        bool push(const bool array)
+        {
+            if (depth_ >= kMaxDepth)
+            {
+                state_ = State::kError;
+                return false;
+            }
+            stack_[depth_++] = {array, key_, 0};
+
+            // A new interval starts from a clean day, so nothing leaks over from a previous parse.
+            if (DayForecast *day = current_day(0))
+            {
+                *day = DayForecast{};
+            }
+
+            key_ = Key::kOther;
+            state_ = array ? State::kValueOrEnd : State::kKeyOrEnd;
+            return true;
+        }
+
+        void pop(const bool array)
+        {
+            if (depth_ == 0 || stack_[depth_ - 1].array != array)
+            {
+                state_ = State::kError;
+                return;
+            }
+            depth_--;
+            state_ = depth_ == 0 ? State::kDone : State::kAfterValue;
+        }
+
+        /**
+         * @brief The day being filled in, if the innermost open containers are
+         * "intervals": [ ... { ... and then levels_below more.
+         */
+        DayForecast *current_day(const uint8_t levels_below)
+        {
+            if (depth_ < levels_below + 2)
+            {
+                return nullptr;
+            }
+            const Level &intervals = stack_[depth_ - levels_below - 2];
+            const Level &interval = stack_[depth_ - levels_below - 1];
+            if (!intervals.array || intervals.key != Key::kIntervals || interval.array || intervals.index >= days_.size())
+            {
+                return nullptr;
+            }
+            return &days_[intervals.index];
+        }
+
+        /**
+         * @brief Minutes after midnight of an ISO 8601 time, e.g. "2026-10-16T07:12:00-04:00".
+         */
+        static uint16_t clock_minutes(const std::string_view time)
+        {
+            const size_t t = time.find('T');
+            if (t == std::string_view::npos || t + 5 >= time.size())
+            {
+                return 0;
+            }
+            const auto digit = [&time](const size_t i)
+            { return static_cast<uint16_t>(time[i] - '0'); };
+            return (digit(t + 1) * 10 + digit(t + 2)) * 60 + digit(t + 4) * 10 + digit(t + 5);
+        }
+
+        /**
+         * @brief Day of the week of an ISO 8601 date, by Zeller's congruence.
+         */
+        static std::string_view day_of_week(const std::string_view time)
+        {
+            if (time.size() < 10)
+            {
+                return {};
+            }
+            const auto number = [&time](const size_t start, const size_t digits)
+            {
+                int value = 0;
+                for (size_t i = start; i < start + digits; i++)
+                {
+                    value = value * 10 + (time[i] - '0');
+                }
+                return value;
+            };
+            int y = number(0, 4);
+            int month = number(5, 2);
+            const int day = number(8, 2);
+
+            if (month < 3)
+            {
+                month += 12;
+                y--;
+            }
+            const int h = (day + (13 * (month + 1)) / 5 + y + y / 4 - y / 100 + y / 400) % 7;
+            return DAYS_OF_WEEK[h];
+        }
+
+        /**
+         * @brief Store a finished scalar if it's one of the fields we want.
+         */
+        void store_scalar(const bool is_string)
+        {
+            if (token_overflow_)
+            {
+                return;
+            }
+
+            token_[token_len_] = '\0';
+
+            if (key_ == Key::kStartTime && is_string)
+            {
+                if (DayForecast *day = current_day(0))
+                {
+                    day->set_day_name(day_of_week(token()));
+                }
+                return;
+            }
+
+            DayForecast *day = current_day(1);
+            if (day == nullptr || stack_[depth_ - 1].key != Key::kValues || stack_[depth_ - 1].array)
+            {
+                return;
+            }
+
+            const float number = is_string ? 0.0f : strtof(token_.data(), nullptr);
+            switch (key_)
+            {
+            case Key::kWeatherCodeDay:
+                day->weather_code = static_cast<uint32_t>(number);
+                break;
+            case Key::kTemperature:
+                day->temperature = number;
+                break;
+            case Key::kWindSpeed:
+                day->wind_speed = number;
+                break;
+            case Key::kWindDirection:
+                day->wind_direction = number;
+                break;
+            case Key::kCloudCover:
+                day->cloud_cover = static_cast<uint8_t>(std::clamp(number, 0.0f, 100.0f) + 0.5f);
+                break;
+            case Key::kPrecipProbability:
+                day->precip_probability = static_cast<uint8_t>(std::clamp(number, 0.0f, 100.0f) + 0.5f);
+                break;
+            case Key::kPrecipIntensity:
+                day->precip_intensity = number;
+                break;
+            case Key::kPrecipType:
+                day->precip_type = static_cast<uint8_t>(number);
+                break;
+            case Key::kSnowAccumulation:
+                day->snow_accumulation = number;
+                break;
+            case Key::kIceAccumulation:
+                day->ice_accumulation = number;
+                break;
+            case Key::kSunriseTime:
+                day->sunrise_minutes = clock_minutes(token());
+                break;
+            case Key::kSunsetTime:
+                day->sunset_minutes = clock_minutes(token());
+                break;
+            default:
+                return;
+            }
+
+            days_parsed_ = std::max<uint8_t>(days_parsed_, stack_[depth_ - 3].index + 1);
+        }
+
+        void after_value()
+        {
+            state_ = State::kAfterValue;
+        }
+
+        /**
+         * @brief Start whatever value c begins.
+         */
+        void begin_value(const char c)
+        {
+            if (c == '{')
+            {
+                push(false);
+            }
+            else if (c == '[')
+            {
+                push(true);
+            }
+            else if (c == '"')
+            {
+                string_is_key_ = false;
+                start_token();
+                state_ = State::kString;
+            }
+            else if (c == '-' || (c >= '0' && c <= '9'))
+            {
+                start_token(c);
+                state_ = State::kNumber;
+            }
+            else if (c == 't' || c == 'f' || c == 'n')
+            {
+                state_ = State::kLiteral;
+            }
+            else
+            {
+                state_ = State::kError;
+            }
+        }
+
+        void step(const char c)
+        {
+            switch (state_)
+            {
+            case State::kValueOrEnd:
+                if (is_space(c))
+                {
+                    return;
+                }
+                if (c == ']')
+                {
+                    pop(true);
+                    return;
+                }
+                begin_value(c);
+                return;
+
+            case State::kValue:
+                if (!is_space(c))
+                {
+                    begin_value(c);
+                }
+                return;
+
+            case State::kKeyOrEnd:
+            case State::kKey:
+                if (is_space(c))
+                {
+                    return;
+                }
+                if (c == '}' && state_ == State::kKeyOrEnd)
+                {
+                    pop(false);
+                }
+                else if (c == '"')
+                {
+                    string_is_key_ = true;
+                    start_token();
+                    state_ = State::kString;
+                }
+                else
+                {
+                    state_ = State::kError;
+                }
+                return;
+
+            case State::kColon:
+                if (c == ':')
+                {
+                    state_ = State::kValue;
+                }
+                else if (!is_space(c))
+                {
+                    state_ = State::kError;
+                }
+                return;
+
+            case State::kString:
+                if (c == '\\')
+                {
+                    state_ = State::kEscape;
+                }
+                else if (c == '"')
+                {
+                    if (string_is_key_)
+                    {
+                        key_ = token_overflow_ ? Key::kOther : lookup(token());
+                        state_ = State::kColon;
+                    }
+                    else
+                    {
+                        store_scalar(true);
+                        after_value();
+                    }
+                }
+                else
+                {
+                    append(c);
+                }
+                return;
+
+            case State::kEscape:
+                if (c == 'u')
+                {
+                    // The fields we read are plain ASCII; other characters only need skipping.
+                    append('?');
+                    unicode_left_ = 4;
+                    state_ = State::kUnicode;
+                    return;
+                }
+                append(c == 'n' ? '\n' : c == 't' ? '\t' : c);
+                state_ = State::kString;
+                return;
+
+            case State::kUnicode:
+                if (--unicode_left_ == 0)
+                {
+                    state_ = State::kString;
+                }
+                return;
+
+            case State::kNumber:
+                if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-')
+                {
+                    append(c);
+                    return;
+                }
+                store_scalar(false);
+                after_value();
+                step(c);
+                return;
+
+            case State::kLiteral:
+                if (c >= 'a' && c <= 'z')
+                {
+                    return;
+                }
+                after_value();
+                step(c);
+                return;
+
+            case State::kAfterValue:
+                if (is_space(c))
+                {
+                    return;
+                }
+                if (c == ',' && depth_ > 0)
+                {
+                    Level &level = stack_[depth_ - 1];
+                    if (level.array)
+                    {
+                        level.index++;
+                        key_ = Key::kOther;
+                        state_ = State::kValue;
+                    }
+                    else
+                    {
+                        state_ = State::kKey;
+                    }
+                }
+                else if (c == '}')
+                {
+                    pop(false);
+                }
+                else if (c == ']')
+                {
+                    pop(true);
+                }
+                else
+                {
+                    state_ = State::kError;
+                }
+                return;
+
+            case State::kDone:
+                if (!is_space(c))
+                {
+                    state_ = State::kError;
+                }
+                return;
+
+            case State::kError:
+                return;
+            }
+        }
+
+    public:
+        /**
+         * @param days Days to fill in, from today. Intervals beyond these are skipped.
+         */
+        explicit ForecastParser(const std::span<DayForecast> days) : days_(days) {}
+
+        /**
+         * @brief Start again on a new response, filling the same days.
+         */
+        void reset()
+        {
+            depth_ = 0;
+            token_len_ = 0;
+            token_overflow_ = false;
+            key_ = Key::kOther;
+            state_ = State::kValue;
+            days_parsed_ = 0;
+        }
+
+        /**
+         * @brief Parse the next chunk of the response.
+         *
+         * @param data Bytes received.
+         * @param size Number of bytes.
+         * @return false once the response turns out not to be valid JSON.
+         */
+        bool feed(const char *data, const size_t size)
+        {
+            for (size_t i = 0; i < size && state_ != State::kError; i++)
+            {
+                step(data[i]);
+            }
+            return state_ != State::kError;
+        }
+
+        bool feed(const std::string_view data)
+        {
+            return feed(data.data(), data.size());
+        }
+
+        /**
+         * @brief Whether the whole response has been read and held at least one day.
+         */
+        [[nodiscard]] bool complete() const { return state_ == State::kDone && days_parsed_ > 0; }
+        [[nodiscard]] bool failed() const { return state_ == State::kError; }
+        [[nodiscard]] uint8_t days_parsed() const { return days_parsed_; }
+    };
+
+} // namespace weather
+
+#endif // FORECAST_PARSER_H
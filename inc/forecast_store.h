@@ -0,0 +1,348 @@
+#ifndef FORECAST_STORE_H
+#define FORECAST_STORE_H
+
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+
+#include "day_forecast.h"
+#include "display/core1_worker.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+
+/**
+ * @brief Keeps the last good forecast in flash, so it can be shown at boot.
+ *
+ * The last kSectors sectors of flash hold a log of records, each a header,
+ * the days as raw DayForecasts and a CRC. Records are appended page by page;
+ * a sector is only erased when the log comes back round to it, so the erases
+ * are spread evenly and each costs a sector of records. The newest valid
+ * record wins at load. A record cut short by a power cut fails its CRC and
+ * the one before it is used.
+ *
+ * An erase stalls core 0 for tens of ms with interrupts off, so the panel's
+ * refresh stops with it. erase_ahead() does it early, when the display is
+ * idle, so the saves that follow only program.
+ *
+ * Records carry a format version and sizeof(DayForecast), so a firmware
+ * with a different layout ignores them rather than misreading them.
+ *
+ * @tparam kMaxDays Most days a record can hold.
+ */
+template <size_t kMaxDays>
+class ForecastStore
+{
+public:
+    static constexpr uint32_t kSectors = 2;                                                   // Sectors set aside for the log.
+    static constexpr uint32_t kOffset = PICO_FLASH_SIZE_BYTES - kSectors * FLASH_SECTOR_SIZE; // Start of the log in flash.
+    static constexpr uint32_t kMagic = 0x43465857;                                            // "WXFC"
+    static constexpr uint8_t kVersion = 1;
+    static constexpr uint32_t kRewriteAfterS = 60 * 60; // An unchanged forecast is only stored again after this long.
+
+    /**
+     * @brief Start of each record.
+     */
+    struct Header
+    {
+        uint32_t magic;        // kMagic.
+        uint8_t version;       // kVersion.
+        uint8_t days;          // Days that follow.
+        uint16_t day_bytes;    // sizeof(DayForecast) of the firmware that wrote it.
+        uint32_t sequence;     // Counts up with each record; the highest is the newest.
+        uint32_t fetched_unix; // When the forecast was fetched, 0 if the time wasn't known.
+    };
+    static_assert(sizeof(Header) == 16);
+
+private:
+    static constexpr uint32_t kPages = kSectors * FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE;
+    static constexpr uint32_t kPagesPerSector = FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE;
+    static constexpr size_t kMaxRecordBytes = sizeof(Header) + kMaxDays * sizeof(DayForecast) + sizeof(uint32_t);
+    static constexpr uint32_t kMaxRecordPages = (kMaxRecordBytes + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+    static_assert(kMaxRecordPages <= kPagesPerSector, "A record must fit in a sector");
+    static_assert(kSectors >= 2, "The sector being erased must never hold the newest record");
+
+    /**
+     * @brief A flash operation, run on core 0 with core 1 parked.
+     */
+    struct FlashWrite
+    {
+        uint32_t offset;     // Where to program, from the start of flash.
+        const uint8_t *data; // Whole pages to program.
+        size_t size;         // 0 to only erase.
+        bool erase;          // Erase the sector at offset first.
+    };
+
+    std::array<uint8_t, kMaxRecordPages * FLASH_PAGE_SIZE> buffer_{}; // Record being written.
+    int32_t newest_page_ = -1;   // First page of the newest valid record, -1 if none.
+    Header newest_{};            // Its header.
+    uint32_t next_page_ = 0;     // Where the next record goes.
+
+    uint32_t writes_ = 0;        // Records written since boot.
+    uint32_t skipped_ = 0;       // Saves skipped by the rewrite policy since boot.
+    uint32_t erases_ = 0;        // Sectors erased since boot.
+
+    static const uint8_t *page(const uint32_t index)
+    {
+        return reinterpret_cast<const uint8_t *>(XIP_BASE + kOffset + index * FLASH_PAGE_SIZE);
+    }
+
+    static constexpr uint32_t record_pages(const uint8_t days)
+    {
+        const size_t bytes = sizeof(Header) + days * sizeof(DayForecast) + sizeof(uint32_t);
+        return (bytes + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+    }
+
+    static uint32_t crc32(const uint8_t *data, const size_t size)
+    {
+        uint32_t crc = 0xFFFFFFFF;
+        for (size_t i = 0; i < size; i++)
+        {
+            crc ^= data[i];
+            for (uint8_t bit = 0; bit < 8; bit++)
+            {
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+            }
+        }
+        return ~crc;
+    }
+
+    /**
+     * @brief Whether a valid record starts at this page.
+     */
+    static bool valid_record(const uint32_t index, Header &header)
+    {
+        std::memcpy(&header, page(index), sizeof(header));
+        if (header.magic != kMagic || header.version != kVersion || header.day_bytes != sizeof(DayForecast) ||
+            header.days == 0 || header.days > kMaxDays || index % kPagesPerSector + record_pages(header.days) > kPagesPerSector)
+        {
+            return false;
+        }
+        const size_t size = sizeof(Header) + header.days * sizeof(DayForecast);
+        uint32_t crc;
+        std::memcpy(&crc, page(index) + size, sizeof(crc));
+        return crc == crc32(page(index), size);
+    }
+
+    static bool blank(const uint32_t first, const uint32_t count)
+    {
+        const uint8_t *data = page(first);
+        return std::all_of(data, data + count * FLASH_PAGE_SIZE, [](const uint8_t byte)
+                           { return byte == 0xFF; });
+    }
+
+    static void flash_job(void *arg)
+    {
+        const auto *write = static_cast<const FlashWrite *>(arg);
+        const uint32_t interrupts = save_and_disable_interrupts();
+        if (write->erase)
+        {
+            flash_range_erase(write->offset, FLASH_SECTOR_SIZE);
+        }
+        if (write->size > 0)
+        {
+            flash_range_program(write->offset, write->data, write->size);
+        }
+        restore_interrupts(interrupts);
+    }
+
+    /**
+     * @brief Find the newest record and where the next one goes.
+     */
+    void scan()
+    {
+        newest_page_ = -1;
+        for (uint32_t index = 0; index < kPages; index++)
+        {
+            Header header;
+            if (valid_record(index, header) && (newest_page_ < 0 || header.sequence > newest_.sequence))
+            {
+                newest_page_ = static_cast<int32_t>(index);
+                newest_ = header;
+            }
+        }
+        next_page_ = newest_page_ < 0 ? 0 : (newest_page_ + record_pages(newest_.days)) % kPages;
+    }
+
+    /**
+     * @brief Find blank pages for the next record. Records don't straddle
+     * sectors, and a sector is only erased from its start, so the newest
+     * record is never erased.
+     *
+     * @param pages Pages the record takes.
+     * @param first Set to its first page.
+     * @param erase Set if that sector has to be erased first.
+     * @return false if there's nowhere to put it.
+     */
+    bool find_slot(const uint32_t pages, uint32_t &first, bool &erase) const
+    {
+        first = next_page_;
+        erase = false;
+        for (uint32_t tries = 0; tries <= kSectors; tries++)
+        {
+            if (first % kPagesPerSector + pages > kPagesPerSector)
+            {
+                first = (first / kPagesPerSector + 1) * kPagesPerSector % kPages;
+            }
+            if (blank(first, pages))
+            {
+                return true;
+            }
+            if (first % kPagesPerSector == 0)
+            {
+                erase = true;
+                return true;
+            }
+            // Left over from a cut-short write: move on to the next sector.
+            first = (first / kPagesPerSector + 1) * kPagesPerSector % kPages;
+        }
+        return false;
+    }
+
+    void erase_sector(const uint32_t sector)
+    {
+        FlashWrite write{kOffset + sector * FLASH_SECTOR_SIZE, nullptr, 0, true};
+        Core1Worker::run_with_core1_parked(flash_job, &write);
+        erases_++;
+    }
+
+public:
+    ForecastStore() { scan(); }
+
+    /**
+     * @brief Read the newest stored forecast.
+     *
+     * @param days Where to copy the days.
+     * @param fetched_unix Set to when it was fetched, 0 if unknown.
+     * @return Days copied, 0 if nothing is stored.
+     */
+    size_t load(const std::span<DayForecast> days, uint32_t &fetched_unix) const
+    {
+        if (newest_page_ < 0)
+        {
+            return 0;
+        }
+        const size_t count = std::min<size_t>(newest_.days, days.size());
+        std::memcpy(days.data(), page(newest_page_) + sizeof(Header), count * sizeof(DayForecast));
+        fetched_unix = newest_.fetched_unix;
+        return count;
+    }
+
+    /**
+     * @brief Store a forecast, unless it's the one already stored and that was
+     * stored less than kRewriteAfterS ago.
+     *
+     * Core 1 is parked and interrupts are off for the duration: about a
+     * millisecond to program, plus a sector erase each time the log moves
+     * into a new sector that erase_ahead() hasn't already erased.
+     *
+     * @param days Days to store, at most kMaxDays.
+     * @param fetched_unix When the forecast was fetched, 0 if unknown.
+     * @return true if a record was written, false if it was skipped or
+     * there was nowhere blank to write it.
+     */
+    bool save(std::span<const DayForecast> days, const uint32_t fetched_unix)
+    {
+        days = days.first(std::min(days.size(), kMaxDays));
+        if (days.empty())
+        {
+            return false;
+        }
+
+        if (newest_page_ >= 0 && newest_.days == days.size() && fetched_unix >= newest_.fetched_unix &&
+            fetched_unix - newest_.fetched_unix < kRewriteAfterS &&
+            std::memcmp(page(newest_page_) + sizeof(Header), days.data(), days.size_bytes()) == 0)
+        {
+            skipped_++;
+            return false;
+        }
+
+        // Build the record.
+        const Header header{kMagic, kVersion, static_cast<uint8_t>(days.size()), sizeof(DayForecast),
+                            newest_page_ < 0 ? 1 : newest_.sequence + 1, fetched_unix};
+        const size_t size = sizeof(Header) + days.size_bytes();
+        const uint32_t pages = record_pages(header.days);
+        buffer_.fill(0xFF);
+        std::memcpy(buffer_.data(), &header, sizeof(header));
+        std::memcpy(buffer_.data() + sizeof(header), days.data(), days.size_bytes());
+        const uint32_t crc = crc32(buffer_.data(), size);
+        std::memcpy(buffer_.data() + size, &crc, sizeof(crc));
+
+        uint32_t first;
+        bool erase;
+        if (!find_slot(pages, first, erase))
+        {
+            printf("Forecast store: no blank pages for a %lu page record\n", static_cast<unsigned long>(pages));
+            return false;
+        }
+
+        FlashWrite write{kOffset + first * FLASH_PAGE_SIZE, buffer_.data(), pages * FLASH_PAGE_SIZE, erase};
+        Core1Worker::run_with_core1_parked(flash_job, &write);
+        erases_ += erase;
+
+        Header check;
+        if (!valid_record(first, check))
+        {
+            printf("Forecast store: record at page %lu didn't verify\n", static_cast<unsigned long>(first));
+            scan();
+            return false;
+        }
+        newest_page_ = static_cast<int32_t>(first);
+        newest_ = header;
+        next_page_ = (first + pages) % kPages;
+        writes_++;
+        return true;
+    }
+
+    /**
+     * @brief Erase the sector the coming records go in, if it isn't blank,
+     * so the saves into it only program. That is the sector the next record
+     * would erase, or failing that the one after the newest record's, which
+     * never holds the newest record. Call it when a stall of the display
+     * won't be seen.
+     *
+     * @return true if a sector was erased.
+     */
+    bool erase_ahead()
+    {
+        uint32_t first;
+        bool erase;
+        if (find_slot(record_pages(newest_page_ < 0 ? kMaxDays : newest_.days), first, erase) && erase)
+        {
+            erase_sector(first / kPagesPerSector);
+            return true;
+        }
+
+        const uint32_t sector = (next_page_ / kPagesPerSector + 1) % kSectors;
+        if (newest_page_ >= 0 && static_cast<uint32_t>(newest_page_) / kPagesPerSector == sector)
+        {
+            return false;
+        }
+        if (blank(sector * kPagesPerSector, kPagesPerSector))
+        {
+            return false;
+        }
+        erase_sector(sector);
+        return true;
+    }
+
+    [[nodiscard]] bool has_forecast() const { return newest_page_ >= 0; }
+    [[nodiscard]] const Header &newest() const { return newest_; }
+    [[nodiscard]] uint32_t newest_page() const { return newest_page_; }
+    [[nodiscard]] uint32_t writes() const { return writes_; }
+    [[nodiscard]] uint32_t skipped() const { return skipped_; }
+    [[nodiscard]] uint32_t erases() const { return erases_; }
+
+    /**
+     * @brief Records that fit in the log before it comes back round.
+     */
+    [[nodiscard]] static constexpr uint32_t records_per_cycle(const uint8_t days)
+    {
+        return kSectors * (kPagesPerSector / record_pages(days));
+    }
+};
+
+#endif // FORECAST_STORE_H
@@ -1,30 +1,68 @@
 #ifndef HELP_RAN_H
 #define HELP_RAN_H
 
-#include "pico/rand.h"
+#include "pico/stdlib.h"
 #include <cmath>
 #include <array>
 
 constexpr float kUint32MaxInv = 1.0f / UINT32_MAX;
 constexpr float kUint16MaxInv = 1.0f / UINT16_MAX;
 
+/**
+ * @brief Small, fast, seedable generator (xoshiro128++).
+ *
+ * Everything here is 32-bit shifts, rotates and adds, so a call costs a few
+ * cycles on the M33, far less than a trip to the hardware-backed get_rand_32().
+ * Seeding the same value always gives the same sequence, which makes runs
+ * reproducible.
+ */
 class RNG
 {
-    static constexpr uint16_t kRNGTableSize = 512;
-    std::array<uint16_t, kRNGTableSize> rng_table_;
-    uint16_t table_counter_;
+    std::array<uint32_t, 4> state_;
+
+    static constexpr uint32_t rotl(const uint32_t x, const int k)
+    {
+        return (x << k) | (x >> (32 - k));
+    }
+
+    /**
+     * @brief SplitMix64 step, spreads a seed out over the whole state.
+     */
+    static constexpr uint64_t split_mix(uint64_t &x)
+    {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
 
 public:
-    RNG()
+    explicit RNG(const uint64_t seed = 0)
     {
-        for (auto it = rng_table_.begin(); it < rng_table_.end(); it += 4)
-        {
-            uint64_t value = get_rand_64();
-            *it = value & 0xFFFF;               // Bits 0-15
-            *(it + 1) = (value >> 16) & 0xFFFF; // Bits 16-31
-            *(it + 2) = (value >> 32) & 0xFFFF; // Bits 32-47
-            *(it + 3) = (value >> 48) & 0xFFFF; // Bits 48-63
-        }
+        this->seed(seed);
+    }
+
+    void seed(uint64_t seed)
+    {
+        const uint64_t a = split_mix(seed);
+        const uint64_t b = split_mix(seed);
+        state_ = {static_cast<uint32_t>(a), static_cast<uint32_t>(a >> 32),
+                  static_cast<uint32_t>(b), static_cast<uint32_t>(b >> 32)};
+    }
+
+    uint32_t next()
+    {
+        const uint32_t result = rotl(state_[0] + state_[3], 7) + state_[0];
+        const uint32_t t = state_[1] << 9;
+
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 11);
+
+        return result;
     }
 
     /**
@@ -34,34 +72,48 @@ public:
      */
     float get_random_float()
     {
-        table_counter_ = (table_counter_ + 1) % (kRNGTableSize - 1);
-        return (rng_table_[table_counter_] * kUint16MaxInv);
-    }
-
-    uint16_t get_random_uint16()
-    {
-        table_counter_ = (table_counter_ + 1) % (kRNGTableSize - 1);
-        return (rng_table_[table_counter_]);
+        return next() * kUint32MaxInv;
     }
 
     /**
-     * @brief Get a random float between the two values given.
+     * @brief Fill an array with random floats between 0 and 1.0f.
      *
-     * @param start
-     * @param end
-     * @return float
+     * @param out Array to fill.
+     * @param count Number of floats.
      */
-    float get_float_interval(float start, float end)
+    void fill(float *out, const uint16_t count)
     {
-        float rng = get_random_float();
-        start = std::clamp(start, 0.0f, end);
-        end = std::clamp(end, start, MAXFLOAT);
-        float slope = (end - start);
-        return (start + (slope * rng));
+        for (uint16_t i = 0; i < count; i++)
+        {
+            out[i] = next() * kUint32MaxInv;
+        }
     }
 };
 
-// extern RNG rng_class;
+inline std::array<RNG, 2> core_rngs;  // One generator per core, so neither core touches the other's state.
+inline uint64_t rng_seed = 0;         // Seed last passed to seed_rng().
+
+/**
+ * @brief The generator belonging to the calling core.
+ */
+inline RNG &rng()
+{
+    return core_rngs[get_core_num()];
+}
+
+/**
+ * @brief Seed both cores' generators. Each core gets its own stream derived
+ * from the seed, so a run is repeatable as long as the same work lands on the
+ * same core.
+ *
+ * @param seed Any value.
+ */
+inline void seed_rng(const uint64_t seed)
+{
+    rng_seed = seed;
+    core_rngs[0].seed(seed);
+    core_rngs[1].seed(~seed);
+}
 
 /**
  * @brief Get a random float between 0 and 1.0f
@@ -70,9 +122,34 @@ public:
  */
 inline float get_rand_float()
 {
-    return (get_rand_32()) / static_cast<float>(UINT32_MAX);
+    return rng().get_random_float();
 }
 
+/**
+ * @brief Maps random floats between 0 and 1.0f onto an interval. The clamping
+ * is worked out once, so one mapping can be reused across a whole batch.
+ */
+struct RandInterval
+{
+    float start = 0.0f;
+    float slope = 0.0f;
+
+    RandInterval() = default;
+
+    RandInterval(float start, float end)
+    {
+        start = std::clamp(start, std::numeric_limits<float>::min(), end);
+        end = std::clamp(end, start, MAXFLOAT);
+        this->start = start;
+        slope = end - start;
+    }
+
+    float operator()(const float unit) const
+    {
+        return start + (slope * unit);
+    }
+};
+
 /**
  * @brief Get the rand float, mapped to between start and end.
  *
@@ -82,11 +159,49 @@ inline float get_rand_float()
  */
 inline float get_rand_float(float start, float end)
 {
-    const uint32_t num = get_rand_32();
-    start = std::clamp(start, std::numeric_limits<float>::min(), end);
-    end = std::clamp(end, start, MAXFLOAT);
-    const float slope = (float)(end - start) / (UINT32_MAX);
-    return (start + (slope * num));
+    return RandInterval(start, end)(rng().get_random_float());
+}
+
+/**
+ * @brief Fill an array with random floats between 0 and 1.0f.
+ *
+ * @param out Array to fill.
+ * @param count Number of floats.
+ */
+inline void get_rand_floats(float *out, const uint16_t count)
+{
+    rng().fill(out, count);
+}
+
+/**
+ * @brief Fill an array with random floats mapped to between start and end.
+ * Cheaper than count calls to get_rand_float(start, end): the generator is
+ * looked up and the interval clamped once, and the mapping is a plain loop
+ * the compiler can unroll.
+ *
+ * @param out Array to fill.
+ * @param count Number of floats.
+ * @param start
+ * @param end
+ */
+inline void get_rand_floats(float *out, const uint16_t count, const float start, const float end)
+{
+    const RandInterval interval(start, end);
+    rng().fill(out, count);
+    for (uint16_t i = 0; i < count; i++)
+    {
+        out[i] = interval(out[i]);
+    }
+}
+
+/**
+ * @brief Get a random 32-bit number.
+ *
+ * @return uint32_t
+ */
+inline uint32_t get_rand_uint32()
+{
+    return rng().next();
 }
 
 /**
@@ -98,7 +213,7 @@ inline float get_rand_float(float start, float end)
  */
 inline uint32_t get_rand_uint32(uint32_t start, uint32_t end)
 {
-    const uint32_t num = get_rand_32();
+    const uint32_t num = rng().next();
     start = std::clamp(start, (uint32_t)0, end);
     end = std::clamp(end, start, UINT32_MAX);
     const float slope = (float)(end - start) / UINT32_MAX;
@@ -0,0 +1,569 @@
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include "pico/cyw43_arch.h"
+#include "pico/time.h"
+
+#include "lwip/altcp.h"
+#include "lwip/altcp_tcp.h"
+#include "lwip/altcp_tls.h"
+#include "lwip/dns.h"
+#include "mbedtls/ssl.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace weather
+{
+
+    /**
+     * @brief Where an HttpGet is up to.
+     */
+    enum class FetchState : uint8_t
+    {
+        kIdle,       // Nothing started.
+        kResolving,  // Waiting on DNS.
+        kConnecting, // Waiting on the TCP (and TLS) handshake.
+        kHeaders,    // Request sent, reading the status line and headers.
+        kBody,       // Reading the body into the sink.
+        kDone,       // Whole body read.
+        kFailed      // Connection, protocol or timeout error.
+    };
+
+    inline const char *fetch_state_name(const FetchState state)
+    {
+        switch (state)
+        {
+        case FetchState::kIdle:
+            return "idle";
+        case FetchState::kResolving:
+            return "resolving";
+        case FetchState::kConnecting:
+            return "connecting";
+        case FetchState::kHeaders:
+            return "headers";
+        case FetchState::kBody:
+            return "body";
+        case FetchState::kDone:
+            return "done";
+        case FetchState::kFailed:
+            return "failed";
+        }
+        return "unknown";
+    }
+
+    /**
+     * @brief A single HTTP/1.1 GET that never blocks.
+     *
+     * start() only sends off the DNS query or connect; everything after happens
+     * in lwIP callbacks, which in poll mode run inside cyw43_arch_poll(). The
+     * owner calls that once a frame whether a fetch is running or not, then
+     * poll(). Each call does what the network has delivered since the last and
+     * returns, so a fetch costs a frame at most one or two TCP segments of work.
+     *
+     * The body is handed to the Sink as it arrives, with chunked transfer
+     * encoding undone. Sink needs bool feed(const char *data, size_t size),
+     * returning false to give up on the response.
+     *
+     * Over TLS the server's certificate must chain to the root CA given at
+     * construction, or the handshake fails. Building with WEATHER_INSECURE_TLS
+     * skips the check, for debugging only.
+     */
+    template <typename Sink>
+    class HttpGet
+    {
+    public:
+        static constexpr uint8_t kMaxLine = 128; // Longest header line kept, longer ones are only skipped.
+
+    private:
+        /**
+         * @brief Where the response decoder is up to, below the level of FetchState.
+         */
+        enum class Decode : uint8_t
+        {
+            kStatusLine,
+            kHeaderLine,
+            kIdentity,     // Body without chunks: up to Content-Length or the connection closing.
+            kChunkSize,    // Chunk size line.
+            kChunkData,    // Inside a chunk.
+            kChunkDataEnd, // CRLF after a chunk.
+            kTrailers      // Trailer lines after the last chunk.
+        };
+
+        Sink &sink_;
+        altcp_pcb *pcb_ = nullptr;
+        std::string host_;
+        std::string request_;
+        uint16_t port_ = 0;
+        bool tls_ = false;
+        const char *root_ca_;                    // PEM certificate the server must chain to.
+        altcp_tls_config *tls_config_ = nullptr; // Made on the first TLS connect.
+
+        FetchState state_ = FetchState::kIdle;
+        Decode decode_ = Decode::kStatusLine;
+        uint64_t started_us_ = 0;
+        uint64_t finished_us_ = 0;
+        uint64_t timeout_us_ = 0;
+        bool aborted_ = false; // close() aborted the pcb; a callback running on it must return ERR_ABRT.
+
+        std::array<char, kMaxLine> line_{}; // Status, header or chunk size line being read.
+        uint8_t line_len_ = 0;
+        uint16_t status_ = 0;
+        bool chunked_ = false;
+        bool has_length_ = false;
+        size_t remaining_ = 0;   // Body bytes left in the response or chunk.
+        size_t body_bytes_ = 0;  // Body bytes handed to the sink.
+
+        /**
+         * @brief The TLS client config, nullptr if there's no root CA to verify
+         * the server with.
+         */
+        altcp_tls_config *tls_config()
+        {
+            if (tls_config_ != nullptr)
+            {
+                return tls_config_;
+            }
+#ifdef WEATHER_INSECURE_TLS
+            printf("HTTP GET: built with WEATHER_INSECURE_TLS, servers aren't verified\n");
+            tls_config_ = altcp_tls_create_config_client(nullptr, 0);
+#else
+            if (root_ca_ != nullptr && root_ca_[0] != '\0')
+            {
+                // mbedTLS counts a PEM's terminating NUL in its length.
+                tls_config_ = altcp_tls_create_config_client(reinterpret_cast<const u8_t *>(root_ca_), std::strlen(root_ca_) + 1);
+            }
+#endif
+            return tls_config_;
+        }
+
+        void fail(const char *reason, const bool abort = false)
+        {
+            if (state_ != FetchState::kFailed)
+            {
+                printf("HTTP GET %s failed while %s: %s\n", host_.c_str(), fetch_state_name(state_), reason);
+            }
+            close(abort);
+            state_ = FetchState::kFailed;
+            finished_us_ = time_us_64();
+        }
+
+        void finish()
+        {
+            close();
+            state_ = FetchState::kDone;
+            finished_us_ = time_us_64();
+        }
+
+        /**
+         * @brief Let go of the connection, aborting it if asked to or if lwIP
+         * can't close it cleanly.
+         *
+         * @return true if the pcb was aborted. lwIP then requires the pcb's
+         * callback this ran from, if any, to return ERR_ABRT, and only then.
+         */
+        bool close(const bool abort = false)
+        {
+            if (pcb_ == nullptr)
+            {
+                return false;
+            }
+            cyw43_arch_lwip_begin();
+            altcp_arg(pcb_, nullptr);
+            altcp_recv(pcb_, nullptr);
+            altcp_err(pcb_, nullptr);
+            const bool aborted = abort || altcp_close(pcb_) != ERR_OK;
+            if (aborted)
+            {
+                altcp_abort(pcb_);
+            }
+            cyw43_arch_lwip_end();
+            pcb_ = nullptr;
+            aborted_ |= aborted;
+            return aborted;
+        }
+
+        /**
+         * @brief What a pcb callback returns: ERR_ABRT exactly when it aborted
+         * the pcb. Callbacks clear aborted_ on the way in.
+         */
+        [[nodiscard]] err_t callback_result() const
+        {
+            return aborted_ ? ERR_ABRT : ERR_OK;
+        }
+
+        void connect(const ip_addr_t &address)
+        {
+            if (tls_ && tls_config() == nullptr)
+            {
+                fail("no root CA to verify the server with");
+                return;
+            }
+            pcb_ = tls_ ? altcp_tls_new(tls_config(), IPADDR_TYPE_ANY) : altcp_tcp_new_ip_type(IPADDR_TYPE_ANY);
+            if (pcb_ == nullptr)
+            {
+                fail("out of pcbs");
+                return;
+            }
+            if (tls_)
+            {
+                mbedtls_ssl_set_hostname(static_cast<mbedtls_ssl_context *>(altcp_tls_context(pcb_)), host_.c_str());
+            }
+            altcp_arg(pcb_, this);
+            altcp_recv(pcb_, &HttpGet::on_receive);
+            altcp_err(pcb_, &HttpGet::on_error);
+
+            state_ = FetchState::kConnecting;
+            if (altcp_connect(pcb_, &address, port_, &HttpGet::on_connected) != ERR_OK)
+            {
+                fail("connect");
+            }
+        }
+
+        static void on_resolved(const char *, const ip_addr_t *address, void *arg)
+        {
+            auto *self = static_cast<HttpGet *>(arg);
+            if (self->state_ != FetchState::kResolving)
+            {
+                return;
+            }
+            if (address == nullptr)
+            {
+                self->fail("host not found");
+                return;
+            }
+            self->connect(*address);
+        }
+
+        static err_t on_connected(void *arg, altcp_pcb *, const err_t err)
+        {
+            auto *self = static_cast<HttpGet *>(arg);
+            self->aborted_ = false;
+            if (err != ERR_OK)
+            {
+                self->fail("handshake", true);
+                return self->callback_result();
+            }
+            if (self->request_.size() > altcp_sndbuf(self->pcb_) ||
+                altcp_write(self->pcb_, self->request_.data(), self->request_.size(), TCP_WRITE_FLAG_COPY) != ERR_OK)
+            {
+                self->fail("request too long", true);
+                return self->callback_result();
+            }
+            altcp_output(self->pcb_);
+            self->state_ = FetchState::kHeaders;
+            return ERR_OK;
+        }
+
+        static err_t on_receive(void *arg, altcp_pcb *pcb, pbuf *p, const err_t)
+        {
+            auto *self = static_cast<HttpGet *>(arg);
+            self->aborted_ = false;
+            if (p == nullptr)
+            {
+                // Closed by the server: the end of a body without a length, an error otherwise.
+                if (self->decode_ == Decode::kIdentity && !self->has_length_)
+                {
+                    self->finish();
+                }
+                else
+                {
+                    self->fail("connection closed early");
+                }
+                return self->callback_result();
+            }
+
+            // Acknowledged first: consume() may close the connection, after which pcb is gone.
+            altcp_recved(pcb, p->tot_len);
+            for (const pbuf *q = p; q != nullptr && self->state_ != FetchState::kFailed && self->state_ != FetchState::kDone; q = q->next)
+            {
+                self->consume(static_cast<const char *>(q->payload), q->len);
+            }
+            pbuf_free(p);
+            return self->callback_result();
+        }
+
+        static void on_error(void *arg, err_t)
+        {
+            // lwIP has already freed the pcb.
+            auto *self = static_cast<HttpGet *>(arg);
+            self->pcb_ = nullptr;
+            self->fail("connection lost");
+        }
+
+        /**
+         * @brief Collect a CRLF terminated line. Returns true once line_ holds a whole line.
+         */
+        bool take_line(const char c)
+        {
+            if (c == '\n')
+            {
+                if (line_len_ > 0 && line_[line_len_ - 1] == '\r')
+                {
+                    line_len_--;
+                }
+                return true;
+            }
+            if (line_len_ < kMaxLine)
+            {
+                line_[line_len_++] = c;
+            }
+            return false;
+        }
+
+        [[nodiscard]] std::string_view line() const { return {line_.data(), line_len_}; }
+
+        static bool starts_with_nocase(const std::string_view text, const std::string_view prefix)
+        {
+            return text.size() >= prefix.size() &&
+                   std::equal(prefix.begin(), prefix.end(), text.begin(), [](const char a, const char b)
+                              { return std::tolower(a) == std::tolower(b); });
+        }
+
+        void header_line()
+        {
+            const std::string_view header = line();
+            if (header.empty())
+            {
+                // End of the headers.
+                if (status_ != 200)
+                {
+                    char reason[32];
+                    snprintf(reason, sizeof(reason), "status %u", status_);
+                    fail(reason);
+                    return;
+                }
+                state_ = FetchState::kBody;
+                decode_ = chunked_ ? Decode::kChunkSize : Decode::kIdentity;
+                if (!chunked_ && has_length_ && remaining_ == 0)
+                {
+                    finish();
+                }
+                return;
+            }
+
+            if (starts_with_nocase(header, "content-length:"))
+            {
+                has_length_ = true;
+                remaining_ = std::strtoul(std::string(header.substr(15)).c_str(), nullptr, 10);
+            }
+            else if (starts_with_nocase(header, "transfer-encoding:") && header.find("chunked") != std::string_view::npos)
+            {
+                chunked_ = true;
+            }
+        }
+
+        bool body(const char *data, const size_t size)
+        {
+            body_bytes_ += size;
+            if (!sink_.feed(data, size))
+            {
+                fail("body rejected");
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief Decode received bytes. Body bytes are passed on in runs, not one at a time.
+         */
+        void consume(const char *data, const size_t size)
+        {
+            size_t i = 0;
+            while (i < size && state_ != FetchState::kFailed && state_ != FetchState::kDone)
+            {
+                switch (decode_)
+                {
+                case Decode::kStatusLine:
+                    if (take_line(data[i++]))
+                    {
+                        // "HTTP/1.1 200 OK"
+                        const std::string_view status = line();
+                        if (!status.starts_with("HTTP/1.") || status.size() < 12)
+                        {
+                            fail("not HTTP");
+                            return;
+                        }
+                        status_ = std::strtoul(std::string(status.substr(9, 3)).c_str(), nullptr, 10);
+                        line_len_ = 0;
+                        decode_ = Decode::kHeaderLine;
+                    }
+                    break;
+
+                case Decode::kHeaderLine:
+                case Decode::kTrailers:
+                    if (take_line(data[i++]))
+                    {
+                        if (decode_ == Decode::kTrailers)
+                        {
+                            if (line_len_ == 0)
+                            {
+                                finish();
+                                return;
+                            }
+                        }
+                        else
+                        {
+                            header_line();
+                        }
+                        line_len_ = 0;
+                    }
+                    break;
+
+                case Decode::kIdentity:
+                {
+                    const size_t run = has_length_ ? std::min(remaining_, size - i) : size - i;
+                    if (!body(data + i, run))
+                    {
+                        return;
+                    }
+                    i += run;
+                    if (has_length_ && (remaining_ -= run) == 0)
+                    {
+                        finish();
+                        return;
+                    }
+                    break;
+                }
+
+                case Decode::kChunkSize:
+                    if (take_line(data[i++]))
+                    {
+                        remaining_ = std::strtoul(std::string(line()).c_str(), nullptr, 16);
+                        line_len_ = 0;
+                        decode_ = remaining_ == 0 ? Decode::kTrailers : Decode::kChunkData;
+                    }
+                    break;
+
+                case Decode::kChunkData:
+                {
+                    const size_t run = std::min(remaining_, size - i);
+                    if (!body(data + i, run))
+                    {
+                        return;
+                    }
+                    i += run;
+                    if ((remaining_ -= run) == 0)
+                    {
+                        decode_ = Decode::kChunkDataEnd;
+                    }
+                    break;
+                }
+
+                case Decode::kChunkDataEnd:
+                    if (take_line(data[i++]))
+                    {
+                        line_len_ = 0;
+                        decode_ = Decode::kChunkSize;
+                    }
+                    break;
+                }
+            }
+        }
+
+    public:
+        /**
+         * @param sink Where the body goes.
+         * @param root_ca PEM root CA certificate TLS servers must chain to.
+         */
+        explicit HttpGet(Sink &sink, const char *root_ca = nullptr) : sink_(sink), root_ca_(root_ca) {}
+
+        ~HttpGet()
+        {
+            close();
+            if (tls_config_ != nullptr)
+            {
+                altcp_tls_free_config(tls_config_);
+            }
+        }
+
+        HttpGet(const HttpGet &) = delete;
+        HttpGet &operator=(const HttpGet &) = delete;
+
+        /**
+         * @brief Begin a GET. Returns straight away; call poll() until it's done or failed.
+         *
+         * @param host Server name or address.
+         * @param port Server port.
+         * @param path Path and query.
+         * @param tls Whether to use TLS.
+         * @param timeout_us Give up if the whole fetch takes longer.
+         * @return false if the request couldn't be sent off at all.
+         */
+        bool start(const std::string_view host, const uint16_t port, const std::string_view path, const bool tls, const uint64_t timeout_us)
+        {
+            close();
+            host_ = host;
+            port_ = port;
+            tls_ = tls;
+            request_ = "GET ";
+            request_.append(path);
+            request_.append(" HTTP/1.1\r\nHost: ");
+            request_.append(host);
+            request_.append("\r\nAccept: application/json\r\nAccept-Encoding: identity\r\nConnection: close\r\n\r\n");
+
+            decode_ = Decode::kStatusLine;
+            line_len_ = 0;
+            status_ = 0;
+            chunked_ = false;
+            has_length_ = false;
+            remaining_ = 0;
+            body_bytes_ = 0;
+            started_us_ = time_us_64();
+            timeout_us_ = timeout_us;
+
+            state_ = FetchState::kResolving;
+            ip_addr_t address;
+            cyw43_arch_lwip_begin();
+            const err_t err = dns_gethostbyname(host_.c_str(), &address, &HttpGet::on_resolved, this);
+            if (err == ERR_OK)
+            {
+                connect(address);
+            }
+            else if (err != ERR_INPROGRESS)
+            {
+                fail("DNS");
+            }
+            cyw43_arch_lwip_end();
+            return state_ != FetchState::kFailed;
+        }
+
+        /**
+         * @brief Give up on a fetch that has run past its timeout. Call once a
+         * frame, after cyw43_arch_poll() has run the callbacks.
+         */
+        FetchState poll()
+        {
+            const bool active = state_ != FetchState::kIdle && state_ != FetchState::kDone && state_ != FetchState::kFailed;
+            if (active && time_us_64() - started_us_ > timeout_us_)
+            {
+                fail("timed out");
+            }
+            return state_;
+        }
+
+        /**
+         * @brief Drop the fetch, if one is running.
+         */
+        void cancel()
+        {
+            close();
+            state_ = FetchState::kIdle;
+        }
+
+        [[nodiscard]] FetchState state() const { return state_; }
+        [[nodiscard]] bool busy() const { return state_ != FetchState::kIdle && state_ != FetchState::kDone && state_ != FetchState::kFailed; }
+        [[nodiscard]] uint16_t status() const { return status_; }
+        [[nodiscard]] size_t body_bytes() const { return body_bytes_; }
+        [[nodiscard]] uint64_t elapsed_us() const { return (busy() ? time_us_64() : finished_us_) - started_us_; }
+    };
+
+} // namespace weather
+
+#endif // HTTP_CLIENT_H
@@ -0,0 +1,70 @@
+#ifndef LWIPOPTS_H
+#define LWIPOPTS_H
+
+#include <stdint.h>
+
+// lwIP settings for pico_cyw43_arch_lwip_poll: no OS, the stack runs inside
+// cyw43_arch_poll() on the display loop. See lwip/opt.h for the full list.
+
+#define NO_SYS 1
+#define LWIP_SOCKET 0
+#define LWIP_NETCONN 0
+#define MEM_LIBC_MALLOC 0
+#define MEM_ALIGNMENT 4
+#define MEM_SIZE 16000
+#define MEMP_NUM_TCP_SEG 32
+#define MEMP_NUM_ARP_QUEUE 10
+#define PBUF_POOL_SIZE 24
+
+#define LWIP_IPV4 1
+#define LWIP_ARP 1
+#define LWIP_ETHERNET 1
+#define LWIP_ICMP 1
+#define LWIP_RAW 1
+#define LWIP_TCP 1
+#define LWIP_UDP 1
+#define LWIP_DNS 1
+#define LWIP_DHCP 1
+#define DHCP_DOES_ARP_CHECK 0
+#define LWIP_DHCP_DOES_ACD_CHECK 0
+
+#define TCP_MSS 1460
+#define TCP_WND (8 * TCP_MSS)
+#define TCP_SND_BUF (8 * TCP_MSS)
+#define TCP_SND_QUEUELEN ((4 * (TCP_SND_BUF) + (TCP_MSS - 1)) / (TCP_MSS))
+#define LWIP_TCP_KEEPALIVE 1
+
+#define LWIP_NETIF_STATUS_CALLBACK 1
+#define LWIP_NETIF_LINK_CALLBACK 1
+#define LWIP_NETIF_HOSTNAME 1
+#define LWIP_NETIF_TX_SINGLE_PBUF 1
+#define LWIP_CHKSUM_ALGORITHM 3
+
+// HTTPS to the weather API through altcp and mbedTLS.
+#define LWIP_ALTCP 1
+#define LWIP_ALTCP_TLS 1
+#define LWIP_ALTCP_TLS_MBEDTLS 1
+// The server must present a certificate that chains to the configured root
+// CA; the API key travels in the query string. WEATHER_INSECURE_TLS is for
+// debugging only.
+#ifdef WEATHER_INSECURE_TLS
+#define ALTCP_MBEDTLS_AUTHMODE MBEDTLS_SSL_VERIFY_NONE
+#else
+#define ALTCP_MBEDTLS_AUTHMODE MBEDTLS_SSL_VERIFY_REQUIRED
+#endif
+
+// Wall clock time over SNTP, handed to sntp_set_unix_time() in wall_clock.cpp.
+#ifdef __cplusplus
+extern "C"
+#endif
+void sntp_set_unix_time(uint32_t sec);
+#define SNTP_SERVER_DNS 1
+#define SNTP_SET_SYSTEM_TIME(sec) sntp_set_unix_time(sec)
+#define MEMP_NUM_SYS_TIMEOUT (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 1)
+
+#define MEM_STATS 0
+#define SYS_STATS 0
+#define MEMP_STATS 0
+#define LINK_STATS 0
+
+#endif // LWIPOPTS_H
@@ -3,16 +3,19 @@
 
 #include "hardware/i2c.h"
 #include "pico/stdlib.h"
+#include "pico/rand.h"
 #include "hardware/clocks.h"
 
 #include "display/weather_display_handler.h"
 #include "debug_console.h"
 #include "misc.h"
 #include "secrets.h"
+#include "web_handler.h"
 #include "display/z_buffer.h"
 
 #include "libraries/interstate75/interstate75.hpp"
 
+#include <memory>
 #include <stdio.h>
 
 #endif // MAIN_H
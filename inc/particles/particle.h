@@ -4,83 +4,148 @@
 #include "helpers_rand.h"
 #include "../display/segment/segment_properties.h"
 #include "particle_base.h"
+#include "particle_pool.h"
+#include "particle_integrator.h"
 
-class Particle : public ParticleBase
+/**
+ * @brief Rain drop characteristics.
+ */
+struct Rain
 	{
-protected:
-	Physical physical_; // The particle's physical properties.
-
-	void update_physics() override
-		{
-		accel_.x += physical_.gravity_x_constant - (physical_.drag * velocities_.x);
-		accel_.y += physical_.gravity_y_constant - (physical_.drag * velocities_.y);
+	static constexpr float kTerminalVelocity = 24.0f;
+	// Weight range: 0.7 - 1.0 (heavy rain drops have high weight)
+	static constexpr float kMinWeight = 0.7f;
+	static constexpr float kMaxWeight = 1.0f;
+	};
 
-		velocities_.x += accel_.x * seg_properties_.get_dt();
-		velocities_.y += accel_.y * seg_properties_.get_dt();
+/**
+ * @brief Snowflake characteristics.
+ */
+struct Snow
+	{
+	static constexpr float kTerminalVelocity = 9.5f;
+	static constexpr float kMinWeight = 0.25f;
+	static constexpr float kMaxWeight = 0.4f;
+	};
 
-		positions_.x += velocities_.x * ((positions_.z) * 1.2f) * seg_properties_.get_dt();
-		positions_.y += velocities_.y * ((positions_.z) * 1.2f) * seg_properties_.get_dt();
-		positions_.z = std::clamp(positions_.z + (velocities_.z), 0.2f, 1.0f);
+/**
+ * @brief Reset particles with new values, respawning them on the segment's spawn span.
+ * Random numbers are drawn in batches of kSpawnBatch, so resetting many particles
+ * costs a few tight loops rather than several RNG calls per particle.
+ *
+ * @tparam Kind Particle characteristics (Rain, Snow).
+ * @param pool The pool the particles live in.
+ * @param indices Indices of the particles to reset.
+ * @param count Number of indices.
+ * @param seg_properties The segment the particles belong to.
+ */
+template <typename Kind>
+void reset_particles(ParticlePool &pool, const uint16_t *indices, const uint16_t count, DisplaySegProperties &seg_properties)
+	{
+	const GravityProperties &grav = seg_properties.get_gravity();
+	const particle_scalar_t drag = to_particle(seg_properties.get_grav_mag() / Kind::kTerminalVelocity);
 
-		accel_.x = 0;
-		accel_.y = 0;
-		}
+	std::array<float, kSpawnBatch> weights;
+	std::array<Position, kSpawnBatch> spawns{};
 
-public:
-	Particle(DisplaySegProperties &seg_properties, const float terminal_velocity) : ParticleBase(seg_properties)
+	for (uint16_t first = 0; first < count; first += kSpawnBatch)
 		{
-		physical_.terminal_velocity = terminal_velocity;
-		physical_.drag = seg_properties_.get_grav_mag() / physical_.terminal_velocity;
-		}
+		const uint16_t n = std::min<uint16_t>(kSpawnBatch, count - first);
+		get_rand_floats(weights.data(), n, Kind::kMinWeight, Kind::kMaxWeight);
+		set_spawn_points(seg_properties.get_spawn_ranges(), spawns.data(), n);
 
-	void update() override
-		{
-		update_physics();
-		if (seg_properties_.is_particle_oob(positions_))
+		for (uint16_t j = 0; j < n; j++)
 			{
-			reset();
+			const uint16_t i = indices[first + j];
+			const float weight = weights[j];
+
+			pool.weight[i] = to_particle(weight);
+			pool.drag[i] = drag;
+			pool.vx[i] = to_particle(weight * grav.x_dir_);
+			pool.vy[i] = to_particle(weight * grav.y_dir_);
+			pool.x[i] = to_particle(spawns[j].x);
+			pool.y[i] = to_particle(spawns[j].y);
+			pool.z[i] = to_particle(spawns[j].z);
 			}
 		}
-	};
+	}
 
-class Rain : public Particle
+/**
+ * @brief Spawn a single new particle if the pool has room.
+ *
+ * @tparam Kind Particle characteristics (Rain, Snow).
+ */
+template <typename Kind>
+void spawn_particle(ParticlePool &pool, DisplaySegProperties &seg_properties)
 	{
-public:
-	explicit Rain(DisplaySegProperties &seg_properties) : Particle(seg_properties, 24.0f)
+	if (pool.full())
 		{
-		Rain::reset();
+		return;
 		}
+	const uint16_t i = pool.spawn();
+	reset_particles<Kind>(pool, &i, 1, seg_properties);
+	}
+
+/**
+ * @brief Advance every particle in the pool, then respawn any that left the segment.
+ * Particles that left are collected and respawned a batch at a time. While
+ * the pool is over its capacity, particles that left are removed instead,
+ * until it is back within it.
+ *
+ * @tparam Kind Particle characteristics (Rain, Snow).
+ */
+template <typename Kind>
+void step_particles(ParticlePool &pool, DisplaySegProperties &seg_properties)
+	{
+	const GravityProperties &grav = seg_properties.get_gravity();
+	integrate_particles(pool, {grav.x_dir_, grav.y_dir_, seg_properties.get_dt()});
 
-	void reset() override
+	for (uint16_t i = pool.size(); i-- > 0 && pool.over_capacity();)
 		{
-		// Weight range: 0.7 - 1.0 (heavy rain drops have high weight)
-		physical_.weight = get_rand_float(0.7f, 1.0f);
-		const GravityProperties grav = seg_properties_.get_gravity();
-		physical_.gravity_x_constant = physical_.weight * grav.x_dir_;
-		physical_.gravity_y_constant = physical_.weight * grav.y_dir_;
-		set_initial_velocities(velocities_, physical_.weight, seg_properties_.get_gravity());
-		set_spawn_point(seg_properties_.get_spawn_ranges(), positions_);
+		if (seg_properties.is_particle_oob(pimoroni::Point(particle_to_pixel(pool.x[i]), particle_to_pixel(pool.y[i]))))
+			{
+			pool.remove(i);
+			}
 		}
-	};
 
-class Snow : public Particle
-	{
-public:
-	explicit Snow(DisplaySegProperties &seg_properties) : Particle(seg_properties, 9.5f)
+	std::array<uint16_t, kSpawnBatch> left;
+	uint16_t num_left = 0;
+
+	const uint16_t count = pool.size();
+	for (uint16_t i = 0; i < count; i++)
 		{
-		Snow::reset();
+		if (seg_properties.is_particle_oob(pimoroni::Point(particle_to_pixel(pool.x[i]), particle_to_pixel(pool.y[i]))))
+			{
+			left[num_left++] = i;
+			if (num_left == kSpawnBatch)
+				{
+				reset_particles<Kind>(pool, left.data(), num_left, seg_properties);
+				num_left = 0;
+				}
+			}
 		}
+	reset_particles<Kind>(pool, left.data(), num_left, seg_properties);
+	}
 
-	// Reset particle with new values...
-	void reset() override
+/**
+ * @brief Respawn every particle in the pool at once, e.g. after the gravity
+ * direction changes and the current particles are falling the wrong way.
+ *
+ * @tparam Kind Particle characteristics (Rain, Snow).
+ */
+template <typename Kind>
+void respawn_particles(ParticlePool &pool, DisplaySegProperties &seg_properties)
+	{
+	std::array<uint16_t, kSpawnBatch> indices;
+	for (uint16_t first = 0; first < pool.size(); first += kSpawnBatch)
 		{
-		physical_.weight = get_rand_float(0.25f, 0.4f);
-		const GravityProperties grav = seg_properties_.get_gravity();
-		physical_.gravity_x_constant = physical_.weight * grav.x_dir_;
-		physical_.gravity_y_constant = physical_.weight * grav.y_dir_;
-		set_initial_velocities(velocities_, physical_.weight, seg_properties_.get_gravity());
-		set_spawn_point(seg_properties_.get_spawn_ranges(), positions_);
+		const uint16_t n = std::min<uint16_t>(kSpawnBatch, pool.size() - first);
+		for (uint16_t j = 0; j < n; j++)
+			{
+			indices[j] = first + j;
+			}
+		reset_particles<Kind>(pool, indices.data(), n, seg_properties);
 		}
-	};
+	}
 
 #endif // PARTICLE_H
@@ -4,22 +4,20 @@
 #include "display/segment/segment_properties.h"
 #include "particle_properties.h"
 
+/**
+ * @brief State shared by single, free moving particles such as wind gust centres.
+ * Not polymorphic: each derived type provides its own update() and reset(),
+ * which are called on the concrete type so they can be inlined.
+ */
 class ParticleBase
 	{
 protected:
 	DisplaySegProperties &seg_properties_;
-	Velocity velocities_; // The particle's velocities in x, y, and z directions.
-	Position positions_; // The immediate particle's position in x, y and z.
-	Acceleration accel_;
-
-	virtual void update_physics() = 0;
-	virtual void reset() = 0;
+	Velocity velocities_{}; // The particle's velocities in x, y, and z directions.
+	Position positions_{}; // The immediate particle's position in x, y and z.
+	Acceleration accel_{};
 
 public:
-	virtual void update() = 0;
-
-	virtual ~ParticleBase() = default;
-
 	ParticleBase(DisplaySegProperties &seg_properties) : seg_properties_(seg_properties) {}
 
 	[[nodiscard]] bool is_drawable() const { return seg_properties_.is_particle_in_segment(positions_); }
@@ -48,6 +46,9 @@ public:
 
 
 
+static constexpr uint16_t kSpawnBatch = 32; // Most spawn points worked out from one batch of random numbers.
+static constexpr uint8_t kMaxSpawnRanges = 4; // Most ranges a batch picks between, segment edges give at most 2.
+
 /**
  * @brief Generate the particle's spawn positions, given the span.
  * @param spawn_span The given spans to try and spawn on.
@@ -63,20 +64,60 @@ void set_spawn_point(const std::vector<Range> &spawn_span, Position &positions)
 		if (r <= acc)
 			{
 			positions = spawn.get_random_point_in_range();
+			break;
 			}
 		}
 	}
 
 /**
-     * @brief Generates the initial particle velocities based off of particle weight
-     * and the given gravity information.
-     *
-     */
-void set_initial_velocities(Velocity &velocities, const float &particle_weight, const GravityProperties &gravity)
+ * @brief Generate spawn positions for a batch of particles at once. The random
+ * numbers for the whole batch are drawn up front and each range's intervals
+ * are worked out once, instead of per particle as set_spawn_point() does.
+ *
+ * @param spawn_span The given spans to try and spawn on.
+ * @param positions Array to place the new positions in.
+ * @param count Number of positions, at most kSpawnBatch.
+ */
+inline void set_spawn_points(const std::vector<Range> &spawn_span, Position *positions, const uint16_t count)
 	{
-	velocities.x = particle_weight * gravity.x_dir_;
-	velocities.y = particle_weight * gravity.y_dir_;
-	velocities.z = 0.0f; // No Z gravity currently
+	struct RangeMapping
+		{
+		RandInterval x, y, z;
+		float acc; // Running weight up to and including this range.
+		};
+
+	const uint8_t num_ranges = std::min<size_t>(spawn_span.size(), kMaxSpawnRanges);
+	if (num_ranges == 0)
+		{
+		return;
+		}
+
+	std::array<RangeMapping, kMaxSpawnRanges> ranges;
+	float acc = 0.0f;
+	for (uint8_t r = 0; r < num_ranges; r++)
+		{
+		const Range &spawn = spawn_span[r];
+		acc += spawn.weight;
+		ranges[r] = {RandInterval(spawn.space.start_.x, spawn.space.end_.x), RandInterval(spawn.space.start_.y, spawn.space.end_.y),
+					RandInterval(spawn.z_start, spawn.z_end), acc};
+		}
+	ranges[num_ranges - 1].acc = MAXFLOAT; // Anything past the total weight lands in the last range.
+
+	std::array<float, kSpawnBatch> pick, x, y, z;
+	get_rand_floats(pick.data(), count);
+	get_rand_floats(x.data(), count);
+	get_rand_floats(y.data(), count);
+	get_rand_floats(z.data(), count);
+
+	for (uint16_t i = 0; i < count; i++)
+		{
+		uint8_t r = 0;
+		while (pick[i] > ranges[r].acc)
+			{
+			r++;
+			}
+		positions[i] = {ranges[r].x(x[i]), ranges[r].y(y[i]), ranges[r].z(z[i])};
+		}
 	}
 
 
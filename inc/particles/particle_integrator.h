@@ -0,0 +1,210 @@
+#ifndef PARTICLE_INTEGRATOR_H
+#define PARTICLE_INTEGRATOR_H
+
+#include "particle_pool.h"
+#include "particle_properties.h"
+
+#if defined(ARM_MATH_CM33)
+extern "C"
+{
+#include "arm_math.h"
+}
+#endif
+
+#include <algorithm>
+
+/**
+ * @brief Per-frame constants shared by every particle in a batch.
+ */
+struct IntegratorParams
+	{
+	float gravity_x; // Gravity X component, scaled by particle weight.
+	float gravity_y; // Gravity Y component, scaled by particle weight.
+	float dt; // Time step in s.
+	};
+
+// Particles are integrated in blocks so the intermediate arrays fit on the stack.
+static constexpr uint16_t kIntegratorBlock = 32;
+static constexpr float kDepthSpeedScale = 1.2f; // Near particles move faster than far ones.
+static constexpr float kMinDepth = 0.2f;
+static constexpr float kMaxDepth = 1.0f;
+
+/**
+ * @brief Portable integrator. Each operation is performed in the same order and
+ * with the same rounding as the CMSIS-DSP kernels below, and contraction into
+ * fused multiply-adds is disabled, so both paths produce identical results.
+ *
+ * @param pool Particles to advance.
+ * @param params Frame constants.
+ */
+__attribute__((optimize("O3", "fp-contract=off")))
+inline void integrate_particles_scalar(BasicParticlePool<float> &pool, const IntegratorParams &params)
+	{
+	const float step_scale = kDepthSpeedScale * params.dt;
+	const uint16_t count = pool.size();
+
+	float *__restrict x = pool.x;
+	float *__restrict y = pool.y;
+	float *__restrict z = pool.z;
+	float *__restrict vx = pool.vx;
+	float *__restrict vy = pool.vy;
+	float *__restrict ax = pool.ax;
+	float *__restrict ay = pool.ay;
+	const float *__restrict weight = pool.weight;
+	const float *__restrict drag = pool.drag;
+
+	for (uint16_t i = 0; i < count; i++)
+		{
+		// Drag and gravity.
+		const float accel_x = (ax[i] + (weight[i] * params.gravity_x)) - (drag[i] * vx[i]);
+		const float accel_y = (ay[i] + (weight[i] * params.gravity_y)) - (drag[i] * vy[i]);
+
+		// Velocity.
+		vx[i] = vx[i] + (accel_x * params.dt);
+		vy[i] = vy[i] + (accel_y * params.dt);
+
+		// Position, scaled by depth.
+		const float step = z[i] * step_scale;
+		x[i] = x[i] + (vx[i] * step);
+		y[i] = y[i] + (vy[i] * step);
+		z[i] = std::clamp(z[i], kMinDepth, kMaxDepth);
+
+		ax[i] = 0.0f;
+		ay[i] = 0.0f;
+		}
+	}
+
+#if defined(ARM_MATH_CM33)
+/**
+ * @brief CMSIS-DSP batch integrator. Works through the pool one block at a time,
+ * running each stage of the update (drag, gravity, velocity, position, depth clamp)
+ * across the whole block before moving on to the next.
+ *
+ * @param pool Particles to advance.
+ * @param params Frame constants.
+ */
+inline void integrate_particles_cmsis(BasicParticlePool<float> &pool, const IntegratorParams &params)
+	{
+	const float step_scale = kDepthSpeedScale * params.dt;
+	const uint16_t count = pool.size();
+
+	float accel[kIntegratorBlock];
+	float drag_force[kIntegratorBlock];
+	float step[kIntegratorBlock];
+
+	for (uint16_t start = 0; start < count; start += kIntegratorBlock)
+		{
+		const uint32_t n = std::min<uint32_t>(kIntegratorBlock, count - start);
+
+		float *x = pool.x + start;
+		float *y = pool.y + start;
+		float *z = pool.z + start;
+		float *vx = pool.vx + start;
+		float *vy = pool.vy + start;
+		float *ax = pool.ax + start;
+		float *ay = pool.ay + start;
+		float *weight = pool.weight + start;
+		float *drag = pool.drag + start;
+
+		arm_scale_f32(z, step_scale, step, n);
+
+		// X axis.
+		arm_scale_f32(weight, params.gravity_x, accel, n);
+		arm_add_f32(ax, accel, accel, n);
+		arm_mult_f32(drag, vx, drag_force, n);
+		arm_sub_f32(accel, drag_force, accel, n);
+		arm_scale_f32(accel, params.dt, accel, n);
+		arm_add_f32(vx, accel, vx, n);
+		arm_mult_f32(vx, step, accel, n);
+		arm_add_f32(x, accel, x, n);
+
+		// Y axis.
+		arm_scale_f32(weight, params.gravity_y, accel, n);
+		arm_add_f32(ay, accel, accel, n);
+		arm_mult_f32(drag, vy, drag_force, n);
+		arm_sub_f32(accel, drag_force, accel, n);
+		arm_scale_f32(accel, params.dt, accel, n);
+		arm_add_f32(vy, accel, vy, n);
+		arm_mult_f32(vy, step, accel, n);
+		arm_add_f32(y, accel, y, n);
+
+		arm_clip_f32(z, z, kMinDepth, kMaxDepth, n);
+
+		arm_fill_f32(0.0f, ax, n);
+		arm_fill_f32(0.0f, ay, n);
+		}
+	}
+#endif
+
+/**
+ * @brief Fixed-point integrator for Q16.16 pools. Follows the same steps as the
+ * float integrators, using 32 x 32 -> 64 bit multiplies (SMULL on the M33).
+ *
+ * @param pool Particles to advance.
+ * @param params Frame constants.
+ */
+__attribute__((optimize("O3")))
+inline void integrate_particles_fixed(BasicParticlePool<q16_t> &pool, const IntegratorParams &params)
+	{
+	static constexpr q16_t kMinDepthQ16 = float_to_q16(kMinDepth);
+	static constexpr q16_t kMaxDepthQ16 = float_to_q16(kMaxDepth);
+
+	const q16_t gravity_x = float_to_q16(params.gravity_x);
+	const q16_t gravity_y = float_to_q16(params.gravity_y);
+	const q24_t dt = float_to_q24(params.dt);
+	const q24_t step_scale = float_to_q24(kDepthSpeedScale * params.dt);
+	const uint16_t count = pool.size();
+
+	q16_t *__restrict x = pool.x;
+	q16_t *__restrict y = pool.y;
+	q16_t *__restrict z = pool.z;
+	q16_t *__restrict vx = pool.vx;
+	q16_t *__restrict vy = pool.vy;
+	q16_t *__restrict ax = pool.ax;
+	q16_t *__restrict ay = pool.ay;
+	const q16_t *__restrict weight = pool.weight;
+	const q16_t *__restrict drag = pool.drag;
+
+	for (uint16_t i = 0; i < count; i++)
+		{
+		// Drag and gravity.
+		const q16_t accel_x = (ax[i] + q16_mul(weight[i], gravity_x)) - q16_mul(drag[i], vx[i]);
+		const q16_t accel_y = (ay[i] + q16_mul(weight[i], gravity_y)) - q16_mul(drag[i], vy[i]);
+
+		// Velocity.
+		vx[i] += q16_mul_q24(accel_x, dt);
+		vy[i] += q16_mul_q24(accel_y, dt);
+
+		// Position, scaled by depth. The step stays in Q8.24.
+		const q24_t step = static_cast<q24_t>((static_cast<int64_t>(z[i]) * step_scale) >> 16);
+		x[i] += q16_mul_q24(vx[i], step);
+		y[i] += q16_mul_q24(vy[i], step);
+		z[i] = std::clamp(z[i], kMinDepthQ16, kMaxDepthQ16);
+
+		ax[i] = 0;
+		ay[i] = 0;
+		}
+	}
+
+/**
+ * @brief Integrate every particle in a float pool by one time step, using the
+ * CMSIS-DSP kernels on the target and the portable path elsewhere.
+ */
+inline void integrate_particles(BasicParticlePool<float> &pool, const IntegratorParams &params)
+	{
+#if defined(ARM_MATH_CM33)
+	integrate_particles_cmsis(pool, params);
+#else
+	integrate_particles_scalar(pool, params);
+#endif
+	}
+
+/**
+ * @brief Integrate every particle in a fixed-point pool by one time step.
+ */
+inline void integrate_particles(BasicParticlePool<q16_t> &pool, const IntegratorParams &params)
+	{
+	integrate_particles_fixed(pool, params);
+	}
+
+#endif
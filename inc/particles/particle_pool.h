@@ -0,0 +1,155 @@
+#ifndef PARTICLE_POOL_H
+#define PARTICLE_POOL_H
+
+#include "pico/stdlib.h"
+#include "particle_properties.h"
+
+#include <algorithm>
+#include <memory>
+
+/**
+ * @brief Fixed-capacity, structure-of-arrays particle store.
+ *
+ * Every per-particle property lives in its own contiguous array so effects can
+ * iterate them linearly. All arrays are carved out of a single allocation made
+ * in allocate(), so spawning, resetting and updating particles never touches
+ * the heap afterwards. Once spawned, particles are reset in place when they
+ * leave the segment, unless the pool is over a capacity lowered by limit(),
+ * then they are removed. resize() changes the capacity for a new intensity,
+ * and only allocates when it grows past the storage.
+ *
+ * @tparam T Storage type of every property, float or Q16.16 (q16_t).
+ */
+template <typename T>
+class BasicParticlePool
+	{
+	static constexpr uint8_t kNumArrays = 9; // Number of arrays below.
+
+	std::unique_ptr<T[]> storage_; // Backing store for every array.
+	uint16_t allocated_ = 0; // Particles each array has room for.
+	uint16_t capacity_ = 0; // Maximum number of particles.
+	uint16_t count_ = 0; // Number of live particles.
+
+	/**
+	 * @brief Point every array into storage_, allocated_ apart.
+	 */
+	void carve()
+		{
+		T *base = storage_.get();
+		for (T **array: {&x, &y, &z, &vx, &vy, &ax, &ay, &weight, &drag})
+			{
+			*array = base;
+			base += allocated_;
+			}
+		}
+
+public:
+	T *x = nullptr; // X positions.
+	T *y = nullptr; // Y positions.
+	T *z = nullptr; // Depth, 0.2 (far) to 1.0 (near).
+	T *vx = nullptr; // X velocities.
+	T *vy = nullptr; // Y velocities.
+	T *ax = nullptr; // X accelerations accumulated this frame (wind).
+	T *ay = nullptr; // Y accelerations accumulated this frame (wind).
+	T *weight = nullptr; // Particle weights, scales gravity.
+	T *drag = nullptr; // Particle drag coefficients.
+
+	BasicParticlePool() = default;
+
+	/**
+	 * @brief Size the pool. Should be called once when the owning effect is
+	 * constructed; after that only resize() growing the pool allocates.
+	 *
+	 * @param capacity Maximum number of particles.
+	 */
+	void allocate(const uint16_t capacity)
+		{
+		allocated_ = capacity;
+		capacity_ = capacity;
+		count_ = 0;
+		storage_ = std::make_unique<T[]>(static_cast<size_t>(capacity) * kNumArrays);
+		carve();
+		}
+
+	/**
+	 * @brief Change the capacity, keeping the live particles that still fit.
+	 * Shrinking drops the newest particles and keeps the storage; growing
+	 * within the storage is free, and only growing past it allocates.
+	 *
+	 * @param capacity New maximum number of particles.
+	 */
+	void resize(const uint16_t capacity)
+		{
+		if (capacity > allocated_)
+			{
+			std::unique_ptr<T[]> old = std::move(storage_);
+			const T *old_arrays[kNumArrays] = {x, y, z, vx, vy, ax, ay, weight, drag};
+			storage_ = std::make_unique<T[]>(static_cast<size_t>(capacity) * kNumArrays);
+			allocated_ = capacity;
+			carve();
+
+			T *new_arrays[kNumArrays] = {x, y, z, vx, vy, ax, ay, weight, drag};
+			for (uint8_t i = 0; i < kNumArrays; i++)
+				{
+				std::copy_n(old_arrays[i], count_, new_arrays[i]);
+				}
+			}
+		capacity_ = capacity;
+		count_ = std::min(count_, capacity_);
+		}
+
+	/**
+	 * @brief Change the capacity within the storage without dropping any
+	 * particles. Live particles past a lowered capacity stay until they are
+	 * retired with remove(), see step_particles().
+	 *
+	 * @param capacity New maximum number of particles, at most what is allocated.
+	 */
+	void limit(const uint16_t capacity)
+		{
+		capacity_ = std::min(capacity, allocated_);
+		}
+
+	/**
+	 * @brief Remove a particle, moving the last one into its slot.
+	 */
+	void remove(const uint16_t i)
+		{
+		count_--;
+		T *arrays[kNumArrays] = {x, y, z, vx, vy, ax, ay, weight, drag};
+		for (T *array : arrays)
+			{
+			array[i] = array[count_];
+			}
+		}
+
+	/**
+	 * @brief Claim the next free slot. Callers must check full() first.
+	 *
+	 * @return uint16_t Index of the new particle.
+	 */
+	uint16_t spawn()
+		{
+		ax[count_] = 0;
+		ay[count_] = 0;
+		return count_++;
+		}
+
+	/**
+	 * @brief Drop every particle, keeping the storage for reuse.
+	 */
+	void clear()
+		{
+		count_ = 0;
+		}
+
+	[[nodiscard]] bool full() const { return count_ >= capacity_; }
+	[[nodiscard]] bool over_capacity() const { return count_ > capacity_; }
+	[[nodiscard]] uint16_t size() const { return count_; }
+	[[nodiscard]] uint16_t capacity() const { return capacity_; }
+	};
+
+// The pool used by the effects, in the representation selected at compile time.
+using ParticlePool = BasicParticlePool<particle_scalar_t>;
+
+#endif
@@ -5,6 +5,102 @@
 
 constexpr float UINT8_T_INVERSE = 1.0f / UINT8_MAX;
 
+/**
+ * Fixed-point support.
+ * Define WEATHER_FIXED_POINT_PARTICLES to store and integrate particles as Q16.16
+ * integers instead of floats. Sub-pixel precision on a 128 x 128 panel needs far
+ * fewer than 16 fractional bits, while the integer part comfortably covers the
+ * segment plus its out of bounds margin. Per-frame constants that are much smaller
+ * than one (dt and the depth step) are carried as Q8.24 so they keep their precision.
+ */
+using q16_t = int32_t;
+using q24_t = int32_t;
+
+constexpr int32_t kQ16One = 1 << 16;
+constexpr int32_t kQ24One = 1 << 24;
+
+constexpr q16_t float_to_q16(const float value)
+{
+    return static_cast<q16_t>(value * kQ16One);
+}
+
+constexpr q24_t float_to_q24(const float value)
+{
+    return static_cast<q24_t>(value * kQ24One);
+}
+
+constexpr float q16_to_float(const q16_t value)
+{
+    return value * (1.0f / kQ16One);
+}
+
+constexpr q16_t q16_mul(const q16_t a, const q16_t b)
+{
+    return static_cast<q16_t>((static_cast<int64_t>(a) * b) >> 16);
+}
+
+/**
+ * @brief Multiply a Q16.16 value by a Q8.24 constant, giving Q16.16.
+ */
+constexpr q16_t q16_mul_q24(const q16_t a, const q24_t b)
+{
+    return static_cast<q16_t>((static_cast<int64_t>(a) * b) >> 24);
+}
+
+#if defined(WEATHER_FIXED_POINT_PARTICLES)
+using particle_scalar_t = q16_t;
+#else
+using particle_scalar_t = float;
+#endif
+
+/**
+ * @brief Convert a float into the particle storage representation.
+ */
+constexpr particle_scalar_t to_particle(const float value)
+{
+#if defined(WEATHER_FIXED_POINT_PARTICLES)
+    return float_to_q16(value);
+#else
+    return value;
+#endif
+}
+
+constexpr float particle_to_float(const float value)
+{
+    return value;
+}
+
+constexpr float particle_to_float(const q16_t value)
+{
+    return q16_to_float(value);
+}
+
+/**
+ * @brief Convert a particle coordinate to a whole pixel coordinate.
+ */
+constexpr int32_t particle_to_pixel(const float value)
+{
+    return static_cast<int32_t>(value);
+}
+
+constexpr int32_t particle_to_pixel(const q16_t value)
+{
+    return value >> 16;
+}
+
+/**
+ * @brief Convert a particle depth (0 - 1.0) to the 8 bit depth stored in the framebuffer.
+ */
+constexpr uint8_t particle_to_depth(const float value)
+{
+    return static_cast<uint8_t>(value * UINT8_MAX);
+}
+
+constexpr uint8_t particle_to_depth(const q16_t value)
+{
+    return static_cast<uint8_t>((value * UINT8_MAX) >> 16);
+}
+
 /**
  * @brief Particle position struct.
  *
@@ -29,19 +125,4 @@ struct Velocity : public Position
 struct Acceleration : public Position
 {};
 
-/**
- * @brief Particle physical properties.
- *
- */
-struct Physical
-{
-    float weight; // Particle weight.
-    float drag;   // Particle drag.
-    float terminal_velocity;
-    float gravity_x_constant;
-    float gravity_y_constant;
-    uint16_t length; // How long the particle is.
-    uint16_t size;   // How fat the particle is.
-};
-
 #endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "display/segment/segment_force.h"
 #include "particles/particle_base.h"
+#include "particles/particle_pool.h"
 #include "display/segment/segment_properties.h"
 
 #include "pico/multicore.h"
@@ -35,7 +36,7 @@ protected:
 	/**
 	 * @brief Generate a new wind centerpoint.
 	 */
-	void reset() override
+	void reset()
 		{
 		// Don't need a lifetime, the center of the wind gust will travel across the field of view and then reset / eventually respawn.
 		mag_ = get_rand_float(2.0f, intensity_factor_); // Calculate how strong this gust of wind will be
@@ -62,11 +63,6 @@ private:
 	using ParticleBase::is_drawable;
 	using ParticleBase::calc_length;
 
-	/**
-	 * @brief does nothing.
-	 */
-	void update_physics() override {};
-
 public:
 	/**
 	 * @param seg_properties The display segment properties reference.
@@ -74,47 +70,62 @@ public:
 	 */
 	WindGust(DisplaySegProperties &seg_properties) : ParticleBase(seg_properties)
 		{
-		intensity_factor_ = seg_properties.get_intensity() * 5.0f;
+		set_intensity(seg_properties.get_intensity());
 		reset();
 		map_force_from_edge(wind_spawn_span_, seg_properties_.get_seg_bounds(), kWindBoundExpansion); // Creation of the valid spawn edge.
+		}
+
+	/**
+	 * @brief Follow a new intensity. The gust in progress carries on; the next
+	 * one is drawn at the new strength.
+	 *
+	 * @param intensity Intensity of the wind.
+	 */
+	void set_intensity(const float intensity)
+		{
+		intensity_factor_ = intensity * 5.0f;
 		wind_chance_ = UINT16_MAX * (intensity_factor_ * 0.01f);
 		}
 
-	~WindGust() override {};
 	/**
+	 * @brief Apply the gust's swirl to every particle in the pool.
+	 * Accelerations are accumulated into the pool and consumed by the next integration step.
 	 *
-	 * @param position Particle position to apply wind to.
-	 * @param accel The particle's acceleration values.
+	 * @param pool The particles to apply wind to.
 	 */
-	void apply_wind(const Position &position, Acceleration& accel) const
+	void apply_wind(ParticlePool &pool) const
 		{
-		// Calculate offset from center
-		const float dx = abs(position.x - positions_.x);
-		const float dy = abs(position.y - positions_.y);
+		const uint16_t count = pool.size();
+		for (uint16_t i = 0; i < count; i++)
+			{
+			// Calculate offset from center
+			const float dx = abs(particle_to_float(pool.x[i]) - positions_.x);
+			const float dy = abs(particle_to_float(pool.y[i]) - positions_.y);
 
-		const float dz = abs(position.z - positions_.z);
+			const float dz = abs(particle_to_float(pool.z[i]) - positions_.z);
 
-		// Calculate distance squared from center
-		const float dist_sq = dx * dx + dy * dy;
+			// Calculate distance squared from center
+			const float dist_sq = dx * dx + dy * dy;
 
-		// Only apply force within radius
-		if (dist_sq > radius2_)
-			return;
+			// Only apply force within radius
+			if (dist_sq > radius2_)
+				continue;
 
-		// Distance falloff: stronger near center, weaker at edges
-		// Takes into account Depth as well.
-		const float dist_factor = (1.0f - (dist_sq * inv_radius2_)) * dz;
+			// Distance falloff: stronger near center, weaker at edges
+			// Takes into account Depth as well.
+			const float dist_factor = (1.0f - (dist_sq * inv_radius2_)) * dz;
 
-		// Create perpendicular force for swirling (rotate offset by 90 degrees)
-		// For clockwise swirl: tangent = (-dy, dx)
-		// For counter-clockwise: tangent = (dy, -dx)
+			// Create perpendicular force for swirling (rotate offset by 90 degrees)
+			// For clockwise swirl: tangent = (-dy, dx)
+			// For counter-clockwise: tangent = (dy, -dx)
 
-		// Combine all strength factors
-		const float strength = mag_ * dist_factor;
+			// Combine all strength factors
+			const float strength = mag_ * dist_factor;
 
-		// Apply swirling force
-		accel.x += -dy * strength;
-		accel.y += dx * strength;
+			// Apply swirling force
+			pool.ax[i] += to_particle(-dy * strength);
+			pool.ay[i] += to_particle(dx * strength);
+			}
 		}
 
 	/**
@@ -129,9 +140,9 @@ public:
 	/*
 	* @brief Updates the wind process.
 	*/
-	void update() override
+	void update()
 		{
-		if (is_alive_ == false && (get_rand_32() > wind_chance_))
+		if (is_alive_ == false && (get_rand_uint32() > wind_chance_))
 			{
 			reset();
 			}
@@ -10,5 +10,10 @@
 // Tomorrow.io API Key
 #define TOMORROW_IO_KEY "your_api_key_here"
 
+// PEM root CA certificate api.tomorrow.io's certificate chains to, used to
+// verify the server. Fetches fail without it. The chain's last certificate
+// shows with: openssl s_client -showcerts -connect api.tomorrow.io:443
+#define TOMORROW_IO_ROOT_CA ""
+
 #endif // SECRETS_H
 
@@ -0,0 +1,44 @@
+#ifndef WALL_CLOCK_H
+#define WALL_CLOCK_H
+
+#include "pico/time.h"
+
+#include <cstdint>
+
+/**
+ * @brief Unix time, once SNTP has set it.
+ *
+ * The board has no battery-backed clock, so until the first SNTP reply the
+ * time is unknown and now() returns 0. After that it counts on from the
+ * microsecond timer.
+ */
+namespace wall_clock
+{
+    inline volatile uint32_t set_unix = 0;  // Unix time when last set, 0 if never.
+    inline volatile uint64_t set_at_us = 0; // time_us_64() when last set.
+
+    inline void set(const uint32_t unix_seconds)
+    {
+        set_at_us = time_us_64();
+        set_unix = unix_seconds;
+    }
+
+    [[nodiscard]] inline bool known()
+    {
+        return set_unix != 0;
+    }
+
+    /**
+     * @brief Seconds since 1970, or 0 if the time isn't known yet.
+     */
+    [[nodiscard]] inline uint32_t now()
+    {
+        if (!known())
+        {
+            return 0;
+        }
+        return set_unix + static_cast<uint32_t>((time_us_64() - set_at_us) / 1'000'000);
+    }
+} // namespace wall_clock
+
+#endif // WALL_CLOCK_H
@@ -0,0 +1,242 @@
+#ifndef WEATHER_CODES_H
+#define WEATHER_CODES_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief The precipitation an effect should show for a weather code. Codes that
+ * mix kinds (e.g. "Rain and Snow") take the first that applies of rain, snow, ice.
+ */
+enum class PrecipKind : uint8_t
+{
+    kNone,
+    kRain, // Rain and drizzle.
+    kSnow, // Snow and flurries.
+    kIce   // Ice pellets.
+};
+
+/**
+ * @brief How heavy the precipitation is, from the description's wording.
+ */
+enum class Intensity : uint8_t
+{
+    kNone,     // No precipitation.
+    kLight,    // Light, drizzle or flurries.
+    kModerate,
+    kHeavy
+};
+
+/**
+ * @brief Sky cover, from the description's wording. Plain precipitation or fog
+ * counts as cloudy.
+ */
+enum class Cloudiness : uint8_t
+{
+    kClear,
+    kMostlyClear,
+    kPartlyCloudy,
+    kMostlyCloudy,
+    kCloudy
+};
+
+// Flags for WeatherDescriptor::flags.
+constexpr uint8_t kFreezing = 1 << 0; // Freezing rain or drizzle.
+constexpr uint8_t kThunder = 1 << 1;  // Thunderstorm.
+constexpr uint8_t kFog = 1 << 2;      // Fog or light fog.
+
+/**
+ * @brief Everything the display needs to know about a Tomorrow.io weather code,
+ * worked out at compile time.
+ */
+struct WeatherDescriptor
+{
+    uint32_t code;
+    std::string_view description;
+    PrecipKind precip;
+    Intensity intensity;
+    Cloudiness cloudiness;
+    uint8_t flags;
+
+    [[nodiscard]] constexpr bool freezing() const { return flags & kFreezing; }
+    [[nodiscard]] constexpr bool thunder() const { return flags & kThunder; }
+    [[nodiscard]] constexpr bool fog() const { return flags & kFog; }
+};
+
+namespace weather_codes
+{
+    // Tomorrow.io day codes (weatherCodeDay). The first entry is returned for unknown codes.
+    constexpr WeatherDescriptor kDescriptors[] = {
+        {0, "Unknown", PrecipKind::kNone, Intensity::kNone, Cloudiness::kClear, 0},
+        {10000, "Clear, Sunny", PrecipKind::kNone, Intensity::kNone, Cloudiness::kClear, 0},
+        {11000, "Mostly Clear", PrecipKind::kNone, Intensity::kNone, Cloudiness::kMostlyClear, 0},
+        {11010, "Partly Cloudy", PrecipKind::kNone, Intensity::kNone, Cloudiness::kPartlyCloudy, 0},
+        {11020, "Mostly Cloudy", PrecipKind::kNone, Intensity::kNone, Cloudiness::kMostlyCloudy, 0},
+        {10010, "Cloudy", PrecipKind::kNone, Intensity::kNone, Cloudiness::kCloudy, 0},
+        {11030, "Partly Cloudy and Mostly Clear", PrecipKind::kNone, Intensity::kNone, Cloudiness::kPartlyCloudy, 0},
+        {21000, "Light Fog", PrecipKind::kNone, Intensity::kNone, Cloudiness::kCloudy, kFog},
+        {21010, "Mostly Clear and Light Fog", PrecipKind::kNone, Intensity::kNone, Cloudiness::kMostlyClear, kFog},
+        {21020, "Partly Cloudy and Light Fog", PrecipKind::kNone, Intensity::kNone, Cloudiness::kPartlyCloudy, kFog},
+        {21030, "Mostly Cloudy and Light Fog", PrecipKind::kNone, Intensity::kNone, Cloudiness::kMostlyCloudy, kFog},
+        {21060, "Mostly Clear and Fog", PrecipKind::kNone, Intensity::kNone, Cloudiness::kMostlyClear, kFog},
+        {21070, "Partly Cloudy and Fog", PrecipKind::kNone, Intensity::kNone, Cloudiness::kPartlyCloudy, kFog},
+        {21080, "Mostly Cloudy and Fog", PrecipKind::kNone, Intensity::kNone, Cloudiness::kMostlyCloudy, kFog},
+        {20000, "Fog", PrecipKind::kNone, Intensity::kNone, Cloudiness::kCloudy, kFog},
+        {42040, "Partly Cloudy and Drizzle", PrecipKind::kRain, Intensity::kLight, Cloudiness::kPartlyCloudy, 0},
+        {42030, "Mostly Clear and Drizzle", PrecipKind::kRain, Intensity::kLight, Cloudiness::kMostlyClear, 0},
+        {42050, "Mostly Cloudy and Drizzle", PrecipKind::kRain, Intensity::kLight, Cloudiness::kMostlyCloudy, 0},
+        {40000, "Drizzle", PrecipKind::kRain, Intensity::kLight, Cloudiness::kCloudy, 0},
+        {42000, "Light Rain", PrecipKind::kRain, Intensity::kLight, Cloudiness::kCloudy, 0},
+        {42130, "Mostly Clear and Light Rain", PrecipKind::kRain, Intensity::kLight, Cloudiness::kMostlyClear, 0},
+        {42140, "Partly Cloudy and Light Rain", PrecipKind::kRain, Intensity::kLight, Cloudiness::kPartlyCloudy, 0},
+        {42150, "Mostly Cloudy and Light Rain", PrecipKind::kRain, Intensity::kLight, Cloudiness::kMostlyCloudy, 0},
+        {42090, "Mostly Clear and Rain", PrecipKind::kRain, Intensity::kModerate, Cloudiness::kMostlyClear, 0},
+        {42080, "Partly Cloudy and Rain", PrecipKind::kRain, Intensity::kModerate, Cloudiness::kPartlyCloudy, 0},
+        {42100, "Mostly Cloudy and Rain", PrecipKind::kRain, Intensity::kModerate, Cloudiness::kMostlyCloudy, 0},
+        {40010, "Rain", PrecipKind::kRain, Intensity::kModerate, Cloudiness::kCloudy, 0},
+        {42110, "Mostly Clear and Heavy Rain", PrecipKind::kRain, Intensity::kHeavy, Cloudiness::kMostlyClear, 0},
+        {42020, "Partly Cloudy and Heavy Rain", PrecipKind::kRain, Intensity::kHeavy, Cloudiness::kPartlyCloudy, 0},
+        {42120, "Mostly Cloudy and Heavy Rain", PrecipKind::kRain, Intensity::kHeavy, Cloudiness::kMostlyCloudy, 0},
+        {42010, "Heavy Rain", PrecipKind::kRain, Intensity::kHeavy, Cloudiness::kCloudy, 0},
+        {51150, "Mostly Clear and Flurries", PrecipKind::kSnow, Intensity::kLight, Cloudiness::kMostlyClear, 0},
+        {51160, "Partly Cloudy and Flurries", PrecipKind::kSnow, Intensity::kLight, Cloudiness::kPartlyCloudy, 0},
+        {51170, "Mostly Cloudy and Flurries", PrecipKind::kSnow, Intensity::kLight, Cloudiness::kMostlyCloudy, 0},
+        {50010, "Flurries", PrecipKind::kSnow, Intensity::kLight, Cloudiness::kCloudy, 0},
+        {51000, "Light Snow", PrecipKind::kSnow, Intensity::kLight, Cloudiness::kCloudy, 0},
+        {51020, "Mostly Clear and Light Snow", PrecipKind::kSnow, Intensity::kLight, Cloudiness::kMostlyClear, 0},
+        {51030, "Partly Cloudy and Light Snow", PrecipKind::kSnow, Intensity::kLight, Cloudiness::kPartlyCloudy, 0},
+        {51040, "Mostly Cloudy and Light Snow", PrecipKind::kSnow, Intensity::kLight, Cloudiness::kMostlyCloudy, 0},
+        {51220, "Drizzle and Light Snow", PrecipKind::kRain, Intensity::kLight, Cloudiness::kCloudy, 0},
+        {51050, "Mostly Clear and Snow", PrecipKind::kSnow, Intensity::kModerate, Cloudiness::kMostlyClear, 0},
+        {51060, "Partly Cloudy and Snow", PrecipKind::kSnow, Intensity::kModerate, Cloudiness::kPartlyCloudy, 0},
+        {51070, "Mostly Cloudy and Snow", PrecipKind::kSnow, Intensity::kModerate, Cloudiness::kMostlyCloudy, 0},
+        {50000, "Snow", PrecipKind::kSnow, Intensity::kModerate, Cloudiness::kCloudy, 0},
+        {51010, "Heavy Snow", PrecipKind::kSnow, Intensity::kHeavy, Cloudiness::kCloudy, 0},
+        {51190, "Mostly Clear and Heavy Snow", PrecipKind::kSnow, Intensity::kHeavy, Cloudiness::kMostlyClear, 0},
+        {51200, "Partly Cloudy and Heavy Snow", PrecipKind::kSnow, Intensity::kHeavy, Cloudiness::kPartlyCloudy, 0},
+        {51210, "Mostly Cloudy and Heavy Snow", PrecipKind::kSnow, Intensity::kHeavy, Cloudiness::kMostlyCloudy, 0},
+        {51100, "Drizzle and Snow", PrecipKind::kRain, Intensity::kLight, Cloudiness::kCloudy, 0},
+        {51080, "Rain and Snow", PrecipKind::kRain, Intensity::kModerate, Cloudiness::kCloudy, 0},
+        {51140, "Snow and Freezing Rain", PrecipKind::kRain, Intensity::kModerate, Cloudiness::kCloudy, kFreezing},
+        {51120, "Snow and Ice Pellets", PrecipKind::kSnow, Intensity::kModerate, Cloudiness::kCloudy, 0},
+        {60000, "Freezing Drizzle", PrecipKind::kRain, Intensity::kLight, Cloudiness::kCloudy, kFreezing},
+        {60030, "Mostly Clear and Freezing drizzle", PrecipKind::kRain, Intensity::kLight, Cloudiness::kMostlyClear, kFreezing},
+        {60020, "Partly Cloudy and Freezing drizzle", PrecipKind::kRain, Intensity::kLight, Cloudiness::kPartlyCloudy, kFreezing},
+        {60040, "Mostly Cloudy and Freezing drizzle", PrecipKind::kRain, Intensity::kLight, Cloudiness::kMostlyCloudy, kFreezing},
+        {62040, "Drizzle and Freezing Drizzle", PrecipKind::kRain, Intensity::kLight, Cloudiness::kCloudy, kFreezing},
+        {62060, "Light Rain and Freezing Drizzle", PrecipKind::kRain, Intensity::kLight, Cloudiness::kCloudy, kFreezing},
+        {62050, "Mostly Clear and Light Freezing Rain", PrecipKind::kRain, Intensity::kLight, Cloudiness::kMostlyClear, kFreezing},
+        {62030, "Partly Cloudy and Light Freezing Rain", PrecipKind::kRain, Intensity::kLight, Cloudiness::kPartlyCloudy, kFreezing},
+        {62090, "Mostly Cloudy and Light Freezing Rain", PrecipKind::kRain, Intensity::kLight, Cloudiness::kMostlyCloudy, kFreezing},
+        {62000, "Light Freezing Rain", PrecipKind::kRain, Intensity::kLight, Cloudiness::kCloudy, kFreezing},
+        {62130, "Mostly Clear and Freezing Rain", PrecipKind::kRain, Intensity::kModerate, Cloudiness::kMostlyClear, kFreezing},
+        {62140, "Partly Cloudy and Freezing Rain", PrecipKind::kRain, Intensity::kModerate, Cloudiness::kPartlyCloudy, kFreezing},
+        {62150, "Mostly Cloudy and Freezing Rain", PrecipKind::kRain, Intensity::kModerate, Cloudiness::kMostlyCloudy, kFreezing},
+        {60010, "Freezing Rain", PrecipKind::kRain, Intensity::kModerate, Cloudiness::kCloudy, kFreezing},
+        {62120, "Drizzle and Freezing Rain", PrecipKind::kRain, Intensity::kLight, Cloudiness::kCloudy, kFreezing},
+        {62200, "Light Rain and Freezing Rain", PrecipKind::kRain, Intensity::kLight, Cloudiness::kCloudy, kFreezing},
+        {62220, "Rain and Freezing Rain", PrecipKind::kRain, Intensity::kModerate, Cloudiness::kCloudy, kFreezing},
+        {62070, "Mostly Clear and Heavy Freezing Rain", PrecipKind::kRain, Intensity::kHeavy, Cloudiness::kMostlyClear, kFreezing},
+        {62020, "Partly Cloudy and Heavy Freezing Rain", PrecipKind::kRain, Intensity::kHeavy, Cloudiness::kPartlyCloudy, kFreezing},
+        {62080, "Mostly Cloudy and Heavy Freezing Rain", PrecipKind::kRain, Intensity::kHeavy, Cloudiness::kMostlyCloudy, kFreezing},
+        {62010, "Heavy Freezing Rain", PrecipKind::kRain, Intensity::kHeavy, Cloudiness::kCloudy, kFreezing},
+        {71100, "Mostly Clear and Light Ice Pellets", PrecipKind::kIce, Intensity::kLight, Cloudiness::kMostlyClear, 0},
+        {71110, "Partly Cloudy and Light Ice Pellets", PrecipKind::kIce, Intensity::kLight, Cloudiness::kPartlyCloudy, 0},
+        {71120, "Mostly Cloudy and Light Ice Pellets", PrecipKind::kIce, Intensity::kLight, Cloudiness::kMostlyCloudy, 0},
+        {71020, "Light Ice Pellets", PrecipKind::kIce, Intensity::kLight, Cloudiness::kCloudy, 0},
+        {71080, "Mostly Clear and Ice Pellets", PrecipKind::kIce, Intensity::kModerate, Cloudiness::kMostlyClear, 0},
+        {71070, "Partly Cloudy and Ice Pellets", PrecipKind::kIce, Intensity::kModerate, Cloudiness::kPartlyCloudy, 0},
+        {71090, "Mostly Cloudy and Ice Pellets", PrecipKind::kIce, Intensity::kModerate, Cloudiness::kMostlyCloudy, 0},
+        {70000, "Ice Pellets", PrecipKind::kIce, Intensity::kModerate, Cloudiness::kCloudy, 0},
+        {71050, "Drizzle and Ice Pellets", PrecipKind::kRain, Intensity::kLight, Cloudiness::kCloudy, 0},
+        {71060, "Freezing Rain and Ice Pellets", PrecipKind::kRain, Intensity::kModerate, Cloudiness::kCloudy, kFreezing},
+        {71150, "Light Rain and Ice Pellets", PrecipKind::kRain, Intensity::kLight, Cloudiness::kCloudy, 0},
+        {71170, "Rain and Ice Pellets", PrecipKind::kRain, Intensity::kModerate, Cloudiness::kCloudy, 0},
+        {71030, "Freezing Rain and Heavy Ice Pellets", PrecipKind::kRain, Intensity::kHeavy, Cloudiness::kCloudy, kFreezing},
+        {71130, "Mostly Clear and Heavy Ice Pellets", PrecipKind::kIce, Intensity::kHeavy, Cloudiness::kMostlyClear, 0},
+        {71140, "Partly Cloudy and Heavy Ice Pellets", PrecipKind::kIce, Intensity::kHeavy, Cloudiness::kPartlyCloudy, 0},
+        {71160, "Mostly Cloudy and Heavy Ice Pellets", PrecipKind::kIce, Intensity::kHeavy, Cloudiness::kMostlyCloudy, 0},
+        {71010, "Heavy Ice Pellets", PrecipKind::kIce, Intensity::kHeavy, Cloudiness::kCloudy, 0},
+        {80010, "Mostly Clear and Thunderstorm", PrecipKind::kNone, Intensity::kNone, Cloudiness::kMostlyClear, kThunder},
+        {80030, "Partly Cloudy and Thunderstorm", PrecipKind::kNone, Intensity::kNone, Cloudiness::kPartlyCloudy, kThunder},
+        {80020, "Mostly Cloudy and Thunderstorm", PrecipKind::kNone, Intensity::kNone, Cloudiness::kMostlyCloudy, kThunder},
+        {80000, "Thunderstorm", PrecipKind::kNone, Intensity::kNone, Cloudiness::kCloudy, kThunder}
+    };
+
+    /**
+     * @brief Slot of a day code in the lookup index, or -1 if it can't be one.
+     * Day codes are five digits ABCCD: A is the group (1-8), B is 0-2, CC is
+     * 00-22 and D is 0 for day or 1 for night. A night code shares its day
+     * code's slot, e.g. 10001 (Clear) looks up as 10000 (Clear, Sunny).
+     */
+    constexpr int16_t code_slot(const uint32_t code)
+    {
+        if (code < 10000 || code > 89999 || code % 10 > 1)
+        {
+            return -1;
+        }
+        const uint32_t group = code / 10000;
+        const uint32_t variant = (code / 1000) % 10;
+        const uint32_t detail = (code / 10) % 100;
+        if (variant > 2 || detail > 22)
+        {
+            return -1;
+        }
+        return static_cast<int16_t>((group * 3 + variant) * 23 + detail);
+    }
+
+    constexpr size_t kNumSlots = 9 * 3 * 23;
+
+    /**
+     * @brief Build the index from slot to descriptor, 0 (Unknown) for slots with no code.
+     */
+    constexpr std::array<uint8_t, kNumSlots> build_index()
+    {
+        std::array<uint8_t, kNumSlots> index{};
+        for (size_t i = 1; i < std::size(kDescriptors); i++)
+        {
+            index[code_slot(kDescriptors[i].code)] = static_cast<uint8_t>(i);
+        }
+        return index;
+    }
+
+    constexpr std::array<uint8_t, kNumSlots> kIndex = build_index();
+
+    /**
+     * @brief Check every code has a slot of its own.
+     */
+    constexpr bool codes_map_uniquely()
+    {
+        for (size_t i = 1; i < std::size(kDescriptors); i++)
+        {
+            if (code_slot(kDescriptors[i].code) < 0 || kIndex[code_slot(kDescriptors[i].code)] != i)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(std::size(kDescriptors) < 256, "Descriptor index must fit a uint8_t");
+    static_assert(codes_map_uniquely(), "Every weather code needs a unique slot");
+} // namespace weather_codes
+
+/**
+ * @brief Look up a Tomorrow.io day weather code. O(1), no allocation.
+ *
+ * @param code Weather code, e.g. 42010 for Heavy Rain.
+ * @return const WeatherDescriptor& The code's descriptor, or the Unknown one.
+ */
+constexpr const WeatherDescriptor &weather_descriptor(const uint32_t code)
+{
+    const int16_t slot = weather_codes::code_slot(code);
+    return weather_codes::kDescriptors[slot < 0 ? 0 : weather_codes::kIndex[slot]];
+}
+
+static_assert(weather_descriptor(42010).precip == PrecipKind::kRain);
+static_assert(weather_descriptor(62010).freezing());
+static_assert(weather_descriptor(12345).code == 0);
+static_assert(weather_descriptor(10001).code == 10000);
+
+#endif // WEATHER_CODES_H
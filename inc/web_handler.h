@@ -5,9 +5,18 @@
 #include "pico/cyw43_arch.h"
 #include "pico/time.h"
 
+#include "day_forecast.h"
+#include "forecast_mailbox.h"
+#include "forecast_parser.h"
+#include "forecast_store.h"
+#include "http_client.h"
+#include "wall_clock.h"
+
+#include "lwip/apps/sntp.h"
+
+#include <array>
+#include <span>
 #include <string>
-#include <vector>
-#include <map>
 
 namespace weather
 {
@@ -20,9 +29,24 @@ namespace weather
      * - NTP time synchronization
      * - Geolocation via IP
      * - Weather data fetching from Tomorrow.io API
+     *
+     * The weather fetch never blocks: start_weather_fetch() sends it off,
+     * poll_weather_fetch() runs the network stack and moves it on once a
+     * frame, and the forecast is parsed as it streams in. A finished forecast
+     * is published whole to a mailbox for the display loop to take_forecast().
+     *
+     * The last good forecast is kept in flash. load_cached_forecast() shows it
+     * at boot, and weather_fetch_due() only asks for a new one once it's stale,
+     * so a reboot doesn't cost an API call.
      */
     class WebHandler
     {
+    public:
+        static constexpr uint8_t kMaxDays = 7;                  // Most days a forecast can hold.
+        static constexpr uint64_t kFetchTimeoutUs = 20'000'000; // Give up on a fetch after this long.
+        static constexpr uint64_t kRetryUs = 60'000'000;        // Least time between starting fetches.
+        static constexpr uint64_t kClockWaitUs = 10'000'000;    // How long to wait for SNTP before assuming a cached forecast is stale.
+
     private:
         std::string ssid_;
         std::string password_;
@@ -31,9 +55,28 @@ namespace weather
         float longitude_;
         bool connected_;
 
+        std::string api_host_ = "api.tomorrow.io";     // Weather API server.
+        uint16_t api_port_ = 443;                      // Weather API port.
+        bool api_tls_ = true;                          // Whether the API is reached over TLS.
+
+        std::array<DayForecast, kMaxDays> incoming_{}; // Days being parsed, only seen by the fetch.
+        ForecastParser parser_{incoming_};             // Parses the response as it arrives.
+        HttpGet<ForecastParser> http_;                 // The fetch in progress.
+        ForecastMailbox<kMaxDays> forecasts_;          // Finished forecasts, for the display loop.
+        ForecastStore<kMaxDays> store_;                // Last good forecast, kept in flash.
+
+        bool have_forecast_ = false;                   // A forecast has been loaded or fetched.
+        bool fetched_this_boot_ = false;               // It was fetched since boot, at fetched_us_.
+        uint64_t fetched_us_ = 0;                      // When it was fetched, if since boot.
+        uint32_t fetched_unix_ = 0;                    // When it was fetched, 0 if the time wasn't known.
+        bool fetch_started_ = false;                   // A fetch has been started since boot.
+        uint64_t fetch_started_us_ = 0;                // When the last fetch was started.
+        uint64_t sync_started_us_ = 0;                 // When sync_time() was called, 0 if not yet.
+
     public:
-        WebHandler(const std::string &ssid, const std::string &password, const std::string &api_key)
-            : ssid_(ssid), password_(password), api_key_(api_key), latitude_(0.0f), longitude_(0.0f), connected_(false)
+        WebHandler(const std::string &ssid, const std::string &password, const std::string &api_key, const char *api_root_ca = nullptr)
+            : ssid_(ssid), password_(password), api_key_(api_key), latitude_(0.0f), longitude_(0.0f), connected_(false),
+              http_(parser_, api_root_ca)
         {
         }
 
@@ -94,16 +137,20 @@ namespace weather
         }
 
         /**
-         * @brief Synchronize time using NTP
-         * @return true if successful
+         * @brief Start synchronizing the wall clock over SNTP. Returns at once;
+         * the time arrives during later polls, see wall_clock::now().
+         * @return true if the SNTP client was started
          */
         bool sync_time()
         {
-            // TODO: Implement NTP client
-            // This would require implementing SNTP protocol
-            // For now, this is a placeholder
-            printf("Time sync not yet implemented\n");
-            return false;
+            cyw43_arch_lwip_begin();
+            sntp_setoperatingmode(SNTP_OPMODE_POLL);
+            sntp_setservername(0, "pool.ntp.org");
+            sntp_init();
+            cyw43_arch_lwip_end();
+            sync_started_us_ = std::max<uint64_t>(time_us_64(), 1);
+            printf("Time sync started\n");
+            return true;
         }
 
         /**
@@ -120,45 +167,167 @@ namespace weather
         }
 
         /**
-         * @brief Fetch weather data from Tomorrow.io API
-         * @param num_days Number of days to fetch (1-3)
-         * @return Vector of weather interval data (one map per day)
+         * @brief Point the weather fetch at another server, e.g. a local one for testing.
+         *
+         * @param host Server name or address.
+         * @param port Server port.
+         * @param tls Whether to use TLS.
+         */
+        void set_weather_api(const std::string &host, const uint16_t port, const bool tls)
+        {
+            api_host_ = host;
+            api_port_ = port;
+            api_tls_ = tls;
+        }
+
+        /**
+         * @brief Start fetching the forecast from Tomorrow.io. Returns at once;
+         * call poll_weather_fetch() every frame until it's finished.
+         *
+         * @param num_days Number of days to fetch (1 to kMaxDays)
+         * @return false if a fetch is already running or couldn't be started
+         */
+        bool start_weather_fetch(const uint8_t num_days)
+        {
+            if (http_.busy())
+            {
+                return false;
+            }
+            fetch_started_ = true;
+            fetch_started_us_ = time_us_64();
+            parser_ = ForecastParser(std::span(incoming_).first(std::clamp<uint8_t>(num_days, 1, kMaxDays)));
+
+            char path[512];
+            snprintf(path, sizeof(path),
+                     "/v4/timelines?location=%.4f,%.4f"
+                     "&fields=weatherCodeDay,temperature,windSpeed,windDirection,cloudCover,"
+                     "precipitationIntensity,precipitationType,precipitationProbability,"
+                     "snowAccumulation,iceAccumulation,sunriseTime,sunsetTime"
+                     "&timesteps=1d&units=imperial&startTime=now&endTime=nowPlus%ud&apikey=%s",
+                     latitude_, longitude_, num_days, api_key_.c_str());
+            return http_.start(api_host_, api_port_, path, api_tls_, kFetchTimeoutUs);
+        }
+
+        /**
+         * @brief Let the network stack run, and move the weather fetch on by
+         * whatever it has delivered. Call every frame, fetching or not: in poll
+         * mode this is the only time lwIP and the CYW43 driver get to run, so
+         * SNTP, DHCP, ARP and link changes wait on it too.
+         *
+         * @return true if this call finished a fetch and published a new forecast
+         */
+        bool poll_weather_fetch()
+        {
+            // The callbacks run inside the poll and can finish the fetch there.
+            const bool fetching = http_.busy();
+            cyw43_arch_poll();
+            if (!fetching)
+            {
+                return false;
+            }
+            if (http_.poll() != FetchState::kDone)
+            {
+                return false;
+            }
+            if (!parser_.complete())
+            {
+                printf("Weather fetch returned %zu bytes without a whole forecast\n", http_.body_bytes());
+                return false;
+            }
+
+            const std::span<const DayForecast> days = std::span<const DayForecast>(incoming_).first(parser_.days_parsed());
+            forecasts_.publish(days);
+            printf("Weather fetched: %u days, %zu bytes in %llu ms\n", parser_.days_parsed(), http_.body_bytes(),
+                   static_cast<unsigned long long>(http_.elapsed_us() / 1000));
+
+            have_forecast_ = true;
+            fetched_this_boot_ = true;
+            fetched_us_ = time_us_64();
+            fetched_unix_ = wall_clock::now();
+            store_.save(days, fetched_unix_);
+            return true;
+        }
+
+        /**
+         * @brief Publish the forecast kept in flash, if there is one, for the
+         * display to show before the network is up.
+         *
+         * @return Days loaded, 0 if nothing is stored.
          */
-        std::vector<std::map<std::string, std::string>> get_weather_data(int num_days)
+        size_t load_cached_forecast()
         {
-            std::vector<std::map<std::string, std::string>> weather_intervals;
-
-            // TODO: Implement HTTP GET request to Tomorrow.io API
-            // This requires:
-            // 1. Building the URL with parameters
-            // 2. Making HTTP GET request
-            // 3. Parsing JSON response
-            // 4. Extracting weather data for each day
-            //
-            // For now, return empty data
-            printf("Weather API fetch not yet implemented\n");
-
-            // Return empty intervals for now
-            for (int i = 0; i < num_days; ++i)
+            std::array<DayForecast, kMaxDays> days{};
+            const size_t count = store_.load(days, fetched_unix_);
+            if (count == 0)
             {
-                std::map<std::string, std::string> interval;
-                interval["weather_description"] = "Clear, Sunny";
-                interval["weatherCodeDay"] = "10000";
-                interval["temperature"] = "65";
-                interval["windSpeed"] = "10";
-                interval["windDirection"] = "180";
-                interval["cloudCover"] = "10";
-                interval["precipitationType"] = "0";
-                interval["precipitationIntensity"] = "0";
-                interval["snowAccumulation"] = "0";
-                interval["iceAccumulation"] = "0";
-                interval["day"] = "Monday";
-                weather_intervals.push_back(interval);
+                printf("No cached forecast\n");
+                return 0;
             }
+            forecasts_.publish(std::span<const DayForecast>(days).first(count));
+            have_forecast_ = true;
+            printf("Cached forecast: %zu days, record %lu, fetched at %lu\n", count,
+                   static_cast<unsigned long>(store_.newest().sequence), static_cast<unsigned long>(fetched_unix_));
+            return count;
+        }
 
-            return weather_intervals;
+        /**
+         * @brief Seconds since the forecast was fetched: UINT32_MAX if there's
+         * none or its age can't be known, 0 while waiting on the clock to tell.
+         */
+        [[nodiscard]] uint32_t forecast_age_s() const
+        {
+            if (fetched_this_boot_)
+            {
+                return static_cast<uint32_t>((time_us_64() - fetched_us_) / 1'000'000);
+            }
+            if (!have_forecast_ || fetched_unix_ == 0)
+            {
+                return UINT32_MAX;
+            }
+            if (!wall_clock::known())
+            {
+                const bool gave_up = sync_started_us_ != 0 && time_us_64() - sync_started_us_ > kClockWaitUs;
+                return gave_up ? UINT32_MAX : 0;
+            }
+            const uint32_t now = wall_clock::now();
+            return now > fetched_unix_ ? now - fetched_unix_ : 0;
         }
 
+        /**
+         * @brief Whether to start a fetch now: the forecast is older than
+         * max_age_s and the last fetch was started at least kRetryUs ago.
+         */
+        [[nodiscard]] bool weather_fetch_due(const uint32_t max_age_s) const
+        {
+            if (http_.busy() || (fetch_started_ && time_us_64() - fetch_started_us_ < kRetryUs))
+            {
+                return false;
+            }
+            return forecast_age_s() >= max_age_s;
+        }
+
+        /**
+         * @brief Erase flash for the forecasts to come, see ForecastStore::erase_ahead().
+         * Call it while the display is idle, where the stall isn't seen.
+         */
+        bool erase_store_ahead() { return store_.erase_ahead(); }
+
+        [[nodiscard]] const ForecastStore<kMaxDays> &store() const { return store_; }
+
+        /**
+         * @brief Copy out the newest forecast, if one has arrived since the last call.
+         * Safe to call from the other core to the fetch.
+         *
+         * @param days Where to copy it.
+         * @return Days copied, 0 if there's nothing new.
+         */
+        size_t take_forecast(const std::span<DayForecast> days)
+        {
+            return forecasts_.take(days);
+        }
+
+        [[nodiscard]] FetchState fetch_state() const { return http_.state(); }
+
         // Getters
         float latitude() const { return latitude_; }
         float longitude() const { return longitude_; }
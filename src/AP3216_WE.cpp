@@ -55,11 +55,10 @@ uint8_t AP3216_WE::getIntClearManner()
 
 uint16_t AP3216_WE::getIRData()
 {
-    uint8_t lowByte, highByte;
+    uint8_t data[2];
     uint16_t irData = 0x0000;
-    lowByte = readReg(IR_DATA_LOW_REG) & 0b00000011;
-    highByte = readReg(IR_DATA_HIGH_REG);
-    irData = (highByte << 2) + lowByte;
+    readRegs(IR_DATA_LOW_REG, data, 2);
+    irData = (data[1] << 2) + (data[0] & 0b00000011);
     return irData;
 }
 
@@ -75,8 +74,11 @@ bool AP3216_WE::irDataIsOverflowed()
 
 float AP3216_WE::getAmbientLight()
 {
-    uint16_t rawALS = 0;
-    rawALS = getALSData();
+    return alsToLux(getALSData());
+}
+
+float AP3216_WE::alsToLux(uint16_t rawALS)
+{
     float als = 0;
 
     switch (luxRange)
@@ -103,11 +105,10 @@ float AP3216_WE::getAmbientLight()
 
 uint16_t AP3216_WE::getProximity()
 {
-    uint8_t lowByte, highByte;
+    uint8_t data[2];
     uint16_t proximity = 0x0000;
-    lowByte = readReg(PS_DATA_LOW_REG) & 0b00001111;
-    highByte = readReg(PS_DATA_HIGH_REG) & 0b00111111;
-    proximity = (highByte << 4) + lowByte;
+    readRegs(PS_DATA_LOW_REG, data, 2);
+    proximity = ((data[1] & 0b00111111) << 4) + (data[0] & 0b00001111);
     return proximity;
 }
 
@@ -131,6 +132,25 @@ bool AP3216_WE::objectIsNear()
         return false;
 }
 
+AP3216Data AP3216_WE::getAllData()
+{
+    uint8_t data[6]; // IR_DATA_LOW_REG to PS_DATA_HIGH_REG
+    readRegs(IR_DATA_LOW_REG, data, 6);
+    return decodeData(data);
+}
+
+AP3216Data AP3216_WE::decodeData(const uint8_t *data)
+{
+    AP3216Data all;
+    all.ir = (data[1] << 2) + (data[0] & 0b00000011);
+    all.irOverflowed = (data[0] & 0b10000000) != 0;
+    all.als = (data[3] << 8) + data[2];
+    all.proximity = ((data[5] & 0b00111111) << 4) + (data[4] & 0b00001111);
+    all.proximityValid = (data[4] & 0b01000000) == 0;
+    all.objectNear = (data[5] >> 7) == 1;
+    return all;
+}
+
 void AP3216_WE::setLuxRange(ap3216_lux_range lr)
 {
     uint8_t alsConfigReg;
@@ -344,10 +364,9 @@ void AP3216_WE::setPSThresholds(uint16_t lowThres, uint16_t highThres)
 
 uint16_t AP3216_WE::getALSData()
 {
-    uint8_t lowByte, highByte;
-    lowByte = readReg(ALS_DATA_LOW_REG);
-    highByte = readReg(ALS_DATA_HIGH_REG);
-    uint16_t als = (highByte << 8) + lowByte;
+    uint8_t data[2];
+    readRegs(ALS_DATA_LOW_REG, data, 2);
+    uint16_t als = (data[1] << 8) + data[0];
     return als;
 }
 
@@ -396,7 +415,84 @@ void AP3216_WE::writeReg(uint8_t reg, uint8_t val)
 uint8_t AP3216_WE::readReg(uint8_t reg)
 {
     uint8_t regVal = 0; // received data
-    i2c_write_blocking(i2c_, I2C_ADDR, &reg, 1, true);
-    i2c_read_blocking(i2c_, I2C_ADDR, &regVal, 1, false);
+    readRegs(reg, &regVal, 1);
     return regVal;
 }
+
+void AP3216_WE::readRegs(uint8_t reg, uint8_t *dst, uint8_t len)
+{
+    i2c_write_blocking(i2c_, I2C_ADDR, &reg, 1, true); // keep the bus for a repeated start
+    i2c_read_blocking(i2c_, I2C_ADDR, dst, len, false);
+}
+
+bool AP3216_WE::startReadRegs(uint8_t reg, uint8_t len)
+{
+    if (burstLen != 0 || len == 0 || len > MAX_BURST_LEN || i2c_get_write_available(i2c_) < len + 1u)
+    {
+        return false;
+    }
+
+    i2c_hw_t *hw = i2c_get_hw(i2c_);
+    hw->enable = 0; // the target address can only change while disabled
+    hw->tar = I2C_ADDR;
+    hw->enable = 1;
+
+    hw->data_cmd = reg;
+    for (uint8_t i = 0; i < len; i++)
+    {
+        uint32_t cmd = I2C_IC_DATA_CMD_CMD_BITS;
+        if (i == 0)
+        {
+            cmd |= I2C_IC_DATA_CMD_RESTART_BITS;
+        }
+        if (i == len - 1)
+        {
+            cmd |= I2C_IC_DATA_CMD_STOP_BITS;
+        }
+        hw->data_cmd = cmd;
+    }
+    burstLen = len;
+    return true;
+}
+
+ap3216_burst_status AP3216_WE::pollReadRegs(uint8_t *dst)
+{
+    if (burstLen == 0)
+    {
+        return BURST_IDLE;
+    }
+
+    i2c_hw_t *hw = i2c_get_hw(i2c_);
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+    {
+        (void)hw->clr_tx_abrt; // reading clears the abort
+        while (i2c_get_read_available(i2c_) > 0)
+        {
+            (void)hw->data_cmd;
+        }
+        burstLen = 0;
+        return BURST_FAILED;
+    }
+    if (i2c_get_read_available(i2c_) < burstLen)
+    {
+        return BURST_BUSY;
+    }
+
+    for (uint8_t i = 0; i < burstLen; i++)
+    {
+        dst[i] = static_cast<uint8_t>(hw->data_cmd);
+    }
+    burstLen = 0;
+    return BURST_DONE;
+}
+
+ap3216_burst_status AP3216_WE::waitReadRegs(uint8_t *dst)
+{
+    ap3216_burst_status status = pollReadRegs(dst);
+    while (status == BURST_BUSY)
+    {
+        busy_wait_us_32(1);
+        status = pollReadRegs(dst);
+    }
+    return status;
+}
@@ -38,6 +38,7 @@ int main()
 {
 
     stdio_usb_init();          // Start the USB printf output.
+    seed_rng(get_rand_64());   // Different particles every boot, the debug console can fix the seed.
     hub75.start(dma_complete); // Start the HUB75 driver.
     set_sys_clock_khz(kClockspeed, true);
     graphics.clear_framebuffer();
@@ -75,62 +76,75 @@ using namespace weather;
  * @brief Main weather display program
  *
  * This function:
- * 1. Connects to WiFi
- * 2. Syncs time via NTP
- * 3. Gets location from IP
- * 4. Fetches weather data
+ * 1. Shows the forecast cached in flash, if any
+ * 2. Connects to WiFi
+ * 3. Syncs time via SNTP and gets location from IP
+ * 4. Fetches weather data whenever the forecast is MINS_BEFORE_REFRESH minutes old
  * 5. Continuously updates and displays weather
+ *
+ * Fetches run alongside the animation: one is started, then moved on a
+ * little each frame, and the display switches over when a whole forecast
+ * has arrived.
+ *
+ * The handlers live on the heap: core 0's stack is small, and the TLS
+ * handshake runs on it too, inside cyw43_arch_poll().
  */
 static void start_weather_display()
 {
     printf("Initializing weather display...\n");
 
-    /*
-    // Create web handler
-    WebHandler web(NETWORK, PASSWORD, TOMORROW_IO_KEY);
+    const auto web_owner = std::make_unique<WebHandler>(NETWORK, PASSWORD, TOMORROW_IO_KEY, TOMORROW_IO_ROOT_CA);
+    const auto handler_owner = std::make_unique<WeatherDisplayHandler>(graphics, hub75, NUM_DAYS, 75.0f);
+    WebHandler &web = *web_owner;
+    WeatherDisplayHandler &weather_handler = *handler_owner;
+    std::array<DayForecast, NUM_DAYS> forecast{};
+
+    // Show the last good forecast straight away, while the network comes up.
+    if (web.load_cached_forecast() > 0)
+    {
+        const size_t days = web.take_forecast(forecast);
+        weather_handler.update_weather(std::span<const DayForecast>(forecast).first(days));
+    }
+    weather_handler.refresh_and_update_display();
 
     // Initialize WiFi and get location
-    if (!web.initialize()) {
+    if (!web.initialize())
+    {
         printf("Failed to initialize web handler\n");
         return;
     }
-    */
-
-    // Create weather display handler
-    // WeatherDisplayHandler weather_handler(graphics, hub75, NUM_DAYS);
-
-    // Fetch initial weather data
-    printf("Fetching weather data...\n");
-    // auto weather_data = web.get_weather_data(NUM_DAYS);
-    // weather_handler.update_weather(weather_data);
-
-    // Get current time for refresh tracking
-    // datetime_t current_time;
-    // rtc_get_datetime(&current_time);
-    // uint8_t prev_minute = current_time.min;
+    web.sync_time();
 
     printf("Entering main display loop...\n");
+    bool was_idle = false;
 
-    /*
     // Main display loop
-    while (true) {
-        // Check if it's time to refresh weather data
-        //rtc_get_datetime(&current_time);
-        if (current_time.min >= (prev_minute + MINS_BEFORE_REFRESH)) {
-            prev_minute = current_time.min;
-            printf("Refreshing weather data at %02d:%02d:%02d...\n",
-                   current_time.hour, current_time.min, current_time.sec);
-            weather_data = web.get_weather_data(NUM_DAYS);
-            weather_handler.update_weather(weather_data);
+    while (true)
+    {
+        // Fetch weather data once the forecast shown is stale
+        if (web.weather_fetch_due(MINS_BEFORE_REFRESH * 60))
+        {
+            printf("Fetching weather data...\n");
+            web.start_weather_fetch(NUM_DAYS);
+        }
+
+        web.poll_weather_fetch();
+        if (const size_t days = web.take_forecast(forecast))
+        {
+            weather_handler.update_weather(std::span<const DayForecast>(forecast).first(days));
         }
 
-        // Render frame
+        // Render frame, paced to the target FPS
         weather_handler.refresh_and_update_display();
 
-        // Small delay to control frame rate
-        sleep_us(5);
+        // Get flash erases out of the way while nobody can see the panel stall
+        const bool idle = weather_handler.get_idle_mode().state() == PowerState::kIdle;
+        if (idle && !was_idle)
+        {
+            web.erase_store_ahead();
+        }
+        was_idle = idle;
     }
-    */
 }
 
 /**
@@ -141,12 +155,12 @@ static void debug_console()
     printf("\n=== Weather Display Debug Mode ===\n");
     printf("USB is connected - entering debug mode\n\n");
 
-    // Create weather display handler (no WiFi needed for debug mode)
-    WeatherDisplayHandler weather_handler(graphics, hub75, NUM_DAYS, 75.0f);
+    // Create weather display handler (no WiFi needed for debug mode), on the heap as above
+    const auto weather_handler = std::make_unique<WeatherDisplayHandler>(graphics, hub75, NUM_DAYS, 75.0f);
 
     // Create and run debug console
-    DebugConsole console(weather_handler);
-    console.run();
+    const auto console = std::make_unique<DebugConsole>(*weather_handler);
+    console->run();
 
     printf("Debug console exited.\n");
 }
@@ -0,0 +1,7 @@
+#include "wall_clock.h"
+
+// Called by lwIP's SNTP client with each time it receives, see lwipopts.h.
+extern "C" void sntp_set_unix_time(uint32_t sec)
+{
+    wall_clock::set(sec);
+}